@@ -0,0 +1,120 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_address.h"
+#include "stun_endianness.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* One sendmmsg burst of Binding success responses. */
+#define BURST_SIZE                  32
+#define RESPONSE_BUFFER_LENGTH      64
+#define ADDRESS_VALUE_OFFSET        ( STUN_HEADER_LENGTH + STUN_ATTRIBUTE_HEADER_LENGTH )
+
+typedef struct BenchAddressState
+{
+    uint8_t responses[ BURST_SIZE ][ RESPONSE_BUFFER_LENGTH ];
+    uint8_t * pResponses[ BURST_SIZE ];
+    StunAttributeAddress_t addresses[ BURST_SIZE ];
+    StunAttributeAddress_t decodedAddress;
+} BenchAddressState_t;
+
+/*-----------------------------------------------------------*/
+
+/* The XOR of an IPv6 address as it was done before the codec: on a copy of
+ * the address, one transaction ID byte at a time. */
+static void EncodeBytewise( void * pArg )
+{
+    BenchAddressState_t * pState = ( BenchAddressState_t * ) pArg;
+    StunAttributeAddress_t address = pState->addresses[ 0 ];
+    uint8_t * pMessage = &( pState->responses[ 0 ][ 0 ] );
+    uint8_t * pValue = &( pMessage[ ADDRESS_VALUE_OFFSET ] );
+    uint32_t word;
+    size_t i;
+
+    address.port ^= ( uint16_t ) ( STUN_HEADER_MAGIC_COOKIE >> 16 );
+    word = Stun_ReadUint32( &( address.address[ 0 ] ) ) ^ STUN_HEADER_MAGIC_COOKIE;
+    Stun_WriteUint32( &( address.address[ 0 ] ), word );
+
+    for( i = 0; i < STUN_HEADER_TRANSACTION_ID_LENGTH; i++ )
+    {
+        address.address[ STUN_IPV4_ADDRESS_SIZE + i ] ^= pMessage[ STUN_HEADER_TRANSACTION_ID_OFFSET + i ];
+    }
+
+    Stun_WriteUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_FAMILY_OFFSET ] ), address.family );
+    Stun_WriteUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_PORT_OFFSET ] ), address.port );
+    memcpy( ( void * ) &( pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
+            ( const void * ) &( address.address[ 0 ] ),
+            STUN_IPV6_ADDRESS_SIZE );
+    benchSink = pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void Encode( void * pArg )
+{
+    BenchAddressState_t * pState = ( BenchAddressState_t * ) pArg;
+
+    ( void ) StunAddress_Encode( &( pState->responses[ 0 ][ 0 ] ),
+                                 &( pState->addresses[ 0 ] ),
+                                 1,
+                                 &( pState->responses[ 0 ][ ADDRESS_VALUE_OFFSET ] ) );
+    benchSink = pState->responses[ 0 ][ ADDRESS_VALUE_OFFSET + STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void Decode( void * pArg )
+{
+    BenchAddressState_t * pState = ( BenchAddressState_t * ) pArg;
+
+    ( void ) StunAddress_Decode( &( pState->responses[ 0 ][ 0 ] ),
+                                 &( pState->responses[ 0 ][ ADDRESS_VALUE_OFFSET ] ),
+                                 STUN_ADDRESS_VALUE_LENGTH( STUN_ADDRESS_IPv6 ),
+                                 1,
+                                 &( pState->decodedAddress ) );
+    benchSink = pState->decodedAddress.port;
+}
+
+/*-----------------------------------------------------------*/
+
+static void EncodeBatch( void * pArg )
+{
+    BenchAddressState_t * pState = ( BenchAddressState_t * ) pArg;
+
+    ( void ) StunAddress_EncodeBatch( &( pState->pResponses[ 0 ] ),
+                                      &( pState->addresses[ 0 ] ),
+                                      BURST_SIZE,
+                                      ADDRESS_VALUE_OFFSET,
+                                      1 );
+    benchSink = pState->responses[ BURST_SIZE - 1 ][ ADDRESS_VALUE_OFFSET + STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchAddress_Run( void )
+{
+    static BenchAddressState_t state;
+    static const StunAttributeAddress_t address = { STUN_ADDRESS_IPv6, 50123, { 0x20, 0x01, 0x0D, 0xB8, 0x85, 0xA3, 0x00, 0x00,
+                                                                               0x00, 0x00, 0x8A, 0x2E, 0x03, 0x70, 0x73, 0x34 } };
+    size_t i;
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        /* Every response has its own transaction ID and client. */
+        memset( ( void * ) &( state.responses[ i ][ 0 ] ), ( int ) i, RESPONSE_BUFFER_LENGTH );
+        Stun_WriteUint32( &( state.responses[ i ][ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ), STUN_HEADER_MAGIC_COOKIE );
+        state.pResponses[ i ] = &( state.responses[ i ][ 0 ] );
+        state.addresses[ i ] = address;
+        state.addresses[ i ].port += ( uint16_t ) i;
+    }
+
+    Bench_Run( "address", "xor_ipv6_encode_bytewise", EncodeBytewise, &( state ) );
+    Bench_Run( "address", "xor_ipv6_encode", Encode, &( state ) );
+    Bench_Run( "address", "xor_ipv6_decode", Decode, &( state ) );
+    Bench_RunBatch( "address", "xor_ipv6_encode_batch", EncodeBatch, &( state ), BURST_SIZE );
+}
+
+/*-----------------------------------------------------------*/
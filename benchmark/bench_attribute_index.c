@@ -0,0 +1,226 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+typedef struct BenchMessage
+{
+    uint8_t buffer[ 512 ];
+    size_t length;
+} BenchMessage_t;
+
+/* The attributes an ICE agent looks up in every inbound connectivity check. */
+static const StunAttributeType_t iceCheckAttributes[] =
+{
+    STUN_ATTRIBUTE_TYPE_USERNAME,
+    STUN_ATTRIBUTE_TYPE_PRIORITY,
+    STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING,
+    STUN_ATTRIBUTE_TYPE_USE_CANDIDATE,
+    STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY,
+    STUN_ATTRIBUTE_TYPE_FINGERPRINT,
+};
+
+#define ICE_CHECK_ATTRIBUTE_COUNT    ( sizeof( iceCheckAttributes ) / sizeof( iceCheckAttributes[ 0 ] ) )
+
+/* A TURN CreatePermission request installs one permission per XOR-PEER-ADDRESS
+ * and the server reads every one of them, plus the long-term credentials. */
+#define CREATE_PERMISSION_PEER_COUNT    12
+
+static const StunAttributeType_t createPermissionAttributes[] =
+{
+    STUN_ATTRIBUTE_TYPE_USERNAME,
+    STUN_ATTRIBUTE_TYPE_REALM,
+    STUN_ATTRIBUTE_TYPE_NONCE,
+    STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY,
+    STUN_ATTRIBUTE_TYPE_FINGERPRINT,
+};
+
+#define CREATE_PERMISSION_ATTRIBUTE_COUNT    ( sizeof( createPermissionAttributes ) / sizeof( createPermissionAttributes[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+static void BuildIceCheck( BenchMessage_t * pMessage )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    uint32_t length;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), sizeof( pMessage->buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    pMessage->length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void BuildCreatePermission( BenchMessage_t * pMessage )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttributeAddress_t peerAddress = { 0 };
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "turnuser:1700000000";
+    const char * pRealm = "turn.example.com";
+    const char * pNonce = "obMatJos2AAACf//499k954d6OL34oL9FSTvy64sA";
+    uint32_t length;
+    uint16_t i;
+
+    header.messageType = STUN_MESSAGE_TYPE_CREATE_PERMISSION_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+    peerAddress.family = STUN_ADDRESS_IPv4;
+    peerAddress.address[ 0 ] = 192;
+    peerAddress.address[ 1 ] = 0;
+    peerAddress.address[ 2 ] = 2;
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), sizeof( pMessage->buffer ), &( header ) );
+
+    for( i = 0; i < CREATE_PERMISSION_PEER_COUNT; i++ )
+    {
+        peerAddress.port = ( uint16_t ) ( 50000 + i );
+        peerAddress.address[ 3 ] = ( uint8_t ) ( 1 + i );
+        ( void ) StunSerializer_AddAttributeXorPeerAddress( &( ctx ), &( peerAddress ) );
+    }
+
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributeRealm( &( ctx ), ( const uint8_t * ) pRealm, ( uint16_t ) strlen( pRealm ) );
+    ( void ) StunSerializer_AddAttributeNonce( &( ctx ), ( const uint8_t * ) pNonce, ( uint16_t ) strlen( pNonce ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    pMessage->length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void ReadCreatePermission( StunContext_t * pCtx )
+{
+    StunAttribute_t attribute;
+    uint16_t peerCount = 0;
+    uint16_t i;
+
+    for( i = 0; i < CREATE_PERMISSION_ATTRIBUTE_COUNT; i++ )
+    {
+        if( StunDeserializer_FindAttribute( pCtx, createPermissionAttributes[ i ], &( attribute ) ) == STUN_RESULT_OK )
+        {
+            benchSink += attribute.attributeValueLength;
+        }
+    }
+
+    ( void ) StunDeserializer_GetAttributeCount( pCtx, STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS, &( peerCount ) );
+
+    for( i = 0; i < peerCount; i++ )
+    {
+        if( StunDeserializer_FindAttributeInstance( pCtx, STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS, i, &( attribute ) ) == STUN_RESULT_OK )
+        {
+            benchSink += attribute.pAttributeValue[ 7 ];
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void CreatePermissionLoop( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) );
+    ReadCreatePermission( &( ctx ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void CreatePermissionIndexed( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttributeIndex_t index;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) );
+    ( void ) StunDeserializer_BuildAttributeIndex( &( ctx ), &( index ) );
+    ReadCreatePermission( &( ctx ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void FindAttributeLoop( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    size_t i;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) );
+
+    for( i = 0; i < ICE_CHECK_ATTRIBUTE_COUNT; i++ )
+    {
+        if( StunDeserializer_FindAttribute( &( ctx ), iceCheckAttributes[ i ], &( attribute ) ) == STUN_RESULT_OK )
+        {
+            benchSink += attribute.attributeValueLength;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void FindAttributeIndexed( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    StunAttributeIndex_t index;
+    size_t i;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) );
+    ( void ) StunDeserializer_BuildAttributeIndex( &( ctx ), &( index ) );
+
+    for( i = 0; i < ICE_CHECK_ATTRIBUTE_COUNT; i++ )
+    {
+        if( StunDeserializer_FindAttribute( &( ctx ), iceCheckAttributes[ i ], &( attribute ) ) == STUN_RESULT_OK )
+        {
+            benchSink += attribute.attributeValueLength;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchAttributeIndex_Run( void )
+{
+    BenchMessage_t message;
+
+    BuildIceCheck( &( message ) );
+
+    Bench_Run( "attribute_index", "ice_check_find_attribute_loop", FindAttributeLoop, &( message ) );
+    Bench_Run( "attribute_index", "ice_check_find_attribute_indexed", FindAttributeIndexed, &( message ) );
+
+    BuildCreatePermission( &( message ) );
+
+    Bench_Run( "attribute_index", "create_permission_find_attribute_loop", CreatePermissionLoop, &( message ) );
+    Bench_Run( "attribute_index", "create_permission_find_attribute_indexed", CreatePermissionIndexed, &( message ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,139 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* One recvmmsg burst of ICE connectivity checks. */
+#define BURST_SIZE              32
+#define PACKET_BUFFER_LENGTH    256
+#define MAX_BURST_ATTRIBUTES    ( BURST_SIZE * 8 )
+
+typedef struct BenchBurst
+{
+    uint8_t packets[ BURST_SIZE ][ PACKET_BUFFER_LENGTH ];
+    uint8_t * pPackets[ BURST_SIZE ];
+    size_t packetLengths[ BURST_SIZE ];
+
+    StunResult_t results[ BURST_SIZE ];
+    StunMessageType_t messageTypes[ BURST_SIZE ];
+    uint8_t * pTransactionIds[ BURST_SIZE ];
+    uint16_t attributeStart[ BURST_SIZE ];
+    uint16_t attributeCount[ BURST_SIZE ];
+    StunBatchAttribute_t attributes[ MAX_BURST_ATTRIBUTES ];
+} BenchBurst_t;
+
+/*-----------------------------------------------------------*/
+
+static size_t BuildIceCheck( uint8_t * pBuffer,
+                             uint8_t seed )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    uint32_t length;
+
+    memset( ( void * ) &( transactionId[ 0 ] ), seed, sizeof( transactionId ) );
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, PACKET_BUFFER_LENGTH, &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void InitPerPacket( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    uint32_t sum = 0;
+    size_t i;
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        if( StunDeserializer_Init( &( ctx ),
+                                   pBurst->pPackets[ i ],
+                                   pBurst->packetLengths[ i ],
+                                   &( header ) ) == STUN_RESULT_OK )
+        {
+            while( StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) ) == STUN_RESULT_OK )
+            {
+                sum += attribute.attributeType;
+            }
+        }
+    }
+
+    /* Summed locally in both cases, as every update of benchSink is a
+     * dependent load and store that would dominate the measurement. */
+    benchSink += sum;
+}
+
+/*-----------------------------------------------------------*/
+
+static void InitBatch( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    StunDeserializerBatch_t batch;
+    uint32_t sum = 0;
+    size_t i;
+    uint16_t j;
+
+    batch.pResults = &( pBurst->results[ 0 ] );
+    batch.pMessageTypes = &( pBurst->messageTypes[ 0 ] );
+    batch.ppTransactionIds = &( pBurst->pTransactionIds[ 0 ] );
+    batch.pAttributeStart = &( pBurst->attributeStart[ 0 ] );
+    batch.pAttributeCount = &( pBurst->attributeCount[ 0 ] );
+    batch.pAttributes = &( pBurst->attributes[ 0 ] );
+    batch.maxAttributes = MAX_BURST_ATTRIBUTES;
+
+    ( void ) StunDeserializer_InitBatch( &( batch ),
+                                         &( pBurst->pPackets[ 0 ] ),
+                                         &( pBurst->packetLengths[ 0 ] ),
+                                         BURST_SIZE );
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        for( j = 0; j < pBurst->attributeCount[ i ]; j++ )
+        {
+            sum += pBurst->attributes[ pBurst->attributeStart[ i ] + j ].attributeType;
+        }
+    }
+
+    benchSink += sum;
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchBatch_Run( void )
+{
+    static BenchBurst_t burst;
+    size_t i;
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        burst.pPackets[ i ] = &( burst.packets[ i ][ 0 ] );
+        burst.packetLengths[ i ] = BuildIceCheck( &( burst.packets[ i ][ 0 ] ), ( uint8_t ) i );
+    }
+
+    Bench_RunBatch( "batch", "burst32_init_and_walk_per_packet", InitPerPacket, &( burst ), BURST_SIZE );
+    Bench_RunBatch( "batch", "burst32_init_batch", InitBatch, &( burst ), BURST_SIZE );
+}
+
+/*-----------------------------------------------------------*/
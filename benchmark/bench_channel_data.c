@@ -0,0 +1,116 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_channel_data.h"
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define PAYLOAD_LENGTH          1200
+#define BUFFER_LENGTH           1500
+
+/* TURN Send indication. */
+#define SEND_INDICATION_TYPE    0x0016
+
+typedef struct BenchChannelData
+{
+    uint8_t channelData[ BUFFER_LENGTH ];
+    size_t channelDataLength;
+    uint8_t indication[ BUFFER_LENGTH ];
+    size_t indicationLength;
+} BenchChannelData_t;
+
+/*-----------------------------------------------------------*/
+
+static void SerializeChannelData( void * pArg )
+{
+    BenchChannelData_t * pBench = ( BenchChannelData_t * ) pArg;
+
+    ( void ) StunChannelData_Serialize( &( pBench->channelData[ 0 ] ),
+                                        sizeof( pBench->channelData ),
+                                        0x4001,
+                                        PAYLOAD_LENGTH,
+                                        STUN_TRANSPORT_UDP,
+                                        &( pBench->channelDataLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void DeserializeChannelData( void * pArg )
+{
+    BenchChannelData_t * pBench = ( BenchChannelData_t * ) pArg;
+    StunChannelData_t channelData;
+
+    if( STUN_FIRST_BYTE_IS_CHANNEL_DATA( pBench->channelData[ 0 ] ) )
+    {
+        ( void ) StunChannelData_Deserialize( &( pBench->channelData[ 0 ] ),
+                                              pBench->channelDataLength,
+                                              STUN_TRANSPORT_UDP,
+                                              &( channelData ) );
+        benchSink += channelData.dataLength;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The same payload relayed in a Send indication. */
+static void DeserializeSendIndication( void * pArg )
+{
+    BenchChannelData_t * pBench = ( BenchChannelData_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    StunAttributeAddress_t peerAddress;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pBench->indication[ 0 ] ), pBench->indicationLength, &( header ) );
+
+    while( StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) ) == STUN_RESULT_OK )
+    {
+        if( attribute.attributeType == STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS )
+        {
+            ( void ) StunDeserializer_ParseAttributeAddress( &( ctx ), &( attribute ), &( peerAddress ) );
+            benchSink += peerAddress.port;
+        }
+        else if( attribute.attributeType == STUN_ATTRIBUTE_TYPE_DATA )
+        {
+            benchSink += attribute.attributeValueLength;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchChannelData_Run( void )
+{
+    static BenchChannelData_t bench;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttributeAddress_t peerAddress = { 0 };
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t payload[ PAYLOAD_LENGTH ];
+    uint32_t length = 0;
+
+    memset( ( void * ) &( payload[ 0 ] ), 0xAB, sizeof( payload ) );
+    memcpy( ( void * ) &( bench.channelData[ STUN_CHANNEL_DATA_VALUE_OFFSET ] ), ( const void * ) &( payload[ 0 ] ), sizeof( payload ) );
+    SerializeChannelData( &( bench ) );
+
+    header.messageType = ( StunMessageType_t ) SEND_INDICATION_TYPE;
+    header.pTransactionId = &( transactionId[ 0 ] );
+    peerAddress.family = STUN_ADDRESS_IPv4;
+    peerAddress.port = 3478;
+
+    ( void ) StunSerializer_Init( &( ctx ), &( bench.indication[ 0 ] ), sizeof( bench.indication ), &( header ) );
+    ( void ) StunSerializer_AddAttributeXorPeerAddress( &( ctx ), &( peerAddress ) );
+    ( void ) StunSerializer_AddAttributeData( &( ctx ), &( payload[ 0 ] ), sizeof( payload ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+    bench.indicationLength = length;
+
+    Bench_Run( "channel_data", "serialize_channel_data_in_place", SerializeChannelData, &( bench ) );
+    Bench_Run( "channel_data", "deserialize_channel_data", DeserializeChannelData, &( bench ) );
+    Bench_Run( "channel_data", "deserialize_send_indication", DeserializeSendIndication, &( bench ) );
+}
+
+/*-----------------------------------------------------------*/
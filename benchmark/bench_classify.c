@@ -0,0 +1,168 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+#include "stun_demux.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* One recvmmsg burst on a shared media port. */
+#define BURST_SIZE              64
+#define PACKET_BUFFER_LENGTH    256
+
+typedef struct BenchBurst
+{
+    uint8_t packets[ BURST_SIZE ][ PACKET_BUFFER_LENGTH ];
+    const uint8_t * pPackets[ BURST_SIZE ];
+    size_t packetLengths[ BURST_SIZE ];
+} BenchBurst_t;
+
+/*-----------------------------------------------------------*/
+
+static size_t BuildBindingRequest( uint8_t * pBuffer )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint32_t length;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, PACKET_BUFFER_LENGTH, &( header ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Mostly RTP, with some RTCP, DTLS and one STUN message in every 8 packets. */
+static void BuildBurst( BenchBurst_t * pBurst )
+{
+    size_t i;
+
+    memset( ( void * ) pBurst, 0xA5, sizeof( *pBurst ) );
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        pBurst->pPackets[ i ] = &( pBurst->packets[ i ][ 0 ] );
+
+        switch( i % 8 )
+        {
+            case 0:
+                pBurst->packetLengths[ i ] = BuildBindingRequest( &( pBurst->packets[ i ][ 0 ] ) );
+                break;
+
+            case 1:
+                pBurst->packets[ i ][ 0 ] = 0x16; /* DTLS handshake. */
+                pBurst->packetLengths[ i ] = 120;
+                break;
+
+            case 2:
+                pBurst->packets[ i ][ 0 ] = 0x81; /* RTCP. */
+                pBurst->packets[ i ][ 1 ] = 0xC8;
+                pBurst->packetLengths[ i ] = 52;
+                break;
+
+            default:
+                pBurst->packets[ i ][ 0 ] = 0x80; /* RTP. */
+                pBurst->packets[ i ][ 1 ] = 0x6F;
+                pBurst->packetLengths[ i ] = 200;
+                break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void InitPerPacket( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    size_t i;
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        if( StunDeserializer_Init( &( ctx ),
+                                   &( pBurst->packets[ i ][ 0 ] ),
+                                   pBurst->packetLengths[ i ],
+                                   &( header ) ) == STUN_RESULT_OK )
+        {
+            benchSink++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ClassifyBatch( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    uint64_t stunMask;
+
+    ( void ) StunDeserializer_ClassifyBatch( &( pBurst->pPackets[ 0 ] ),
+                                             &( pBurst->packetLengths[ 0 ] ),
+                                             BURST_SIZE,
+                                             &( stunMask ) );
+
+    benchSink += ( uint32_t ) stunMask;
+}
+
+/*-----------------------------------------------------------*/
+
+static void DemuxPerPacket( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    StunProtocol_t protocol;
+    StunHeader_t header;
+    size_t i;
+
+    for( i = 0; i < BURST_SIZE; i++ )
+    {
+        ( void ) StunDemux_Classify( &( pBurst->packets[ i ][ 0 ] ),
+                                     pBurst->packetLengths[ i ],
+                                     &( protocol ),
+                                     &( header ) );
+        benchSink += ( uint32_t ) protocol;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void DemuxBatch( void * pArg )
+{
+    BenchBurst_t * pBurst = ( BenchBurst_t * ) pArg;
+    StunProtocol_t protocols[ BURST_SIZE ];
+    StunHeader_t headers[ BURST_SIZE ];
+
+    ( void ) StunDemux_ClassifyBatch( &( pBurst->pPackets[ 0 ] ),
+                                      &( pBurst->packetLengths[ 0 ] ),
+                                      BURST_SIZE,
+                                      &( protocols[ 0 ] ),
+                                      &( headers[ 0 ] ) );
+
+    benchSink += ( uint32_t ) protocols[ BURST_SIZE - 1 ];
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchClassify_Run( void )
+{
+    static BenchBurst_t burst;
+
+    BuildBurst( &( burst ) );
+
+    Bench_RunBatch( "classify", "burst64_init_per_packet", InitPerPacket, &( burst ), BURST_SIZE );
+    Bench_RunBatch( "classify", "burst64_classify_batch", ClassifyBatch, &( burst ), BURST_SIZE );
+    Bench_RunBatch( "classify", "burst64_demux_per_packet", DemuxPerPacket, &( burst ), BURST_SIZE );
+    Bench_RunBatch( "classify", "burst64_demux_batch", DemuxBatch, &( burst ), BURST_SIZE );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,146 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+#include "stun_crc32.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define MAX_BUFFER_LENGTH    1500
+
+typedef struct BenchBuffer
+{
+    uint8_t buffer[ MAX_BUFFER_LENGTH ];
+    size_t length;
+} BenchBuffer_t;
+
+/* Byte-at-a-time table, the way callers compute the fingerprint today. */
+static uint32_t referenceTable[ 256 ];
+
+/*-----------------------------------------------------------*/
+
+static void InitReferenceTable( void )
+{
+    uint32_t i, j, crc;
+
+    for( i = 0; i < 256; i++ )
+    {
+        crc = i;
+
+        for( j = 0; j < 8; j++ )
+        {
+            crc = ( crc & 1 ) ? ( ( crc >> 1 ) ^ 0xEDB88320 ) : ( crc >> 1 );
+        }
+
+        referenceTable[ i ] = crc;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void Crc32Bytewise( void * pArg )
+{
+    BenchBuffer_t * pBuffer = ( BenchBuffer_t * ) pArg;
+    uint32_t crc = 0xFFFFFFFF;
+    size_t i;
+
+    for( i = 0; i < pBuffer->length; i++ )
+    {
+        crc = referenceTable[ ( crc ^ pBuffer->buffer[ i ] ) & 0xFF ] ^ ( crc >> 8 );
+    }
+
+    benchSink += ~crc;
+}
+
+/*-----------------------------------------------------------*/
+
+static void Crc32Library( void * pArg )
+{
+    BenchBuffer_t * pBuffer = ( BenchBuffer_t * ) pArg;
+
+    benchSink += Stun_Crc32( 0, &( pBuffer->buffer[ 0 ] ), pBuffer->length );
+}
+
+/*-----------------------------------------------------------*/
+
+static void AddFingerprint( void * pArg )
+{
+    BenchBuffer_t * pBuffer = ( BenchBuffer_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pBuffer->buffer[ 0 ] ), sizeof( pBuffer->buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    pBuffer->length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void VerifyFingerprint( void * pArg )
+{
+    BenchBuffer_t * pBuffer = ( BenchBuffer_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pBuffer->buffer[ 0 ] ), pBuffer->length, &( header ) );
+
+    while( StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) ) == STUN_RESULT_OK )
+    {
+        if( attribute.attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT )
+        {
+            benchSink += ( uint32_t ) StunDeserializer_VerifyFingerprint( &( ctx ), &( attribute ) );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchCrc32_Run( void )
+{
+    static BenchBuffer_t buffer;
+    static const size_t lengths[] = { 96, 548, 1200 };
+    char caseName[ 64 ];
+    size_t i;
+
+    InitReferenceTable();
+
+    for( i = 0; i < sizeof( buffer.buffer ); i++ )
+    {
+        buffer.buffer[ i ] = ( uint8_t ) ( i * 31 );
+    }
+
+    for( i = 0; i < sizeof( lengths ) / sizeof( lengths[ 0 ] ); i++ )
+    {
+        buffer.length = lengths[ i ];
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "crc32_%u_bytes_bytewise", ( unsigned ) lengths[ i ] );
+        Bench_RunBatch( "crc32", caseName, Crc32Bytewise, &( buffer ), ( uint32_t ) lengths[ i ] );
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "crc32_%u_bytes_library", ( unsigned ) lengths[ i ] );
+        Bench_RunBatch( "crc32", caseName, Crc32Library, &( buffer ), ( uint32_t ) lengths[ i ] );
+    }
+
+    Bench_Run( "crc32", "serialize_ice_check_add_fingerprint", AddFingerprint, &( buffer ) );
+    Bench_Run( "crc32", "deserialize_ice_check_verify_fingerprint", VerifyFingerprint, &( buffer ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* API includes. */
+#include "stun_credential_cache.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define CACHE_ENTRY_COUNT    1024
+#define USER_COUNT           512
+
+typedef struct BenchCredential
+{
+    StunCredentialCache_t cache;
+    char usernames[ USER_COUNT ][ 32 ];
+    uint16_t usernameLengths[ USER_COUNT ];
+    uint32_t nextUser;
+} BenchCredential_t;
+
+static StunCredentialCacheEntry_t cacheEntries[ CACHE_ENTRY_COUNT ];
+static const char * pRealm = "turn.example.org";
+static const char * pPassword = "TheMatrIX";
+
+/*-----------------------------------------------------------*/
+
+/* What the TURN front end does today for every authenticated request. */
+static void DeriveKeyPerMessage( void * pArg )
+{
+    BenchCredential_t * pCredential = ( BenchCredential_t * ) pArg;
+    uint32_t user = pCredential->nextUser++ % USER_COUNT;
+    uint8_t longTermKey[ STUN_LONG_TERM_KEY_LENGTH ];
+    StunHmacKey_t hmacKey;
+
+    ( void ) StunCredential_ComputeLongTermKey( ( const uint8_t * ) pCredential->usernames[ user ],
+                                                pCredential->usernameLengths[ user ],
+                                                ( const uint8_t * ) pRealm,
+                                                ( uint16_t ) strlen( pRealm ),
+                                                ( const uint8_t * ) pPassword,
+                                                ( uint16_t ) strlen( pPassword ),
+                                                &( longTermKey[ 0 ] ) );
+    ( void ) StunHmac_InitKey( &( hmacKey ), &( longTermKey[ 0 ] ), STUN_LONG_TERM_KEY_LENGTH );
+
+    benchSink += hmacKey.innerState[ 0 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void CacheLookup( void * pArg )
+{
+    BenchCredential_t * pCredential = ( BenchCredential_t * ) pArg;
+    uint32_t user = pCredential->nextUser++ % USER_COUNT;
+    StunHmacKey_t hmacKey;
+
+    benchSink += ( uint32_t ) StunCredentialCache_Lookup( &( pCredential->cache ),
+                                                          ( const uint8_t * ) pCredential->usernames[ user ],
+                                                          pCredential->usernameLengths[ user ],
+                                                          ( const uint8_t * ) pRealm,
+                                                          ( uint16_t ) strlen( pRealm ),
+                                                          NULL,
+                                                          &( hmacKey ) );
+    benchSink += hmacKey.innerState[ 0 ];
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchCredentialCache_Run( void )
+{
+    static BenchCredential_t credential;
+    uint32_t i;
+
+    ( void ) StunCredentialCache_Init( &( credential.cache ), &( cacheEntries[ 0 ] ), CACHE_ENTRY_COUNT );
+
+    for( i = 0; i < USER_COUNT; i++ )
+    {
+        credential.usernameLengths[ i ] = ( uint16_t ) snprintf( credential.usernames[ i ],
+                                                                 sizeof( credential.usernames[ i ] ),
+                                                                 "user-%u",
+                                                                 ( unsigned ) i );
+        ( void ) StunCredentialCache_Insert( &( credential.cache ),
+                                             ( const uint8_t * ) credential.usernames[ i ],
+                                             credential.usernameLengths[ i ],
+                                             ( const uint8_t * ) pRealm,
+                                             ( uint16_t ) strlen( pRealm ),
+                                             ( const uint8_t * ) pPassword,
+                                             ( uint16_t ) strlen( pPassword ) );
+    }
+
+    Bench_Run( "credential_cache", "derive_key_per_message", DeriveKeyPerMessage, &( credential ) );
+    Bench_Run( "credential_cache", "cache_lookup_hmac_key", CacheLookup, &( credential ) );
+}
+
+/*-----------------------------------------------------------*/
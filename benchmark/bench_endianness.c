@@ -0,0 +1,148 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define MESSAGE_BUFFER_LENGTH    256
+
+typedef struct BenchMessage
+{
+    uint8_t buffer[ MESSAGE_BUFFER_LENGTH ];
+    size_t length;
+} BenchMessage_t;
+
+/* The library is built in one mode only, so the serialize and deserialize
+ * cases of the other mode come from a second build. */
+#if defined( STUN_COMPILE_TIME_ENDIANNESS )
+    #define LIBRARY_MODE    "compile_time"
+#else
+    #define LIBRARY_MODE    "function_pointers"
+#endif
+
+/*-----------------------------------------------------------*/
+
+static size_t SerializeIceCheck( uint8_t * pBuffer )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, MESSAGE_BUFFER_LENGTH, &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Reads the header and all the attribute headers of a message the way the
+ * deserializer does with the read functions set up for every message. */
+static void ReadMessageFunctionPointers( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunReadWriteFunctions_t readWriteFunctions;
+    size_t offset = STUN_HEADER_LENGTH;
+    uint16_t attributeLength;
+
+    Stun_InitReadWriteFunctions( &( readWriteFunctions ) );
+
+    benchSink += readWriteFunctions.readUint16Fn( &( pMessage->buffer[ 0 ] ) );
+    benchSink += readWriteFunctions.readUint16Fn( &( pMessage->buffer[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
+    benchSink += readWriteFunctions.readUint32Fn( &( pMessage->buffer[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) );
+
+    while( offset + STUN_ATTRIBUTE_HEADER_LENGTH <= pMessage->length )
+    {
+        benchSink += readWriteFunctions.readUint16Fn( &( pMessage->buffer[ offset ] ) );
+        attributeLength = readWriteFunctions.readUint16Fn( &( pMessage->buffer[ offset + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+        offset += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( attributeLength ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ReadMessageInline( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    size_t offset = STUN_HEADER_LENGTH;
+    uint16_t attributeLength;
+
+    benchSink += Stun_ReadUint16( &( pMessage->buffer[ 0 ] ) );
+    benchSink += Stun_ReadUint16( &( pMessage->buffer[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
+    benchSink += Stun_ReadUint32( &( pMessage->buffer[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) );
+
+    while( offset + STUN_ATTRIBUTE_HEADER_LENGTH <= pMessage->length )
+    {
+        benchSink += Stun_ReadUint16( &( pMessage->buffer[ offset ] ) );
+        attributeLength = Stun_ReadUint16( &( pMessage->buffer[ offset + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+        offset += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( attributeLength ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeLibrary( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+
+    benchSink += ( uint32_t ) SerializeIceCheck( &( pMessage->buffer[ 0 ] ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void DeserializeLibrary( void * pArg )
+{
+    BenchMessage_t * pMessage = ( BenchMessage_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    uint32_t priority;
+    uint64_t tieBreaker;
+
+    if( StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) ) == STUN_RESULT_OK )
+    {
+        while( StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) ) == STUN_RESULT_OK )
+        {
+            if( StunDeserializer_ParseAttributePriority( &( ctx ), &( attribute ), &( priority ) ) == STUN_RESULT_OK )
+            {
+                benchSink += priority;
+            }
+            else if( StunDeserializer_ParseAttributeIceControlling( &( ctx ), &( attribute ), &( tieBreaker ) ) == STUN_RESULT_OK )
+            {
+                benchSink += ( uint32_t ) tieBreaker;
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchEndianness_Run( void )
+{
+    static BenchMessage_t message;
+
+    message.length = SerializeIceCheck( &( message.buffer[ 0 ] ) );
+
+    Bench_Run( "endianness", "read_ice_check_function_pointers", ReadMessageFunctionPointers, &( message ) );
+    Bench_Run( "endianness", "read_ice_check_inline", ReadMessageInline, &( message ) );
+    Bench_Run( "endianness", "serialize_ice_check_" LIBRARY_MODE, SerializeLibrary, &( message ) );
+    Bench_Run( "endianness", "deserialize_ice_check_" LIBRARY_MODE, DeserializeLibrary, &( message ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,157 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_framer.h"
+#include "stun_serializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define STREAM_LENGTH       65536
+#define SCRATCH_LENGTH      ( 65535 + STUN_HEADER_LENGTH )
+#define CHANNEL_DATA_LENGTH 160
+
+typedef struct BenchFramer
+{
+    uint8_t stream[ STREAM_LENGTH ];
+    size_t streamLength;
+    uint32_t frameCount;
+    uint8_t work[ STREAM_LENGTH ];
+    uint8_t scratch[ SCRATCH_LENGTH ];
+    size_t chunkLength;
+} BenchFramer_t;
+
+/*-----------------------------------------------------------*/
+
+static size_t AddBindingRequest( uint8_t * pBuffer,
+                                 size_t bufferLength )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, bufferLength, &( header ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+/* One recv worth of STUN messages interleaved with ChannelData messages. */
+static void BuildStream( BenchFramer_t * pFramer )
+{
+    size_t length = 0, messageLength;
+    uint8_t * pMessage;
+
+    pFramer->frameCount = 0;
+
+    /* ChannelData messages are the largest. */
+    while( length + STUN_CHANNEL_DATA_HEADER_LENGTH + CHANNEL_DATA_LENGTH <= STREAM_LENGTH )
+    {
+        pMessage = &( pFramer->stream[ length ] );
+
+        if( ( pFramer->frameCount % 4 ) == 0 )
+        {
+            messageLength = AddBindingRequest( pMessage, STREAM_LENGTH - length );
+        }
+        else
+        {
+            messageLength = STUN_CHANNEL_DATA_HEADER_LENGTH + CHANNEL_DATA_LENGTH;
+            Stun_WriteUint16( &( pMessage[ STUN_CHANNEL_DATA_CHANNEL_NUMBER_OFFSET ] ), 0x4001 );
+            Stun_WriteUint16( &( pMessage[ STUN_CHANNEL_DATA_LENGTH_OFFSET ] ), CHANNEL_DATA_LENGTH );
+            memset( ( void * ) &( pMessage[ STUN_CHANNEL_DATA_HEADER_LENGTH ] ), 0xAB, CHANNEL_DATA_LENGTH );
+        }
+
+        length += messageLength;
+        pFramer->frameCount++;
+    }
+
+    pFramer->streamLength = length;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The usual receive loop: find one message at the start of the buffer and
+ * move the rest to the front. */
+static void DrainWithMemmove( void * pArg )
+{
+    BenchFramer_t * pFramer = ( BenchFramer_t * ) pArg;
+    size_t used = pFramer->streamLength, frameLength;
+
+    memcpy( ( void * ) &( pFramer->work[ 0 ] ), ( const void * ) &( pFramer->stream[ 0 ] ), used );
+
+    while( used >= STUN_CHANNEL_DATA_HEADER_LENGTH )
+    {
+        if( STUN_FIRST_BYTE_IS_STUN( pFramer->work[ 0 ] ) )
+        {
+            frameLength = STUN_HEADER_LENGTH + Stun_ReadUint16( &( pFramer->work[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
+        }
+        else
+        {
+            frameLength = STUN_CHANNEL_DATA_HEADER_LENGTH +
+                          STUN_ALIGN_SIZE_TO_WORD( Stun_ReadUint16( &( pFramer->work[ STUN_CHANNEL_DATA_LENGTH_OFFSET ] ) ) );
+        }
+
+        benchSink += pFramer->work[ frameLength - 1 ];
+
+        memmove( ( void * ) &( pFramer->work[ 0 ] ), ( const void * ) &( pFramer->work[ frameLength ] ), used - frameLength );
+        used -= frameLength;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void DrainWithFramer( void * pArg )
+{
+    BenchFramer_t * pFramer = ( BenchFramer_t * ) pArg;
+    StunFramerContext_t ctx;
+    StunFrame_t frame;
+    size_t offset, chunkLength;
+
+    ( void ) StunFramer_Init( &( ctx ), STUN_FRAMING_MODE_TURN, &( pFramer->scratch[ 0 ] ), SCRATCH_LENGTH );
+
+    for( offset = 0; offset < pFramer->streamLength; offset += chunkLength )
+    {
+        chunkLength = pFramer->streamLength - offset;
+
+        if( chunkLength > pFramer->chunkLength )
+        {
+            chunkLength = pFramer->chunkLength;
+        }
+
+        ( void ) StunFramer_AddChunk( &( ctx ), &( pFramer->stream[ offset ] ), chunkLength );
+
+        while( StunFramer_GetNextFrame( &( ctx ), &( frame ) ) == STUN_RESULT_OK )
+        {
+            benchSink += frame.pFrame[ frame.frameLength - 1 ];
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchFramer_Run( void )
+{
+    static BenchFramer_t framer;
+
+    BuildStream( &( framer ) );
+
+    Bench_RunBatch( "framer", "drain_64k_memmove", DrainWithMemmove, &( framer ), framer.frameCount );
+
+    framer.chunkLength = STREAM_LENGTH;
+    Bench_RunBatch( "framer", "drain_64k_framer_one_chunk", DrainWithFramer, &( framer ), framer.frameCount );
+
+    /* Chunks that split most frames. */
+    framer.chunkLength = 1000;
+    Bench_RunBatch( "framer", "drain_64k_framer_1000_byte_chunks", DrainWithFramer, &( framer ), framer.frameCount );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,220 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Instructions are counted with perf_event_open on Linux. Elsewhere, or when
+ * the kernel does not allow it (for example, in most containers), the
+ * instructions_per_op column is left empty. */
+#if defined( __linux__ )
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define BENCH_PERF_EVENTS
+#endif
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* Minimum duration of the calibration and of each measured run. The fastest
+ * of the measured runs is reported to filter out noise from other load on the
+ * machine. */
+#define BENCH_CALIBRATION_NS    ( 20ULL * 1000ULL * 1000ULL )
+#define BENCH_MEASUREMENT_NS    ( 50ULL * 1000ULL * 1000ULL )
+#define BENCH_MEASURED_RUNS     5
+
+volatile uint32_t benchSink;
+
+/* -2 until the counter is opened, -1 if it is not available. */
+static int instructionCounterFd = -2;
+
+/*-----------------------------------------------------------*/
+
+static int GetInstructionCounter( void )
+{
+    #if defined( BENCH_PERF_EVENTS )
+        struct perf_event_attr attr;
+
+        if( instructionCounterFd == -2 )
+        {
+            memset( ( void * ) &( attr ), 0, sizeof( attr ) );
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof( attr );
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            instructionCounterFd = ( int ) syscall( SYS_perf_event_open, &( attr ), 0, -1, -1, 0 );
+
+            if( instructionCounterFd < 0 )
+            {
+                instructionCounterFd = -1;
+            }
+        }
+    #else
+        instructionCounterFd = -1;
+    #endif
+
+    return instructionCounterFd;
+}
+
+/*-----------------------------------------------------------*/
+
+static void StartInstructionCount( int counterFd )
+{
+    #if defined( BENCH_PERF_EVENTS )
+        if( counterFd >= 0 )
+        {
+            ( void ) ioctl( counterFd, PERF_EVENT_IOC_RESET, 0 );
+            ( void ) ioctl( counterFd, PERF_EVENT_IOC_ENABLE, 0 );
+        }
+    #else
+        ( void ) counterFd;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t StopInstructionCount( int counterFd )
+{
+    uint64_t instructions = 0;
+
+    #if defined( BENCH_PERF_EVENTS )
+        if( counterFd >= 0 )
+        {
+            ( void ) ioctl( counterFd, PERF_EVENT_IOC_DISABLE, 0 );
+
+            if( read( counterFd, &( instructions ), sizeof( instructions ) ) != ( ssize_t ) sizeof( instructions ) )
+            {
+                instructions = 0;
+            }
+        }
+    #else
+        ( void ) counterFd;
+    #endif
+
+    return instructions;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t GetTimeNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000ULL ) + ( uint64_t ) now.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Returns the duration of the run and, if pInstructions is not NULL, the
+ * number of instructions it retired. */
+static uint64_t RunIterations( BenchCaseFunction_t caseFunction,
+                               void * pArg,
+                               uint64_t iterations,
+                               uint64_t * pInstructions )
+{
+    uint64_t start, elapsed, i;
+    int counterFd = ( pInstructions != NULL ) ? GetInstructionCounter() : -1;
+
+    StartInstructionCount( counterFd );
+    start = GetTimeNs();
+
+    for( i = 0; i < iterations; i++ )
+    {
+        caseFunction( pArg );
+    }
+
+    elapsed = GetTimeNs() - start;
+
+    if( pInstructions != NULL )
+    {
+        *pInstructions = StopInstructionCount( counterFd );
+    }
+
+    return elapsed;
+}
+
+/*-----------------------------------------------------------*/
+
+void Bench_PrintHeader( void )
+{
+    printf( "suite,case,iterations,ns_per_op,instructions_per_op,items_per_op,items_per_sec\n" );
+}
+
+/*-----------------------------------------------------------*/
+
+void Bench_Run( const char * pSuiteName,
+                const char * pCaseName,
+                BenchCaseFunction_t caseFunction,
+                void * pArg )
+{
+    Bench_RunBatch( pSuiteName, pCaseName, caseFunction, pArg, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+void Bench_RunBatch( const char * pSuiteName,
+                     const char * pCaseName,
+                     BenchCaseFunction_t caseFunction,
+                     void * pArg,
+                     uint32_t itemsPerOp )
+{
+    uint64_t iterations = 1, elapsed, fastest, instructions, fewestInstructions;
+    uint32_t run;
+    double nsPerOp;
+    char instructionsPerOp[ 32 ] = "";
+
+    /* Grow the iteration count until a run is long enough to be timed
+     * reliably, then scale it to the measurement duration. */
+    do
+    {
+        iterations *= 2;
+        elapsed = RunIterations( caseFunction, pArg, iterations, NULL );
+    } while( elapsed < BENCH_CALIBRATION_NS );
+
+    iterations = ( iterations * BENCH_MEASUREMENT_NS ) / elapsed;
+    fastest = UINT64_MAX;
+    fewestInstructions = UINT64_MAX;
+
+    for( run = 0; run < BENCH_MEASURED_RUNS; run++ )
+    {
+        elapsed = RunIterations( caseFunction, pArg, iterations, &( instructions ) );
+
+        if( elapsed < fastest )
+        {
+            fastest = elapsed;
+        }
+
+        if( instructions < fewestInstructions )
+        {
+            fewestInstructions = instructions;
+        }
+    }
+
+    nsPerOp = ( double ) fastest / ( double ) iterations;
+
+    if( GetInstructionCounter() >= 0 )
+    {
+        ( void ) snprintf( instructionsPerOp,
+                           sizeof( instructionsPerOp ),
+                           "%.1f",
+                           ( double ) fewestInstructions / ( double ) iterations );
+    }
+
+    printf( "%s,%s,%llu,%.2f,%s,%u,%.0f\n",
+            pSuiteName,
+            pCaseName,
+            ( unsigned long long ) iterations,
+            nsPerOp,
+            instructionsPerOp,
+            itemsPerOp,
+            ( ( double ) itemsPerOp * 1e9 ) / nsPerOp );
+    fflush( stdout );
+}
+
+/*-----------------------------------------------------------*/
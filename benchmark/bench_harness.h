@@ -0,0 +1,50 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Function benchmarked by the harness. It must perform exactly one operation
+ * per call. */
+typedef void ( * BenchCaseFunction_t )( void * pArg );
+
+/* Written by benchmark cases so that the compiler cannot discard their work. */
+extern volatile uint32_t benchSink;
+
+void Bench_PrintHeader( void );
+
+void Bench_Run( const char * pSuiteName,
+                const char * pCaseName,
+                BenchCaseFunction_t caseFunction,
+                void * pArg );
+
+/* Same as Bench_Run for cases that process itemsPerOp items (for example,
+ * packets in a burst) per call. */
+void Bench_RunBatch( const char * pSuiteName,
+                     const char * pCaseName,
+                     BenchCaseFunction_t caseFunction,
+                     void * pArg,
+                     uint32_t itemsPerOp );
+
+/* Benchmark suites. */
+void BenchAttributeIndex_Run( void );
+void BenchClassify_Run( void );
+void BenchBatch_Run( void );
+void BenchEndianness_Run( void );
+void BenchCrc32_Run( void );
+void BenchHmac_Run( void );
+void BenchCredentialCache_Run( void );
+void BenchFramer_Run( void );
+void BenchChannelData_Run( void );
+void BenchParseAll_Run( void );
+void BenchMessages_Run( void );
+void BenchTemplate_Run( void );
+void BenchScatterGather_Run( void );
+void BenchAddress_Run( void );
+void BenchRandom_Run( void );
+void BenchStats_Run( void );
+void BenchTransactionTable_Run( void );
+void BenchTimerWheel_Run( void );
+
+#endif /* BENCH_HARNESS_H */
@@ -0,0 +1,132 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+#include "stun_hmac_sha1.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define MAX_BUFFER_LENGTH    1500
+
+typedef struct BenchHmac
+{
+    uint8_t buffer[ MAX_BUFFER_LENGTH ];
+    size_t length;
+    const uint8_t * pPassword;
+    size_t passwordLength;
+    StunHmacKey_t hmacKey;
+} BenchHmac_t;
+
+/*-----------------------------------------------------------*/
+
+/* Keys the HMAC for every message, which is what a caller without a
+ * precomputed key pays. */
+static void HmacPerMessageKey( void * pArg )
+{
+    BenchHmac_t * pHmac = ( BenchHmac_t * ) pArg;
+    StunHmacKey_t hmacKey;
+    uint8_t hmac[ STUN_HMAC_VALUE_LENGTH ];
+
+    ( void ) StunHmac_InitKey( &( hmacKey ), pHmac->pPassword, pHmac->passwordLength );
+    ( void ) StunHmac_Sign( &( hmacKey ), &( pHmac->buffer[ 0 ] ), pHmac->length, &( hmac[ 0 ] ) );
+
+    benchSink += hmac[ 0 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void HmacPrecomputedKey( void * pArg )
+{
+    BenchHmac_t * pHmac = ( BenchHmac_t * ) pArg;
+    uint8_t hmac[ STUN_HMAC_VALUE_LENGTH ];
+
+    ( void ) StunHmac_Sign( &( pHmac->hmacKey ), &( pHmac->buffer[ 0 ] ), pHmac->length, &( hmac[ 0 ] ) );
+
+    benchSink += hmac[ 0 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void AddIntegrity( void * pArg )
+{
+    BenchHmac_t * pHmac = ( BenchHmac_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pHmac->buffer[ 0 ] ), sizeof( pHmac->buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( pHmac->hmacKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    pHmac->length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void VerifyIntegrity( void * pArg )
+{
+    BenchHmac_t * pHmac = ( BenchHmac_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pHmac->buffer[ 0 ] ), pHmac->length, &( header ) );
+
+    while( StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) ) == STUN_RESULT_OK )
+    {
+        if( attribute.attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY )
+        {
+            benchSink += ( uint32_t ) StunDeserializer_VerifyIntegrity( &( ctx ), &( attribute ), &( pHmac->hmacKey ) );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchHmac_Run( void )
+{
+    static BenchHmac_t hmac;
+    static const size_t lengths[] = { 64, 96, 548 };
+    static const char * pPassword = "VOkJxbRl1RmTxUk/WvJxBt";
+    char caseName[ 64 ];
+    size_t i;
+
+    hmac.pPassword = ( const uint8_t * ) pPassword;
+    hmac.passwordLength = strlen( pPassword );
+    ( void ) StunHmac_InitKey( &( hmac.hmacKey ), hmac.pPassword, hmac.passwordLength );
+
+    for( i = 0; i < sizeof( hmac.buffer ); i++ )
+    {
+        hmac.buffer[ i ] = ( uint8_t ) ( i * 31 );
+    }
+
+    for( i = 0; i < sizeof( lengths ) / sizeof( lengths[ 0 ] ); i++ )
+    {
+        hmac.length = lengths[ i ];
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "hmac_%u_bytes_per_message_key", ( unsigned ) lengths[ i ] );
+        Bench_Run( "hmac", caseName, HmacPerMessageKey, &( hmac ) );
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "hmac_%u_bytes_precomputed_key", ( unsigned ) lengths[ i ] );
+        Bench_Run( "hmac", caseName, HmacPrecomputedKey, &( hmac ) );
+    }
+
+    Bench_Run( "hmac", "serialize_ice_check_add_integrity", AddIntegrity, &( hmac ) );
+    Bench_Run( "hmac", "deserialize_ice_check_verify_integrity", VerifyIntegrity, &( hmac ) );
+}
+
+/*-----------------------------------------------------------*/
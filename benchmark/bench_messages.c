@@ -0,0 +1,301 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* Size of the DATA attribute in Send and Data indications - a typical media
+ * packet that fits an Ethernet MTU with the TURN overhead. */
+#define BENCH_TURN_DATA_LENGTH     1200
+
+#define BENCH_MESSAGE_MAX_LENGTH   1400
+
+#define BENCH_MAX_FIND_ATTRIBUTES  6
+
+typedef struct BenchMessageState BenchMessageState_t;
+
+/* Serializes one message into pState->buffer. */
+typedef void ( * BenchSerializeFunction_t )( BenchMessageState_t * pState );
+
+typedef struct BenchMessageCase
+{
+    const char * pName;
+    BenchSerializeFunction_t serializeFunction;
+
+    /* Attributes that the receiver of the message looks up. */
+    StunAttributeType_t findAttributes[ BENCH_MAX_FIND_ATTRIBUTES ];
+    size_t findAttributeCount;
+} BenchMessageCase_t;
+
+struct BenchMessageState
+{
+    const BenchMessageCase_t * pCase;
+    uint8_t buffer[ BENCH_MESSAGE_MAX_LENGTH ];
+    uint32_t length;
+};
+
+/* Inputs shared by all the messages. */
+static uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0xB7, 0xE7, 0xA7, 0x01, 0xBC, 0x34, 0xD6, 0x86, 0xFA, 0x87, 0xDF, 0xAE };
+static uint8_t turnData[ BENCH_TURN_DATA_LENGTH ];
+static StunHmacKey_t shortTermKey;
+static StunHmacKey_t longTermKey;
+static const StunAttributeAddress_t mappedAddress = { STUN_ADDRESS_IPv4, 50123, { 203, 0, 113, 17 } };
+static const StunAttributeAddress_t relayedAddress = { STUN_ADDRESS_IPv4, 49200, { 198, 51, 100, 4 } };
+static const StunAttributeAddress_t peerAddress = { STUN_ADDRESS_IPv6, 61000, { 0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x42 } };
+static const char * pIceUsername = "r4Nd0mRemoteUfrag:l0calUfrag";
+static const char * pTurnUsername = "1700000000:turnuser";
+static const char * pTurnRealm = "turn.example.org";
+static const char * pTurnNonce = "obMatJos2AAACf//499k954d6OL34oL9FSTvy64sA";
+static const char * pUnauthorized = "Unauthorized";
+static const uint8_t udpTransport[ 4 ] = { 17, 0, 0, 0 };
+
+/*-----------------------------------------------------------*/
+
+static void StartMessage( StunContext_t * pCtx,
+                          BenchMessageState_t * pState,
+                          StunMessageType_t messageType )
+{
+    StunHeader_t header;
+
+    header.messageType = messageType;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( pCtx, &( pState->buffer[ 0 ] ), sizeof( pState->buffer ), &( header ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeIceBindingRequest( BenchMessageState_t * pState )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, STUN_MESSAGE_TYPE_BINDING_REQUEST );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pIceUsername, ( uint16_t ) strlen( pIceUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( shortTermKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeIceBindingResponse( BenchMessageState_t * pState )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE );
+    ( void ) StunSerializer_AddAttributeAddress( &( ctx ), &( mappedAddress ), STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( shortTermKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeTurnAllocateUnauthorized( BenchMessageState_t * pState )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, STUN_MESSAGE_TYPE_ALLOCATE_FAILURE_RESPONSE );
+    ( void ) StunSerializer_AddAttributeErrorCode( &( ctx ), 401, ( const uint8_t * ) pUnauthorized, ( uint16_t ) strlen( pUnauthorized ) );
+    ( void ) StunSerializer_AddAttributeRealm( &( ctx ), ( const uint8_t * ) pTurnRealm, ( uint16_t ) strlen( pTurnRealm ) );
+    ( void ) StunSerializer_AddAttributeNonce( &( ctx ), ( const uint8_t * ) pTurnNonce, ( uint16_t ) strlen( pTurnNonce ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeTurnAllocateRequest( BenchMessageState_t * pState )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, STUN_MESSAGE_TYPE_ALLOCATE_REQUEST );
+    ( void ) StunSerializer_AddAttributeRequestedTransport( &( ctx ), &( udpTransport[ 0 ] ), sizeof( udpTransport ) );
+    ( void ) StunSerializer_AddAttributeLifetime( &( ctx ), 600 );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pTurnUsername, ( uint16_t ) strlen( pTurnUsername ) );
+    ( void ) StunSerializer_AddAttributeRealm( &( ctx ), ( const uint8_t * ) pTurnRealm, ( uint16_t ) strlen( pTurnRealm ) );
+    ( void ) StunSerializer_AddAttributeNonce( &( ctx ), ( const uint8_t * ) pTurnNonce, ( uint16_t ) strlen( pTurnNonce ) );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( longTermKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeTurnAllocateResponse( BenchMessageState_t * pState )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, STUN_MESSAGE_TYPE_ALLOCATE_SUCCESS_RESPONSE );
+    ( void ) StunSerializer_AddAttributeAddress( &( ctx ), &( relayedAddress ), STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS );
+    ( void ) StunSerializer_AddAttributeAddress( &( ctx ), &( mappedAddress ), STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS );
+    ( void ) StunSerializer_AddAttributeLifetime( &( ctx ), 600 );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( longTermKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeTurnIndication( BenchMessageState_t * pState,
+                                     StunMessageType_t messageType )
+{
+    StunContext_t ctx;
+
+    StartMessage( &( ctx ), pState, messageType );
+    ( void ) StunSerializer_AddAttributeAddress( &( ctx ), &( peerAddress ), STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS );
+    ( void ) StunSerializer_AddAttributeData( &( ctx ), &( turnData[ 0 ] ), sizeof( turnData ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( pState->length ) );
+}
+
+static void SerializeTurnSendIndication( BenchMessageState_t * pState )
+{
+    SerializeTurnIndication( pState, STUN_MESSAGE_TYPE_SEND_INDICATION );
+}
+
+static void SerializeTurnDataIndication( BenchMessageState_t * pState )
+{
+    SerializeTurnIndication( pState, STUN_MESSAGE_TYPE_DATA_INDICATION );
+}
+
+/*-----------------------------------------------------------*/
+
+static const BenchMessageCase_t messageCases[] =
+{
+    {
+        "ice_binding_request", SerializeIceBindingRequest,
+        { STUN_ATTRIBUTE_TYPE_USERNAME, STUN_ATTRIBUTE_TYPE_PRIORITY, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING,
+          STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY, STUN_ATTRIBUTE_TYPE_FINGERPRINT }, 6
+    },
+    {
+        "ice_binding_response", SerializeIceBindingResponse,
+        { STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY, STUN_ATTRIBUTE_TYPE_FINGERPRINT }, 3
+    },
+    {
+        "turn_allocate_401", SerializeTurnAllocateUnauthorized,
+        { STUN_ATTRIBUTE_TYPE_ERROR_CODE, STUN_ATTRIBUTE_TYPE_REALM, STUN_ATTRIBUTE_TYPE_NONCE }, 3
+    },
+    {
+        "turn_allocate_request", SerializeTurnAllocateRequest,
+        { STUN_ATTRIBUTE_TYPE_REQUESTED_TRANSPORT, STUN_ATTRIBUTE_TYPE_LIFETIME, STUN_ATTRIBUTE_TYPE_USERNAME,
+          STUN_ATTRIBUTE_TYPE_REALM, STUN_ATTRIBUTE_TYPE_NONCE, STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY }, 6
+    },
+    {
+        "turn_allocate_response", SerializeTurnAllocateResponse,
+        { STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, STUN_ATTRIBUTE_TYPE_LIFETIME,
+          STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY }, 4
+    },
+    {
+        "turn_send_indication", SerializeTurnSendIndication,
+        { STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS, STUN_ATTRIBUTE_TYPE_DATA }, 2
+    },
+    {
+        "turn_data_indication", SerializeTurnDataIndication,
+        { STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS, STUN_ATTRIBUTE_TYPE_DATA }, 2
+    },
+};
+
+/*-----------------------------------------------------------*/
+
+static void Serialize( void * pArg )
+{
+    BenchMessageState_t * pState = ( BenchMessageState_t * ) pArg;
+
+    pState->pCase->serializeFunction( pState );
+
+    benchSink += pState->length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void WalkAttributes( void * pArg )
+{
+    BenchMessageState_t * pState = ( BenchMessageState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    StunResult_t result;
+
+    result = StunDeserializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), pState->length, &( header ) );
+
+    while( result == STUN_RESULT_OK )
+    {
+        result = StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) );
+
+        if( result == STUN_RESULT_OK )
+        {
+            benchSink += attribute.attributeValueLength;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Looks up the attributes the receiver needs and decodes the addresses. */
+static void FindAttributes( void * pArg )
+{
+    BenchMessageState_t * pState = ( BenchMessageState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    StunAttributeAddress_t address;
+    StunAttributeType_t attributeType;
+    size_t i;
+
+    if( StunDeserializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), pState->length, &( header ) ) == STUN_RESULT_OK )
+    {
+        for( i = 0; i < pState->pCase->findAttributeCount; i++ )
+        {
+            attributeType = pState->pCase->findAttributes[ i ];
+
+            if( StunDeserializer_FindAttribute( &( ctx ), attributeType, &( attribute ) ) == STUN_RESULT_OK )
+            {
+                benchSink += attribute.attributeValueLength;
+
+                if( ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) ||
+                    ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) ||
+                    ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) )
+                {
+                    if( StunDeserializer_ParseAttributeAddress( &( ctx ), &( attribute ), &( address ) ) == STUN_RESULT_OK )
+                    {
+                        benchSink += address.port;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchMessages_Run( void )
+{
+    static BenchMessageState_t state;
+    static const uint8_t shortTermPassword[] = "VOkJxbRl1RmTxUk/WvJxBt";
+    static const uint8_t longTermKeyBytes[ 16 ] = { 0x84, 0x93, 0xFB, 0xC5, 0x3B, 0xA5, 0x82, 0xFB, 0x4C, 0x04, 0x4C, 0x45, 0x6B, 0xDC, 0x40, 0xEB };
+    char caseName[ 64 ];
+    size_t i;
+
+    for( i = 0; i < sizeof( turnData ); i++ )
+    {
+        turnData[ i ] = ( uint8_t ) ( i * 31U );
+    }
+
+    ( void ) StunHmac_InitKey( &( shortTermKey ), &( shortTermPassword[ 0 ] ), sizeof( shortTermPassword ) - 1 );
+    ( void ) StunHmac_InitKey( &( longTermKey ), &( longTermKeyBytes[ 0 ] ), sizeof( longTermKeyBytes ) );
+
+    for( i = 0; i < sizeof( messageCases ) / sizeof( messageCases[ 0 ] ); i++ )
+    {
+        state.pCase = &( messageCases[ i ] );
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "%s_serialize", state.pCase->pName );
+        Bench_Run( "messages", caseName, Serialize, &( state ) );
+
+        /* The deserializer cases run on the message left by the serializer. */
+        ( void ) snprintf( caseName, sizeof( caseName ), "%s_get_next_attribute", state.pCase->pName );
+        Bench_Run( "messages", caseName, WalkAttributes, &( state ) );
+
+        ( void ) snprintf( caseName, sizeof( caseName ), "%s_find_attribute", state.pCase->pName );
+        Bench_Run( "messages", caseName, FindAttributes, &( state ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
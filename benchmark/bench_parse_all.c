@@ -0,0 +1,400 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+#include "stun_endianness.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define BENCH_MESSAGE_COUNT    3
+
+typedef struct BenchMessage
+{
+    uint8_t buffer[ 256 ];
+    size_t length;
+} BenchMessage_t;
+
+/* What an ICE agent keeps from the messages it receives. */
+typedef struct BenchParsedMessage
+{
+    StunAttributeAddress_t mappedAddress;
+    uint64_t tieBreaker;
+    uint32_t priority;
+    uint32_t fingerprint;
+    uint16_t usernameLength;
+    uint16_t realmLength;
+    uint16_t nonceLength;
+    uint16_t errorCode;
+    uint8_t useCandidate;
+} BenchParsedMessage_t;
+
+typedef struct BenchParseAll
+{
+    /* Connectivity check, success response and 401 response. */
+    BenchMessage_t messages[ BENCH_MESSAGE_COUNT ];
+    uint32_t nextMessage;
+    StunAttributeHandlerTable_t handlerTable;
+} BenchParseAll_t;
+
+typedef void ( * BenchParseFunction_t )( BenchMessage_t * pMessage,
+                                         const StunAttributeHandlerTable_t * pHandlerTable,
+                                         BenchParsedMessage_t * pParsed );
+
+/*-----------------------------------------------------------*/
+
+static void BuildMessages( BenchMessage_t * pMessages )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttributeAddress_t mappedAddress = { STUN_ADDRESS_IPv4, 50000, { 192, 168, 1, 20 } };
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint8_t integrity[ STUN_HMAC_VALUE_LENGTH ] = { 0 };
+    const char * pUsername = "remoteUfrag:localUfrag";
+    const char * pRealm = "example.org";
+    const char * pNonce = "f//499k954d6OL34oL9FSTvy64sA";
+    const char * pErrorPhrase = "Unauthorized";
+    uint32_t length;
+
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    ( void ) StunSerializer_Init( &( ctx ), &( pMessages[ 0 ].buffer[ 0 ] ), sizeof( pMessages[ 0 ].buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), ( const uint8_t * ) pUsername, ( uint16_t ) strlen( pUsername ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+    pMessages[ 0 ].length = length;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE;
+    ( void ) StunSerializer_Init( &( ctx ), &( pMessages[ 1 ].buffer[ 0 ] ), sizeof( pMessages[ 1 ].buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeXorMappedAddress( &( ctx ), &( mappedAddress ) );
+    ( void ) StunSerializer_AddAttributeIntegrity( &( ctx ), &( integrity[ 0 ] ), sizeof( integrity ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+    pMessages[ 1 ].length = length;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_FAILURE_RESPONSE;
+    ( void ) StunSerializer_Init( &( ctx ), &( pMessages[ 2 ].buffer[ 0 ] ), sizeof( pMessages[ 2 ].buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributeErrorCode( &( ctx ), 401, ( const uint8_t * ) pErrorPhrase, ( uint16_t ) strlen( pErrorPhrase ) );
+    ( void ) StunSerializer_AddAttributeRealm( &( ctx ), ( const uint8_t * ) pRealm, ( uint16_t ) strlen( pRealm ) );
+    ( void ) StunSerializer_AddAttributeNonce( &( ctx ), ( const uint8_t * ) pNonce, ( uint16_t ) strlen( pNonce ) );
+    ( void ) StunSerializer_AddAttributeFingerprint( &( ctx ), 0x12345678 );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+    pMessages[ 2 ].length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void ConsumeParsedMessage( const BenchParsedMessage_t * pParsed )
+{
+    benchSink += pParsed->priority + ( uint32_t ) pParsed->tieBreaker + pParsed->fingerprint +
+                 pParsed->usernameLength + pParsed->realmLength + pParsed->nonceLength +
+                 pParsed->errorCode + pParsed->useCandidate + pParsed->mappedAddress.port;
+}
+
+/*-----------------------------------------------------------*/
+
+static void ParseSwitchLoop( BenchMessage_t * pMessage,
+                             const StunAttributeHandlerTable_t * pHandlerTable,
+                             BenchParsedMessage_t * pParsed )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    StunResult_t result;
+    uint8_t * pErrorPhrase;
+    uint16_t errorPhraseLength;
+
+    ( void ) pHandlerTable;
+
+    result = StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) );
+
+    while( result == STUN_RESULT_OK )
+    {
+        result = StunDeserializer_GetNextAttribute( &( ctx ), &( attribute ) );
+
+        if( result == STUN_RESULT_OK )
+        {
+            switch( attribute.attributeType )
+            {
+                case STUN_ATTRIBUTE_TYPE_USERNAME:
+                    pParsed->usernameLength = attribute.attributeValueLength;
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_PRIORITY:
+                    result = StunDeserializer_ParseAttributePriority( &( ctx ), &( attribute ), &( pParsed->priority ) );
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING:
+                    result = StunDeserializer_ParseAttributeIceControlling( &( ctx ), &( attribute ), &( pParsed->tieBreaker ) );
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_USE_CANDIDATE:
+                    pParsed->useCandidate = 1;
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS:
+                    result = StunDeserializer_ParseAttributeAddress( &( ctx ), &( attribute ), &( pParsed->mappedAddress ) );
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_ERROR_CODE:
+                    result = StunDeserializer_ParseAttributeErrorCode( &( attribute ), &( pParsed->errorCode ), &( pErrorPhrase ), &( errorPhraseLength ) );
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_REALM:
+                    pParsed->realmLength = attribute.attributeValueLength;
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_NONCE:
+                    pParsed->nonceLength = attribute.attributeValueLength;
+                    break;
+
+                case STUN_ATTRIBUTE_TYPE_FINGERPRINT:
+                    result = StunDeserializer_ParseAttributeFingerprint( &( ctx ), &( attribute ), &( pParsed->fingerprint ) );
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t HandleUsername( void * pUserData,
+                                    const StunAttribute_t * pAttribute,
+                                    const StunAttributeValue_t * pValue )
+{
+    ( void ) pValue;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->usernameLength = pAttribute->attributeValueLength;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandlePriority( void * pUserData,
+                                    const StunAttribute_t * pAttribute,
+                                    const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->priority = pValue->uint32Value;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleIceControlling( void * pUserData,
+                                          const StunAttribute_t * pAttribute,
+                                          const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->tieBreaker = pValue->uint64Value;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleUseCandidate( void * pUserData,
+                                        const StunAttribute_t * pAttribute,
+                                        const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+    ( void ) pValue;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->useCandidate = 1;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleXorMappedAddress( void * pUserData,
+                                            const StunAttribute_t * pAttribute,
+                                            const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->mappedAddress = pValue->address;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleErrorCode( void * pUserData,
+                                     const StunAttribute_t * pAttribute,
+                                     const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->errorCode = pValue->error.errorCode;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleRealm( void * pUserData,
+                                 const StunAttribute_t * pAttribute,
+                                 const StunAttributeValue_t * pValue )
+{
+    ( void ) pValue;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->realmLength = pAttribute->attributeValueLength;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleNonce( void * pUserData,
+                                 const StunAttribute_t * pAttribute,
+                                 const StunAttributeValue_t * pValue )
+{
+    ( void ) pValue;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->nonceLength = pAttribute->attributeValueLength;
+
+    return STUN_RESULT_OK;
+}
+
+static StunResult_t HandleFingerprint( void * pUserData,
+                                       const StunAttribute_t * pAttribute,
+                                       const StunAttributeValue_t * pValue )
+{
+    ( void ) pAttribute;
+
+    ( ( BenchParsedMessage_t * ) pUserData )->fingerprint = pValue->uint32Value;
+
+    return STUN_RESULT_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+static void ParseHandlerTable( BenchMessage_t * pMessage,
+                               const StunAttributeHandlerTable_t * pHandlerTable,
+                               BenchParsedMessage_t * pParsed )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    if( StunDeserializer_Init( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( header ) ) == STUN_RESULT_OK )
+    {
+        ( void ) StunDeserializer_ParseAll( &( ctx ), pHandlerTable, pParsed );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ParseDecode( BenchMessage_t * pMessage,
+                         const StunAttributeHandlerTable_t * pHandlerTable,
+                         BenchParsedMessage_t * pParsed )
+{
+    StunContext_t ctx;
+    StunDecodedMessage_t decoded;
+
+    ( void ) pHandlerTable;
+
+    if( StunDeserializer_Decode( &( ctx ), &( pMessage->buffer[ 0 ] ), pMessage->length, &( decoded ) ) == STUN_RESULT_OK )
+    {
+        pParsed->priority = decoded.priority;
+        pParsed->tieBreaker = decoded.tieBreaker;
+        pParsed->usernameLength = decoded.usernameLength;
+        pParsed->useCandidate = ( ( decoded.presentAttributes & STUN_DECODED_FLAG_USE_CANDIDATE ) != 0 ) ? 1 : 0;
+        pParsed->mappedAddress.port = decoded.xorMappedAddress.port;
+        pParsed->errorCode = decoded.errorCode;
+        pParsed->realmLength = decoded.realmLength;
+        pParsed->nonceLength = decoded.nonceLength;
+
+        /* Decode only records where FINGERPRINT is, read its value as the
+         * switch loop does. */
+        if( ( decoded.presentAttributes & STUN_DECODED_FLAG_FINGERPRINT ) != 0 )
+        {
+            pParsed->fingerprint = Stun_ReadUint32( &( pMessage->buffer[ decoded.fingerprintOffset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ) );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void RunSingle( BenchParseAll_t * pParseAll,
+                       BenchParseFunction_t parseFunction )
+{
+    BenchParsedMessage_t parsed = { 0 };
+
+    parseFunction( &( pParseAll->messages[ 0 ] ), &( pParseAll->handlerTable ), &( parsed ) );
+    ConsumeParsedMessage( &( parsed ) );
+}
+
+/* Cycles through the three messages so that the attribute sequence changes on
+ * every call, as it does for an agent handling checks and responses on many
+ * pairs. */
+static void RunMixed( BenchParseAll_t * pParseAll,
+                      BenchParseFunction_t parseFunction )
+{
+    BenchParsedMessage_t parsed = { 0 };
+
+    parseFunction( &( pParseAll->messages[ pParseAll->nextMessage ] ), &( pParseAll->handlerTable ), &( parsed ) );
+    ConsumeParsedMessage( &( parsed ) );
+
+    pParseAll->nextMessage = ( pParseAll->nextMessage + 1U ) % BENCH_MESSAGE_COUNT;
+}
+
+static void SingleSwitchLoop( void * pArg )
+{
+    RunSingle( ( BenchParseAll_t * ) pArg, ParseSwitchLoop );
+}
+
+static void SingleHandlerTable( void * pArg )
+{
+    RunSingle( ( BenchParseAll_t * ) pArg, ParseHandlerTable );
+}
+
+static void SingleDecode( void * pArg )
+{
+    RunSingle( ( BenchParseAll_t * ) pArg, ParseDecode );
+}
+
+static void MixedSwitchLoop( void * pArg )
+{
+    RunMixed( ( BenchParseAll_t * ) pArg, ParseSwitchLoop );
+}
+
+static void MixedHandlerTable( void * pArg )
+{
+    RunMixed( ( BenchParseAll_t * ) pArg, ParseHandlerTable );
+}
+
+static void MixedDecode( void * pArg )
+{
+    RunMixed( ( BenchParseAll_t * ) pArg, ParseDecode );
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchParseAll_Run( void )
+{
+    static BenchParseAll_t parseAll;
+    StunAttributeHandlerTable_t * pTable = &( parseAll.handlerTable );
+
+    BuildMessages( &( parseAll.messages[ 0 ] ) );
+
+    ( void ) StunDeserializer_InitHandlerTable( pTable );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_USERNAME, HandleUsername );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_PRIORITY, HandlePriority );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, HandleIceControlling );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, HandleUseCandidate );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, HandleXorMappedAddress );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_ERROR_CODE, HandleErrorCode );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_REALM, HandleRealm );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_NONCE, HandleNonce );
+    ( void ) StunDeserializer_SetAttributeHandler( pTable, STUN_ATTRIBUTE_TYPE_FINGERPRINT, HandleFingerprint );
+
+    Bench_Run( "parse_all", "ice_check_switch_loop", SingleSwitchLoop, &( parseAll ) );
+    Bench_Run( "parse_all", "ice_check_handler_table", SingleHandlerTable, &( parseAll ) );
+    Bench_Run( "parse_all", "ice_check_decode", SingleDecode, &( parseAll ) );
+    Bench_Run( "parse_all", "mixed_switch_loop", MixedSwitchLoop, &( parseAll ) );
+    Bench_Run( "parse_all", "mixed_handler_table", MixedHandlerTable, &( parseAll ) );
+    Bench_Run( "parse_all", "mixed_decode", MixedDecode, &( parseAll ) );
+}
+
+/*-----------------------------------------------------------*/
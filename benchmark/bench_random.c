@@ -0,0 +1,124 @@
+/* Standard includes. */
+#include <string.h>
+
+#if defined( __linux__ )
+    #include <sys/random.h>
+#endif
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_random.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+typedef struct BenchRandomState
+{
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    uint8_t buffer[ STUN_HEADER_LENGTH ];
+} BenchRandomState_t;
+
+/*-----------------------------------------------------------*/
+
+#if defined( __linux__ )
+
+/* What clients did before the generator: one system call per request. */
+    static void TransactionIdGetrandom( void * pArg )
+    {
+        BenchRandomState_t * pState = ( BenchRandomState_t * ) pArg;
+
+        ( void ) getrandom( ( void * ) &( pState->transactionId[ 0 ] ), sizeof( pState->transactionId ), 0 );
+        benchSink = pState->transactionId[ 0 ];
+    }
+
+#endif /* if defined( __linux__ ) */
+
+/*-----------------------------------------------------------*/
+
+static void TransactionIdGenerator( void * pArg )
+{
+    BenchRandomState_t * pState = ( BenchRandomState_t * ) pArg;
+
+    ( void ) StunRandom_GenerateTransactionId( &( pState->transactionId[ 0 ] ) );
+    benchSink = pState->transactionId[ 0 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void TieBreakerGenerator( void * pArg )
+{
+    uint64_t tieBreaker = 0;
+
+    ( void ) pArg;
+
+    ( void ) StunRandom_GenerateTieBreaker( &( tieBreaker ) );
+    benchSink = ( uint32_t ) tieBreaker;
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializerInitGivenId( void * pArg )
+{
+    BenchRandomState_t * pState = ( BenchRandomState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( pState->transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), sizeof( pState->buffer ), &( header ) );
+    benchSink = pState->buffer[ STUN_HEADER_TRANSACTION_ID_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializerInitGeneratedId( void * pArg )
+{
+    BenchRandomState_t * pState = ( BenchRandomState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    /* A client generates the ID of every new request. */
+    ( void ) StunRandom_GenerateTransactionId( &( pState->transactionId[ 0 ] ) );
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( pState->transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), sizeof( pState->buffer ), &( header ) );
+    benchSink = pState->buffer[ STUN_HEADER_TRANSACTION_ID_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializerInitWrittenId( void * pArg )
+{
+    BenchRandomState_t * pState = ( BenchRandomState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    /* The ID is generated into the header, the one given is overwritten. */
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( pState->transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), sizeof( pState->buffer ), &( header ) );
+    ( void ) StunRandom_WriteTransactionId( &( ctx ) );
+    benchSink = pState->buffer[ STUN_HEADER_TRANSACTION_ID_OFFSET ];
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchRandom_Run( void )
+{
+    static BenchRandomState_t state;
+
+    #if defined( __linux__ )
+        Bench_Run( "random", "transaction_id_getrandom", TransactionIdGetrandom, &( state ) );
+    #endif
+    Bench_Run( "random", "transaction_id_generator", TransactionIdGenerator, &( state ) );
+    Bench_Run( "random", "tie_breaker_generator", TieBreakerGenerator, &( state ) );
+    Bench_Run( "random", "serializer_init_given_id", SerializerInitGivenId, &( state ) );
+    Bench_Run( "random", "serializer_init_generated_id", SerializerInitGeneratedId, &( state ) );
+    Bench_Run( "random", "serializer_init_written_id", SerializerInitWrittenId, &( state ) );
+}
+
+/*-----------------------------------------------------------*/
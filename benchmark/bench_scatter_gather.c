@@ -0,0 +1,116 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* A media packet relayed in a TURN Send indication. */
+#define BENCH_SEND_DATA_LENGTH      1200
+
+/* The largest DATA that fits in a message, as relayed over TCP or TLS. */
+#define BENCH_LARGE_DATA_LENGTH     ( 0xFFFF - 64 )
+
+#define BENCH_SEND_BUFFER_LENGTH    ( BENCH_LARGE_DATA_LENGTH + 200 )
+
+#define BENCH_SCRATCH_LENGTH        128
+
+#define BENCH_MAX_IOVECS            4
+
+typedef struct BenchScatterGatherState
+{
+    int addFingerprint;
+    size_t dataLength;
+    uint8_t data[ BENCH_LARGE_DATA_LENGTH ];
+    uint8_t buffer[ BENCH_SEND_BUFFER_LENGTH ];
+    StunIovec_t iovecs[ BENCH_MAX_IOVECS ];
+    StunScatterGather_t scatterGather;
+} BenchScatterGatherState_t;
+
+static uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0xB7, 0xE7, 0xA7, 0x01, 0xBC, 0x34, 0xD6, 0x86, 0xFA, 0x87, 0xDF, 0xAE };
+static const StunAttributeAddress_t peerAddress = { STUN_ADDRESS_IPv4, 61000, { 198, 51, 100, 4 } };
+
+/*-----------------------------------------------------------*/
+
+static void SerializeSendIndication( BenchScatterGatherState_t * pState,
+                                     size_t bufferLength,
+                                     int useScatterGather )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_SEND_INDICATION;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), bufferLength, &( header ) );
+
+    if( useScatterGather != 0 )
+    {
+        ( void ) StunSerializer_UseScatterGather( &( ctx ),
+                                                  &( pState->scatterGather ),
+                                                  &( pState->iovecs[ 0 ] ),
+                                                  BENCH_MAX_IOVECS );
+    }
+
+    ( void ) StunSerializer_AddAttributeXorPeerAddress( &( ctx ), &( peerAddress ) );
+    ( void ) StunSerializer_AddAttributeData( &( ctx ), &( pState->data[ 0 ] ), pState->dataLength );
+
+    if( pState->addFingerprint != 0 )
+    {
+        ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    }
+
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    benchSink = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeContiguous( void * pArg )
+{
+    BenchScatterGatherState_t * pState = ( BenchScatterGatherState_t * ) pArg;
+
+    SerializeSendIndication( pState, BENCH_SEND_BUFFER_LENGTH, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeScatterGather( void * pArg )
+{
+    BenchScatterGatherState_t * pState = ( BenchScatterGatherState_t * ) pArg;
+
+    SerializeSendIndication( pState, BENCH_SCRATCH_LENGTH, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchScatterGather_Run( void )
+{
+    static BenchScatterGatherState_t state;
+    size_t i;
+
+    for( i = 0; i < sizeof( state.data ); i++ )
+    {
+        state.data[ i ] = ( uint8_t ) ( i * 31U );
+    }
+
+    state.dataLength = BENCH_SEND_DATA_LENGTH;
+    state.addFingerprint = 0;
+    Bench_Run( "scatter_gather", "send_indication_contiguous", SerializeContiguous, &( state ) );
+    Bench_Run( "scatter_gather", "send_indication_scatter_gather", SerializeScatterGather, &( state ) );
+
+    state.addFingerprint = 1;
+    Bench_Run( "scatter_gather", "send_indication_fingerprint_contiguous", SerializeContiguous, &( state ) );
+    Bench_Run( "scatter_gather", "send_indication_fingerprint_scatter_gather", SerializeScatterGather, &( state ) );
+
+    state.dataLength = BENCH_LARGE_DATA_LENGTH;
+    state.addFingerprint = 0;
+    Bench_Run( "scatter_gather", "send_indication_large_contiguous", SerializeContiguous, &( state ) );
+    Bench_Run( "scatter_gather", "send_indication_large_scatter_gather", SerializeScatterGather, &( state ) );
+}
+
+/*-----------------------------------------------------------*/
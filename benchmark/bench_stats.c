@@ -0,0 +1,213 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_deserializer.h"
+#include "stun_stats.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* Threads started one after the other, more than there are blocks. */
+#define BENCH_STATS_THREAD_COUNT    ( 2 * STUN_STATS_MAX_THREADS )
+
+typedef struct BenchStatsState
+{
+    uint8_t buffer[ 64 ];
+    size_t length;
+    StunContext_t ctx;
+    uint32_t failures;
+} BenchStatsState_t;
+
+/*-----------------------------------------------------------*/
+
+/* A 44 byte Binding request with 3 attributes. */
+static void BuildMessage( BenchStatsState_t * pState )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ] = { 0 };
+    uint32_t length;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), sizeof( pState->buffer ), &( header ) );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E7F1EFF );
+    ( void ) StunSerializer_AddAttributeIceControlling( &( ctx ), 0x0123456789ABCDEFULL );
+    ( void ) StunSerializer_AddAttributeUseCandidate( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    pState->length = length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void CheckCount( BenchStatsState_t * pState,
+                        const char * pCounter,
+                        uint64_t before,
+                        uint64_t after,
+                        uint64_t expected )
+{
+    if( ( after - before ) != expected )
+    {
+        ( void ) fprintf( stderr, "stats: %s counted %llu times, expected %llu\n",
+                          pCounter, ( unsigned long long ) ( after - before ), ( unsigned long long ) expected );
+        pState->failures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* One walk of the message by the application, then lookups that walk it
+ * again. Only the walk counts the message and its attributes. */
+static void CheckLookups( BenchStatsState_t * pState )
+{
+    static StunStats_t before, after;
+    StunAttributeIndex_t attributeIndex;
+    StunHeader_t header;
+    StunAttribute_t attribute;
+    uint64_t attributesBefore = 0, attributesAfter = 0;
+    uint16_t count;
+    uint32_t slot, typeIndex = STUN_STATS_MESSAGE_TYPE_INDEX( STUN_MESSAGE_TYPE_BINDING_REQUEST );
+
+    ( void ) StunStats_GetSnapshot( &( before ) );
+
+    ( void ) StunDeserializer_Init( &( pState->ctx ), &( pState->buffer[ 0 ] ), pState->length, &( header ) );
+
+    while( StunDeserializer_GetNextAttribute( &( pState->ctx ), &( attribute ) ) == STUN_RESULT_OK )
+    {
+    }
+
+    ( void ) StunDeserializer_FindAttribute( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_PRIORITY, &( attribute ) );
+    ( void ) StunDeserializer_FindAttribute( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, &( attribute ) );
+    ( void ) StunDeserializer_FindAttributeInstance( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_PRIORITY, 0, &( attribute ) );
+    ( void ) StunDeserializer_GetAttributeCount( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_PRIORITY, &( count ) );
+    ( void ) StunDeserializer_BuildAttributeIndex( &( pState->ctx ), &( attributeIndex ) );
+    ( void ) StunDeserializer_FindAttribute( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, &( attribute ) );
+
+    ( void ) StunStats_GetSnapshot( &( after ) );
+
+    for( slot = 0; slot < STUN_ATTRIBUTE_SLOT_COUNT; slot++ )
+    {
+        attributesBefore += before.attributesDeserialized[ slot ];
+        attributesAfter += after.attributesDeserialized[ slot ];
+    }
+
+    CheckCount( pState, "messagesDeserialized", before.messagesDeserialized[ typeIndex ], after.messagesDeserialized[ typeIndex ], 1 );
+    CheckCount( pState, "bytesDeserialized", before.bytesDeserialized, after.bytesDeserialized, pState->length );
+    CheckCount( pState, "attributesDeserialized", attributesBefore, attributesAfter, 3 );
+    CheckCount( pState, "Init OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_INIT ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_INIT ][ STUN_RESULT_OK ], 1 );
+    CheckCount( pState, "GetNextAttribute OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_GET_NEXT_ATTRIBUTE ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_GET_NEXT_ATTRIBUTE ][ STUN_RESULT_OK ], 3 );
+    CheckCount( pState, "FindAttribute OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE ][ STUN_RESULT_OK ], 3 );
+    CheckCount( pState, "FindAttributeInstance OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE_INSTANCE ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE_INSTANCE ][ STUN_RESULT_OK ], 1 );
+    CheckCount( pState, "GetAttributeCount OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_GET_ATTRIBUTE_COUNT ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_GET_ATTRIBUTE_COUNT ][ STUN_RESULT_OK ], 1 );
+    CheckCount( pState, "BuildAttributeIndex OK",
+                before.results[ STUN_STATS_API_DESERIALIZER_BUILD_ATTRIBUTE_INDEX ][ STUN_RESULT_OK ],
+                after.results[ STUN_STATS_API_DESERIALIZER_BUILD_ATTRIBUTE_INDEX ][ STUN_RESULT_OK ], 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void * CountFromThread( void * pArg )
+{
+    BenchStatsState_t * pState = ( BenchStatsState_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+
+    ( void ) StunDeserializer_Init( &( ctx ), &( pState->buffer[ 0 ] ), pState->length, &( header ) );
+
+    /* The threads before this one gave their blocks back when they exited. */
+    if( pStunStatsThreadBlock->isShared != 0U )
+    {
+        ( void ) fprintf( stderr, "stats: thread counts into the shared block\n" );
+        pState->failures++;
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Blocks are reused by new threads and keep the counts of the old ones. */
+static void CheckThreads( BenchStatsState_t * pState )
+{
+    static StunStats_t before, after;
+    StunHeader_t header;
+    pthread_t thread;
+    uint32_t i, typeIndex = STUN_STATS_MESSAGE_TYPE_INDEX( STUN_MESSAGE_TYPE_BINDING_REQUEST );
+
+    ( void ) StunStats_GetSnapshot( &( before ) );
+
+    for( i = 0; i < BENCH_STATS_THREAD_COUNT; i++ )
+    {
+        if( pthread_create( &( thread ), NULL, CountFromThread, pState ) == 0 )
+        {
+            ( void ) pthread_join( thread, NULL );
+        }
+        else
+        {
+            ( void ) CountFromThread( pState );
+        }
+    }
+
+    /* This thread gives its block back and takes one again. */
+    ( void ) StunStats_ReleaseThread();
+    ( void ) StunDeserializer_Init( &( pState->ctx ), &( pState->buffer[ 0 ] ), pState->length, &( header ) );
+
+    ( void ) StunStats_GetSnapshot( &( after ) );
+
+    CheckCount( pState, "messagesDeserialized from threads", before.messagesDeserialized[ typeIndex ],
+                after.messagesDeserialized[ typeIndex ], BENCH_STATS_THREAD_COUNT + 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void FindAttribute( void * pArg )
+{
+    BenchStatsState_t * pState = ( BenchStatsState_t * ) pArg;
+    StunAttribute_t attribute;
+
+    ( void ) StunDeserializer_FindAttribute( &( pState->ctx ), STUN_ATTRIBUTE_TYPE_USE_CANDIDATE, &( attribute ) );
+    benchSink += attribute.attributeValueLength;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Exits the benchmark if the counts are wrong. */
+void BenchStats_Run( void )
+{
+    static BenchStatsState_t state;
+    StunHeader_t header;
+
+    memset( ( void * ) &( state ), 0, sizeof( state ) );
+    BuildMessage( &( state ) );
+
+    CheckLookups( &( state ) );
+    CheckThreads( &( state ) );
+
+    if( state.failures != 0U )
+    {
+        ( void ) fprintf( stderr, "stats: check failed\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    ( void ) StunDeserializer_Init( &( state.ctx ), &( state.buffer[ 0 ] ), state.length, &( header ) );
+    Bench_Run( "stats", "find_attribute_counted", FindAttribute, &( state ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,183 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_serializer.h"
+#include "stun_template.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define BENCH_TEMPLATE_BUFFER_LENGTH    128
+
+typedef struct BenchTemplateState
+{
+    int addIntegrity;
+    StunTemplate_t messageTemplate;
+    uint8_t templateBuffer[ BENCH_TEMPLATE_BUFFER_LENGTH ];
+    uint8_t request[ BENCH_TEMPLATE_BUFFER_LENGTH ];
+    uint32_t requestLength;
+    uint8_t received[ BENCH_TEMPLATE_BUFFER_LENGTH ];
+    uint8_t buffer[ BENCH_TEMPLATE_BUFFER_LENGTH ];
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    StunAttributeAddress_t address;
+} BenchTemplateState_t;
+
+static StunHmacKey_t hmacKey;
+
+/*-----------------------------------------------------------*/
+
+/* Every response goes to a different transaction and port, as they would on a
+ * server. The request is copied into pBuffer, as if received there, in every
+ * case, so that only the way the response is built differs between them. */
+static void ReceiveRequest( BenchTemplateState_t * pState,
+                            uint8_t * pBuffer )
+{
+    pState->transactionId[ 0 ]++;
+    pState->address.port++;
+
+    memcpy( ( void * ) pBuffer, ( const void * ) &( pState->request[ 0 ] ), pState->requestLength );
+    memcpy( ( void * ) &( pBuffer[ STUN_HEADER_TRANSACTION_ID_OFFSET ] ), ( const void * ) &( pState->transactionId[ 0 ] ), STUN_HEADER_TRANSACTION_ID_LENGTH );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t SerializeBindingSuccess( BenchTemplateState_t * pState,
+                                         uint8_t * pTransactionId,
+                                         uint8_t * pBuffer )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE;
+    header.pTransactionId = pTransactionId;
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, BENCH_TEMPLATE_BUFFER_LENGTH, &( header ) );
+    ( void ) StunSerializer_AddAttributeXorMappedAddress( &( ctx ), &( pState->address ) );
+
+    if( pState->addIntegrity != 0 )
+    {
+        ( void ) StunSerializer_AddIntegrity( &( ctx ), &( hmacKey ) );
+    }
+
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeWithSerializer( void * pArg )
+{
+    BenchTemplateState_t * pState = ( BenchTemplateState_t * ) pArg;
+
+    ReceiveRequest( pState, &( pState->received[ 0 ] ) );
+    benchSink = SerializeBindingSuccess( pState,
+                                         &( pState->received[ STUN_HEADER_TRANSACTION_ID_OFFSET ] ),
+                                         &( pState->buffer[ 0 ] ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeWithTemplate( void * pArg )
+{
+    BenchTemplateState_t * pState = ( BenchTemplateState_t * ) pArg;
+
+    ReceiveRequest( pState, &( pState->received[ 0 ] ) );
+    ( void ) StunTemplate_Instantiate( &( pState->messageTemplate ),
+                                       &( pState->buffer[ 0 ] ),
+                                       sizeof( pState->buffer ),
+                                       &( pState->received[ STUN_HEADER_TRANSACTION_ID_OFFSET ] ) );
+    ( void ) StunTemplate_PatchAddress( &( pState->messageTemplate ),
+                                        &( pState->buffer[ 0 ] ),
+                                        STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS,
+                                        &( pState->address ) );
+    ( void ) StunTemplate_Finish( &( pState->messageTemplate ),
+                                  &( pState->buffer[ 0 ] ),
+                                  &( hmacKey ) );
+    benchSink = pState->buffer[ STUN_HEADER_LENGTH - 1 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t SerializeBindingRequest( BenchTemplateState_t * pState,
+                                         uint8_t * pBuffer )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    static const uint8_t userName[] = "evtj:h6vY";
+    uint32_t length = 0;
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( pState->transactionId[ 0 ] );
+
+    ( void ) StunSerializer_Init( &( ctx ), pBuffer, BENCH_TEMPLATE_BUFFER_LENGTH, &( header ) );
+    ( void ) StunSerializer_AddAttributeUsername( &( ctx ), &( userName[ 0 ] ), sizeof( userName ) - 1 );
+    ( void ) StunSerializer_AddAttributePriority( &( ctx ), 0x6E0001FFU );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( hmacKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void SerializeInPlace( void * pArg )
+{
+    BenchTemplateState_t * pState = ( BenchTemplateState_t * ) pArg;
+    StunContext_t ctx;
+    uint32_t length = 0;
+
+    /* The request is received into the buffer the response is sent from. */
+    ReceiveRequest( pState, &( pState->buffer[ 0 ] ) );
+
+    ( void ) StunSerializer_InitResponseInPlace( &( ctx ),
+                                                 &( pState->buffer[ 0 ] ),
+                                                 sizeof( pState->buffer ),
+                                                 STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE );
+    ( void ) StunSerializer_AddAttributeXorMappedAddress( &( ctx ), &( pState->address ) );
+    ( void ) StunSerializer_AddIntegrity( &( ctx ), &( hmacKey ) );
+    ( void ) StunSerializer_AddFingerprint( &( ctx ) );
+    ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+    benchSink = length;
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchTemplate_Run( void )
+{
+    static BenchTemplateState_t state;
+    static const uint8_t password[] = "VOkJxbRl1RmTxUk/WvJxBt";
+    static const StunAttributeAddress_t address = { STUN_ADDRESS_IPv4, 50123, { 203, 0, 113, 17 } };
+    uint32_t length;
+
+    ( void ) StunHmac_InitKey( &( hmacKey ), &( password[ 0 ] ), sizeof( password ) - 1 );
+
+    state.requestLength = SerializeBindingRequest( &( state ), &( state.request[ 0 ] ) );
+
+    for( state.addIntegrity = 1; state.addIntegrity >= 0; state.addIntegrity-- )
+    {
+        memset( ( void * ) &( state.transactionId[ 0 ] ), 0x5A, sizeof( state.transactionId ) );
+        state.address = address;
+
+        length = SerializeBindingSuccess( &( state ), &( state.transactionId[ 0 ] ), &( state.templateBuffer[ 0 ] ) );
+        ( void ) StunTemplate_Compile( &( state.messageTemplate ), &( state.templateBuffer[ 0 ] ), length );
+
+        if( state.addIntegrity != 0 )
+        {
+            Bench_Run( "template", "binding_success_serializer", SerializeWithSerializer, &( state ) );
+            Bench_Run( "template", "binding_success_template", SerializeWithTemplate, &( state ) );
+            Bench_Run( "template", "binding_success_in_place", SerializeInPlace, &( state ) );
+        }
+        else
+        {
+            Bench_Run( "template", "binding_success_no_integrity_serializer", SerializeWithSerializer, &( state ) );
+            Bench_Run( "template", "binding_success_no_integrity_template", SerializeWithTemplate, &( state ) );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
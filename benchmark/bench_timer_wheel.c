@@ -0,0 +1,217 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_timer_wheel.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+/* Outstanding transactions, all re-armed BENCH_TIMER_DELAY ticks after they
+ * expire, so that BENCH_TIMER_COUNT / BENCH_TIMER_DELAY expire every tick. */
+#define BENCH_TIMER_COUNT       16384
+#define BENCH_TIMER_DELAY       1024
+#define BENCH_TIMER_PER_TICK    ( BENCH_TIMER_COUNT / BENCH_TIMER_DELAY )
+
+/* Min-heap of expiries with the position of every timer, as a scheduler based
+ * on a binary heap needs to cancel timers. */
+typedef struct BenchTimerHeap
+{
+    uint32_t timers[ BENCH_TIMER_COUNT ];
+    uint32_t positions[ BENCH_TIMER_COUNT ];
+    uint64_t expiries[ BENCH_TIMER_COUNT ];
+    uint32_t count;
+} BenchTimerHeap_t;
+
+typedef struct BenchTimerState
+{
+    StunTimerWheel_t wheel;
+    StunTimer_t timers[ BENCH_TIMER_COUNT ];
+    BenchTimerHeap_t heap;
+    uint64_t now;
+    uint32_t next;
+} BenchTimerState_t;
+
+/*-----------------------------------------------------------*/
+
+static void HeapSwap( BenchTimerHeap_t * pHeap,
+                      uint32_t a,
+                      uint32_t b )
+{
+    uint32_t timer = pHeap->timers[ a ];
+
+    pHeap->timers[ a ] = pHeap->timers[ b ];
+    pHeap->timers[ b ] = timer;
+    pHeap->positions[ pHeap->timers[ a ] ] = a;
+    pHeap->positions[ pHeap->timers[ b ] ] = b;
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapSiftUp( BenchTimerHeap_t * pHeap,
+                        uint32_t position )
+{
+    while( ( position > 0 ) &&
+           ( pHeap->expiries[ pHeap->timers[ position ] ] < pHeap->expiries[ pHeap->timers[ ( position - 1 ) / 2 ] ] ) )
+    {
+        HeapSwap( pHeap, position, ( position - 1 ) / 2 );
+        position = ( position - 1 ) / 2;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapSiftDown( BenchTimerHeap_t * pHeap,
+                          uint32_t position )
+{
+    uint32_t smallest, child;
+    int done = 0;
+
+    while( done == 0 )
+    {
+        smallest = position;
+
+        for( child = 2 * position + 1; ( child <= 2 * position + 2 ) && ( child < pHeap->count ); child++ )
+        {
+            if( pHeap->expiries[ pHeap->timers[ child ] ] < pHeap->expiries[ pHeap->timers[ smallest ] ] )
+            {
+                smallest = child;
+            }
+        }
+
+        if( smallest == position )
+        {
+            done = 1;
+        }
+        else
+        {
+            HeapSwap( pHeap, position, smallest );
+            position = smallest;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapPush( BenchTimerHeap_t * pHeap,
+                      uint32_t timer,
+                      uint64_t expiry )
+{
+    pHeap->expiries[ timer ] = expiry;
+    pHeap->timers[ pHeap->count ] = timer;
+    pHeap->positions[ timer ] = pHeap->count;
+    pHeap->count++;
+    HeapSiftUp( pHeap, pHeap->count - 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapRemove( BenchTimerHeap_t * pHeap,
+                        uint32_t timer )
+{
+    uint32_t position = pHeap->positions[ timer ];
+
+    pHeap->count--;
+
+    if( position != pHeap->count )
+    {
+        HeapSwap( pHeap, position, pHeap->count );
+        HeapSiftDown( pHeap, position );
+        HeapSiftUp( pHeap, position );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void RearmExpired( void * pCallbackContext,
+                          StunTimer_t * const * ppTimers,
+                          size_t timerCount )
+{
+    BenchTimerState_t * pState = ( BenchTimerState_t * ) pCallbackContext;
+    size_t i;
+
+    for( i = 0; i < timerCount; i++ )
+    {
+        ( void ) StunTimerWheel_Arm( &( pState->wheel ), ppTimers[ i ], BENCH_TIMER_DELAY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* A response arrives and a new transaction starts. */
+static void WheelCancelArm( void * pArg )
+{
+    BenchTimerState_t * pState = ( BenchTimerState_t * ) pArg;
+    StunTimer_t * pTimer = &( pState->timers[ pState->next++ % BENCH_TIMER_COUNT ] );
+
+    ( void ) StunTimerWheel_Cancel( &( pState->wheel ), pTimer );
+    ( void ) StunTimerWheel_Arm( &( pState->wheel ), pTimer, pTimer->expiry - pState->wheel.currentTick );
+    benchSink += ( uint32_t ) pTimer->expiry;
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapCancelArm( void * pArg )
+{
+    BenchTimerState_t * pState = ( BenchTimerState_t * ) pArg;
+    uint32_t timer = pState->next++ % BENCH_TIMER_COUNT;
+    uint64_t expiry = pState->heap.expiries[ timer ];
+
+    HeapRemove( &( pState->heap ), timer );
+    HeapPush( &( pState->heap ), timer, expiry );
+    benchSink += ( uint32_t ) expiry;
+}
+
+/*-----------------------------------------------------------*/
+
+static void WheelExpire( void * pArg )
+{
+    BenchTimerState_t * pState = ( BenchTimerState_t * ) pArg;
+
+    ( void ) StunTimerWheel_Advance( &( pState->wheel ), pState->wheel.currentTick + 1 );
+    benchSink += ( uint32_t ) pState->wheel.currentTick;
+}
+
+/*-----------------------------------------------------------*/
+
+static void HeapExpire( void * pArg )
+{
+    BenchTimerState_t * pState = ( BenchTimerState_t * ) pArg;
+    BenchTimerHeap_t * pHeap = &( pState->heap );
+    uint32_t timer;
+
+    pState->now++;
+
+    while( pHeap->expiries[ pHeap->timers[ 0 ] ] <= pState->now )
+    {
+        timer = pHeap->timers[ 0 ];
+        HeapRemove( pHeap, timer );
+        HeapPush( pHeap, timer, pState->now + BENCH_TIMER_DELAY );
+    }
+
+    benchSink += ( uint32_t ) pState->now;
+}
+
+/*-----------------------------------------------------------*/
+
+void BenchTimerWheel_Run( void )
+{
+    static BenchTimerState_t state;
+    uint32_t i;
+
+    memset( ( void * ) &( state ), 0, sizeof( state ) );
+    ( void ) StunTimerWheel_Init( &( state.wheel ), 0, RearmExpired, &( state ) );
+
+    for( i = 0; i < BENCH_TIMER_COUNT; i++ )
+    {
+        ( void ) StunTimerWheel_Arm( &( state.wheel ), &( state.timers[ i ] ), 1 + ( i % BENCH_TIMER_DELAY ) );
+        HeapPush( &( state.heap ), i, 1 + ( i % BENCH_TIMER_DELAY ) );
+    }
+
+    Bench_Run( "timer_wheel", "cancel_arm_wheel", WheelCancelArm, &( state ) );
+    Bench_Run( "timer_wheel", "cancel_arm_heap", HeapCancelArm, &( state ) );
+    Bench_RunBatch( "timer_wheel", "expire_rearm_wheel", WheelExpire, &( state ), BENCH_TIMER_PER_TICK );
+    Bench_RunBatch( "timer_wheel", "expire_rearm_heap", HeapExpire, &( state ), BENCH_TIMER_PER_TICK );
+}
+
+/*-----------------------------------------------------------*/
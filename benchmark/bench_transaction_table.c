@@ -0,0 +1,439 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    #include <pthread.h>
+#endif
+
+/* API includes. */
+#include "stun_transaction_table.h"
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+#define BENCH_TRANSACTION_GROUP_COUNT    1024
+#define BENCH_TRANSACTION_COUNT          8192 /* Half full. */
+#define BENCH_TRANSACTION_CHURN_ROUNDS   8
+
+/* Threads sharing the table in the contended case and the concurrency check,
+ * and the operations each of them performs per run. */
+#define BENCH_TRANSACTION_THREAD_COUNT   4
+#define BENCH_TRANSACTION_THREAD_OPS     4096
+
+/* The concurrency check uses a small table, 3/4 full, so that groups
+ * overflow and removed entries are reused while other threads probe them. */
+#define CHECK_TRANSACTION_GROUP_COUNT    64
+#define CHECK_TRANSACTION_PER_THREAD     ( CHECK_TRANSACTION_GROUP_COUNT * STUN_TRANSACTION_TABLE_GROUP_SIZE * 3 / 4 / BENCH_TRANSACTION_THREAD_COUNT )
+#define CHECK_TRANSACTION_SHARED_COUNT   32
+#define CHECK_TRANSACTION_ROUNDS         64
+
+typedef struct BenchTransactionState
+{
+    StunTransactionTable_t table;
+    StunTransactionThread_t threads[ BENCH_TRANSACTION_THREAD_COUNT ];
+    uint32_t next;
+    uint32_t nextMiss;
+    #if defined( __unix__ ) || defined( __APPLE__ )
+        pthread_mutex_t mutex;
+    #endif
+} BenchTransactionState_t;
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+
+    typedef struct BenchTransactionWorker
+    {
+        pthread_t handle;
+        StunTransactionTable_t * pTable;
+        size_t threadIndex;
+        uint32_t failures;
+    } BenchTransactionWorker_t;
+
+#endif
+
+static StunTransactionGroup_t transactionGroups[ BENCH_TRANSACTION_GROUP_COUNT ];
+static uint8_t transactionIds[ BENCH_TRANSACTION_COUNT ][ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    static StunTransactionGroup_t checkGroups[ CHECK_TRANSACTION_GROUP_COUNT ];
+    static uint8_t checkSharedIds[ CHECK_TRANSACTION_SHARED_COUNT ][ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    static uint32_t checkSharedRemovals[ CHECK_TRANSACTION_SHARED_COUNT ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Transaction IDs are random on the wire, any simple scrambling will do. */
+static void MakeTransactionId( uint32_t index,
+                               uint32_t salt,
+                               uint8_t * pTransactionId )
+{
+    uint64_t value = ( ( uint64_t ) index + 1 ) * 0xD6E8FEB86659FD93ULL ^ salt;
+    uint32_t i;
+
+    for( i = 0; i < STUN_HEADER_TRANSACTION_ID_LENGTH; i++ )
+    {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        pTransactionId[ i ] = ( uint8_t ) ( value >> 56 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void LookupHit( void * pArg )
+{
+    BenchTransactionState_t * pState = ( BenchTransactionState_t * ) pArg;
+    void * pContext = NULL;
+
+    ( void ) StunTransactionTable_Lookup( &( pState->table ),
+                                          0,
+                                          &( transactionIds[ pState->next++ % BENCH_TRANSACTION_COUNT ][ 0 ] ),
+                                          &( pContext ) );
+    benchSink += ( uint32_t ) ( uintptr_t ) pContext;
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+
+/* The same lookup behind a mutex, as applications match responses today.
+ * Uncontended, so this only shows the cost of the lock itself. */
+    static void LookupHitLocked( void * pArg )
+    {
+        BenchTransactionState_t * pState = ( BenchTransactionState_t * ) pArg;
+
+        ( void ) pthread_mutex_lock( &( pState->mutex ) );
+        LookupHit( pArg );
+        ( void ) pthread_mutex_unlock( &( pState->mutex ) );
+    }
+
+#endif /* if defined( __unix__ ) || defined( __APPLE__ ) */
+
+/*-----------------------------------------------------------*/
+
+static void LookupMiss( void * pArg )
+{
+    BenchTransactionState_t * pState = ( BenchTransactionState_t * ) pArg;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    void * pContext = NULL;
+
+    /* A response to a transaction that already completed or never existed. */
+    MakeTransactionId( pState->nextMiss++, 0x5A5A5A5AU, &( transactionId[ 0 ] ) );
+
+    benchSink += ( uint32_t ) StunTransactionTable_Lookup( &( pState->table ),
+                                                           0,
+                                                           &( transactionId[ 0 ] ),
+                                                           &( pContext ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A request sent and its response received: one insert and one remove, with
+ * the table staying half full. */
+static void InsertRemove( void * pArg )
+{
+    BenchTransactionState_t * pState = ( BenchTransactionState_t * ) pArg;
+    uint8_t * pTransactionId = &( transactionIds[ pState->next++ % BENCH_TRANSACTION_COUNT ][ 0 ] );
+    void * pContext = NULL;
+
+    ( void ) StunTransactionTable_Remove( &( pState->table ), 0, pTransactionId, &( pContext ), NULL );
+    ( void ) StunTransactionTable_Insert( &( pState->table ), 0, pTransactionId, pContext );
+    benchSink += ( uint32_t ) ( uintptr_t ) pContext;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replaces every transaction with a new one, so that each round leaves a
+ * removed entry behind for every transaction. */
+static void ChurnTransactions( BenchTransactionState_t * pState )
+{
+    uint32_t round, i;
+    void * pContext = NULL;
+
+    for( round = 1; round <= BENCH_TRANSACTION_CHURN_ROUNDS; round++ )
+    {
+        for( i = 0; i < BENCH_TRANSACTION_COUNT; i++ )
+        {
+            ( void ) StunTransactionTable_Remove( &( pState->table ), 0, &( transactionIds[ i ][ 0 ] ), &( pContext ), NULL );
+            MakeTransactionId( i, round, &( transactionIds[ i ][ 0 ] ) );
+            ( void ) StunTransactionTable_Insert( &( pState->table ), 0, &( transactionIds[ i ][ 0 ] ), pContext );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+
+/* Each thread looks up transactions of all the threads and replaces its own,
+ * as threads receiving responses and sending requests on one table. */
+    static void * ContendedWorker( void * pArg )
+    {
+        BenchTransactionWorker_t * pWorker = ( BenchTransactionWorker_t * ) pArg;
+        uint8_t * pTransactionId;
+        void * pContext = NULL;
+        uint32_t i, index;
+
+        for( i = 0; i < BENCH_TRANSACTION_THREAD_OPS; i++ )
+        {
+            index = ( ( i * 2654435761U ) + ( uint32_t ) pWorker->threadIndex ) % BENCH_TRANSACTION_COUNT;
+            ( void ) StunTransactionTable_Lookup( pWorker->pTable, pWorker->threadIndex, &( transactionIds[ index ][ 0 ] ), &( pContext ) );
+
+            /* Only this thread replaces the transactions at its indexes. */
+            index -= index % BENCH_TRANSACTION_THREAD_COUNT;
+            pTransactionId = &( transactionIds[ index + pWorker->threadIndex ][ 0 ] );
+
+            if( StunTransactionTable_Remove( pWorker->pTable, pWorker->threadIndex, pTransactionId, &( pContext ), NULL ) == STUN_RESULT_OK )
+            {
+                ( void ) StunTransactionTable_Insert( pWorker->pTable, pWorker->threadIndex, pTransactionId, pContext );
+            }
+        }
+
+        return NULL;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Runs a function on all the threads of the table at once. */
+    static uint32_t RunWorkers( StunTransactionTable_t * pTable,
+                                void * ( *workerFunction )( void * ) )
+    {
+        BenchTransactionWorker_t workers[ BENCH_TRANSACTION_THREAD_COUNT ];
+        uint32_t failures = 0;
+        size_t i;
+
+        for( i = 0; i < BENCH_TRANSACTION_THREAD_COUNT; i++ )
+        {
+            workers[ i ].pTable = pTable;
+            workers[ i ].threadIndex = i;
+            workers[ i ].failures = 0;
+
+            if( pthread_create( &( workers[ i ].handle ), NULL, workerFunction, &( workers[ i ] ) ) != 0 )
+            {
+                /* Run it here instead. */
+                ( void ) workerFunction( &( workers[ i ] ) );
+                workers[ i ].handle = pthread_self();
+            }
+        }
+
+        for( i = 0; i < BENCH_TRANSACTION_THREAD_COUNT; i++ )
+        {
+            if( pthread_equal( workers[ i ].handle, pthread_self() ) == 0 )
+            {
+                ( void ) pthread_join( workers[ i ].handle, NULL );
+            }
+
+            failures += workers[ i ].failures;
+        }
+
+        return failures;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Thread creation is included, and amortized over BENCH_TRANSACTION_THREAD_OPS
+ * operations per thread. */
+    static void Contended( void * pArg )
+    {
+        BenchTransactionState_t * pState = ( BenchTransactionState_t * ) pArg;
+
+        ( void ) RunWorkers( &( pState->table ), ContendedWorker );
+        benchSink += ( uint32_t ) pState->table.epoch;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Counts a failed check without stopping the other threads. */
+    static void CheckFailed( BenchTransactionWorker_t * pWorker,
+                             const char * pCheck,
+                             uint32_t index )
+    {
+        ( void ) fprintf( stderr, "transaction_table: thread %u: %s (transaction %u)\n",
+                          ( unsigned ) pWorker->threadIndex, pCheck, ( unsigned ) index );
+        pWorker->failures++;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Inserts, finds and removes transactions that only this thread uses, while
+ * the other threads do the same on the same groups, and races them to remove
+ * the shared transactions. */
+    static void * CheckWorker( void * pArg )
+    {
+        BenchTransactionWorker_t * pWorker = ( BenchTransactionWorker_t * ) pArg;
+        uint8_t ownIds[ CHECK_TRANSACTION_PER_THREAD ][ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+        uint8_t inserted[ CHECK_TRANSACTION_PER_THREAD ];
+        void * pContext;
+        uint32_t round, i, first = ( uint32_t ) pWorker->threadIndex * CHECK_TRANSACTION_PER_THREAD;
+        StunResult_t result;
+
+        for( i = 0; i < CHECK_TRANSACTION_SHARED_COUNT; i++ )
+        {
+            if( StunTransactionTable_Remove( pWorker->pTable, pWorker->threadIndex, &( checkSharedIds[ i ][ 0 ] ), &( pContext ), NULL ) == STUN_RESULT_OK )
+            {
+                if( pContext != &( checkSharedIds[ i ][ 0 ] ) )
+                {
+                    CheckFailed( pWorker, "wrong context removed", i );
+                }
+
+                ( void ) __atomic_fetch_add( &( checkSharedRemovals[ i ] ), 1U, __ATOMIC_RELAXED );
+            }
+        }
+
+        for( round = 0; round < CHECK_TRANSACTION_ROUNDS; round++ )
+        {
+            for( i = 0; i < CHECK_TRANSACTION_PER_THREAD; i++ )
+            {
+                MakeTransactionId( first + i, 0xC0DE0000U + round, &( ownIds[ i ][ 0 ] ) );
+                result = StunTransactionTable_Insert( pWorker->pTable, pWorker->threadIndex, &( ownIds[ i ][ 0 ] ), &( ownIds[ i ][ 0 ] ) );
+
+                /* Full groups, or removed entries other threads may still be
+                 * reading, are not an error. */
+                inserted[ i ] = ( result == STUN_RESULT_OK ) ? 1U : 0U;
+
+                if( ( result != STUN_RESULT_OK ) && ( result != STUN_RESULT_OUT_OF_MEMORY ) )
+                {
+                    CheckFailed( pWorker, "insert failed", first + i );
+                }
+            }
+
+            for( i = 0; i < CHECK_TRANSACTION_PER_THREAD; i++ )
+            {
+                pContext = NULL;
+                result = StunTransactionTable_Lookup( pWorker->pTable, pWorker->threadIndex, &( ownIds[ i ][ 0 ] ), &( pContext ) );
+
+                if( inserted[ i ] == 0U )
+                {
+                    if( result != STUN_RESULT_TRANSACTION_NOT_FOUND )
+                    {
+                        CheckFailed( pWorker, "transaction found after failed insert", first + i );
+                    }
+                }
+                else if( ( result != STUN_RESULT_OK ) || ( pContext != &( ownIds[ i ][ 0 ] ) ) )
+                {
+                    CheckFailed( pWorker, "inserted transaction not found", first + i );
+                }
+                else
+                {
+                    /* Found. */
+                }
+            }
+
+            for( i = 0; i < CHECK_TRANSACTION_PER_THREAD; i++ )
+            {
+                pContext = NULL;
+                result = StunTransactionTable_Remove( pWorker->pTable, pWorker->threadIndex, &( ownIds[ i ][ 0 ] ), &( pContext ), NULL );
+
+                if( ( inserted[ i ] != 0U ) &&
+                    ( ( result != STUN_RESULT_OK ) || ( pContext != &( ownIds[ i ][ 0 ] ) ) ) )
+                {
+                    CheckFailed( pWorker, "inserted transaction not removed", first + i );
+                }
+
+                if( StunTransactionTable_Lookup( pWorker->pTable, pWorker->threadIndex, &( ownIds[ i ][ 0 ] ), &( pContext ) ) != STUN_RESULT_TRANSACTION_NOT_FOUND )
+                {
+                    CheckFailed( pWorker, "transaction found after remove", first + i );
+                }
+            }
+        }
+
+        return NULL;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Exits the benchmark if the table loses, duplicates or mixes up transactions
+ * when threads use it at the same time. */
+    static void CheckConcurrency( void )
+    {
+        static StunTransactionTable_t table;
+        static StunTransactionThread_t threads[ BENCH_TRANSACTION_THREAD_COUNT ];
+        uint32_t failures, i, g, count = 0;
+
+        memset( ( void * ) &( checkGroups[ 0 ] ), 0, sizeof( checkGroups ) );
+        ( void ) StunTransactionTable_Init( &( table ), &( checkGroups[ 0 ] ), CHECK_TRANSACTION_GROUP_COUNT, &( threads[ 0 ] ), BENCH_TRANSACTION_THREAD_COUNT );
+
+        for( i = 0; i < CHECK_TRANSACTION_SHARED_COUNT; i++ )
+        {
+            MakeTransactionId( i, 0x5E5E5E5EU, &( checkSharedIds[ i ][ 0 ] ) );
+            ( void ) StunTransactionTable_Insert( &( table ), 0, &( checkSharedIds[ i ][ 0 ] ), &( checkSharedIds[ i ][ 0 ] ) );
+            checkSharedRemovals[ i ] = 0;
+        }
+
+        failures = RunWorkers( &( table ), CheckWorker );
+
+        for( i = 0; i < CHECK_TRANSACTION_SHARED_COUNT; i++ )
+        {
+            if( checkSharedRemovals[ i ] != 1U )
+            {
+                ( void ) fprintf( stderr, "transaction_table: shared transaction %u removed %u times\n",
+                                  ( unsigned ) i, ( unsigned ) checkSharedRemovals[ i ] );
+                failures++;
+            }
+        }
+
+        /* Every transaction was removed, so every overflow was undone. */
+        for( g = 0; g < CHECK_TRANSACTION_GROUP_COUNT; g++ )
+        {
+            count += checkGroups[ g ].overflowCount;
+        }
+
+        if( count != 0U )
+        {
+            ( void ) fprintf( stderr, "transaction_table: %u overflows left in an empty table\n", ( unsigned ) count );
+            failures++;
+        }
+
+        if( failures != 0U )
+        {
+            ( void ) fprintf( stderr, "transaction_table: concurrency check failed\n" );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+#endif /* if defined( __unix__ ) || defined( __APPLE__ ) */
+
+/*-----------------------------------------------------------*/
+
+void BenchTransactionTable_Run( void )
+{
+    static BenchTransactionState_t state;
+    uint32_t i;
+
+    #if defined( __unix__ ) || defined( __APPLE__ )
+        CheckConcurrency();
+    #endif
+
+    ( void ) StunTransactionTable_Init( &( state.table ),
+                                        &( transactionGroups[ 0 ] ),
+                                        BENCH_TRANSACTION_GROUP_COUNT,
+                                        &( state.threads[ 0 ] ),
+                                        BENCH_TRANSACTION_THREAD_COUNT );
+
+    for( i = 0; i < BENCH_TRANSACTION_COUNT; i++ )
+    {
+        MakeTransactionId( i, 0, &( transactionIds[ i ][ 0 ] ) );
+        ( void ) StunTransactionTable_Insert( &( state.table ),
+                                              0,
+                                              &( transactionIds[ i ][ 0 ] ),
+                                              ( void * ) ( uintptr_t ) ( i + 1 ) );
+    }
+
+    Bench_Run( "transaction_table", "lookup_hit", LookupHit, &( state ) );
+    #if defined( __unix__ ) || defined( __APPLE__ )
+        ( void ) pthread_mutex_init( &( state.mutex ), NULL );
+        Bench_Run( "transaction_table", "lookup_hit_locked", LookupHitLocked, &( state ) );
+        ( void ) pthread_mutex_destroy( &( state.mutex ) );
+    #endif
+    Bench_Run( "transaction_table", "lookup_miss", LookupMiss, &( state ) );
+    Bench_Run( "transaction_table", "insert_remove", InsertRemove, &( state ) );
+
+    ChurnTransactions( &( state ) );
+    Bench_Run( "transaction_table", "lookup_miss_churned", LookupMiss, &( state ) );
+    #if defined( __unix__ ) || defined( __APPLE__ )
+        Bench_RunBatch( "transaction_table", "contended_4_threads", Contended, &( state ),
+                        BENCH_TRANSACTION_THREAD_COUNT * BENCH_TRANSACTION_THREAD_OPS );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,66 @@
+/* Standard includes. */
+#include <string.h>
+
+/* Harness includes. */
+#include "bench_harness.h"
+
+typedef struct BenchSuite
+{
+    const char * pName;
+    void ( * runFunction )( void );
+} BenchSuite_t;
+
+static const BenchSuite_t benchSuites[] =
+{
+    { "attribute_index",   BenchAttributeIndex_Run   },
+    { "classify",          BenchClassify_Run         },
+    { "batch",             BenchBatch_Run            },
+    { "endianness",        BenchEndianness_Run       },
+    { "crc32",             BenchCrc32_Run            },
+    { "hmac",              BenchHmac_Run             },
+    { "credential_cache",  BenchCredentialCache_Run  },
+    { "framer",            BenchFramer_Run           },
+    { "channel_data",      BenchChannelData_Run      },
+    { "parse_all",         BenchParseAll_Run         },
+    { "messages",          BenchMessages_Run         },
+    { "template",          BenchTemplate_Run         },
+    { "scatter_gather",    BenchScatterGather_Run    },
+    { "address",           BenchAddress_Run          },
+    #if defined( STUN_ENABLE_STATS )
+        { "stats",             BenchStats_Run            },
+    #endif
+    #if defined( STUN_BUILD_RANDOM )
+        { "random",            BenchRandom_Run           },
+    #endif
+    #if defined( STUN_BUILD_TRANSACTION_TABLE )
+        { "transaction_table", BenchTransactionTable_Run },
+    #endif
+    #if defined( STUN_BUILD_TIMER_WHEEL )
+        { "timer_wheel",       BenchTimerWheel_Run       },
+    #endif
+};
+
+/*-----------------------------------------------------------*/
+
+/* Usage: kvsstun_bench [suite-name-filter] */
+int main( int argc,
+          char * argv[] )
+{
+    size_t i;
+    const char * pFilter = ( argc > 1 ) ? argv[ 1 ] : NULL;
+
+    Bench_PrintHeader();
+
+    for( i = 0; i < sizeof( benchSuites ) / sizeof( benchSuites[ 0 ] ); i++ )
+    {
+        if( ( pFilter == NULL ) ||
+            ( strstr( benchSuites[ i ].pName, pFilter ) != NULL ) )
+        {
+            benchSuites[ i ].runFunction();
+        }
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,766 @@
+/* Reference UDP Binding server and load generator.
+ *
+ * Server mode answers Binding requests on every thread from its own
+ * SO_REUSEPORT socket, pinned to a CPU, receiving and sending in batches with
+ * recvmmsg and sendmmsg. Responses are written in place in the receive
+ * buffers, so nothing is allocated after startup.
+ *
+ * Client mode keeps a number of Binding requests in flight from every thread
+ * and measures their round trip. The send time is carried in the transaction
+ * ID, so responses are matched without any lookup. */
+
+#define _GNU_SOURCE
+
+/* Standard includes. */
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/* API includes. */
+#include "stun_deserializer.h"
+#include "stun_serializer.h"
+
+#define SERVER_DEFAULT_PORT          3478
+#define SERVER_DEFAULT_DURATION_S    10
+#define SERVER_DEFAULT_INFLIGHT      64
+
+#define SERVER_BATCH_SIZE            64
+#define SERVER_BUFFER_LENGTH         2048
+#define SERVER_SOCKET_BUFFER_SIZE    ( 4 * 1024 * 1024 )
+#define SERVER_RECEIVE_TIMEOUT_US    100000
+
+/* Latency histogram with 16 buckets per power of 2 of nanoseconds, which is
+ * within 1/16 of the actual value. */
+#define SERVER_LATENCY_SUB_BITS      4
+#define SERVER_LATENCY_BUCKETS       ( 64 << SERVER_LATENCY_SUB_BITS )
+
+#define NS_PER_SECOND                1000000000ULL
+
+typedef struct ServerConfig
+{
+    int clientMode;
+    struct sockaddr_storage address;
+    socklen_t addressLength;
+    uint32_t threadCount;
+    uint32_t firstCpu;
+    uint32_t durationSeconds; /* 0 to run until interrupted. */
+    uint32_t inflight;
+} ServerConfig_t;
+
+typedef struct ServerThread
+{
+    const ServerConfig_t * pConfig;
+    pthread_t thread;
+    uint32_t index;
+    uint32_t sequence;
+    int socketFd;
+
+    /* Read by the main thread while running. */
+    uint64_t messages;
+    uint64_t lost;
+
+    uint64_t latencies[ SERVER_LATENCY_BUCKETS ];
+
+    struct mmsghdr receiveMessages[ SERVER_BATCH_SIZE ];
+    struct mmsghdr sendMessages[ SERVER_BATCH_SIZE ];
+    struct iovec receiveVectors[ SERVER_BATCH_SIZE ];
+    struct iovec sendVectors[ SERVER_BATCH_SIZE ];
+    struct sockaddr_storage addresses[ SERVER_BATCH_SIZE ];
+    uint8_t buffers[ SERVER_BATCH_SIZE ][ SERVER_BUFFER_LENGTH ];
+    uint8_t requests[ SERVER_BATCH_SIZE ][ STUN_HEADER_LENGTH ];
+} ServerThread_t;
+
+static int serverStop;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t GetTimeNs( void );
+
+static void RecordLatency( ServerThread_t * pThread,
+                           uint64_t latencyNs,
+                           uint64_t count );
+
+static uint64_t GetLatencyPercentile( const uint64_t * pLatencies,
+                                      double percentile );
+
+static void OnSignal( int signalNumber );
+
+static void PinToCpu( uint32_t cpu );
+
+static int OpenSocket( ServerConfig_t * pConfig );
+
+static int ToStunAddress( const struct sockaddr_storage * pSocketAddress,
+                          StunAttributeAddress_t * pStunAddress );
+
+static uint32_t AnswerRequest( ServerThread_t * pThread,
+                               uint32_t messageIndex,
+                               size_t requestLength );
+
+static void * RunServer( void * pArg );
+
+static uint32_t SendRequests( ServerThread_t * pThread,
+                              uint32_t count );
+
+static void * RunClient( void * pArg );
+
+static int ParseOptions( int argc,
+                         char * argv[],
+                         ServerConfig_t * pConfig );
+
+static void Report( ServerThread_t * pThreads,
+                    const ServerConfig_t * pConfig );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t GetTimeNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( ( uint64_t ) now.tv_sec * NS_PER_SECOND ) + ( uint64_t ) now.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static void RecordLatency( ServerThread_t * pThread,
+                           uint64_t latencyNs,
+                           uint64_t count )
+{
+    uint32_t bucket = ( uint32_t ) latencyNs, exponent;
+
+    if( latencyNs >= ( 1U << SERVER_LATENCY_SUB_BITS ) )
+    {
+        exponent = 63U - ( uint32_t ) __builtin_clzll( latencyNs ) - SERVER_LATENCY_SUB_BITS;
+        bucket = ( ( exponent + 1 ) << SERVER_LATENCY_SUB_BITS ) +
+                 ( uint32_t ) ( ( latencyNs >> exponent ) & ( ( 1U << SERVER_LATENCY_SUB_BITS ) - 1 ) );
+    }
+
+    pThread->latencies[ bucket ] += count;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Returns the upper bound, in nanoseconds, of the bucket holding the
+ * percentile. */
+static uint64_t GetLatencyPercentile( const uint64_t * pLatencies,
+                                      double percentile )
+{
+    uint64_t total = 0, target, seen = 0, upperBound = 0;
+    uint32_t bucket, exponent;
+
+    for( bucket = 0; bucket < SERVER_LATENCY_BUCKETS; bucket++ )
+    {
+        total += pLatencies[ bucket ];
+    }
+
+    target = ( uint64_t ) ( ( double ) total * percentile );
+
+    for( bucket = 0; ( total != 0 ) && ( bucket < SERVER_LATENCY_BUCKETS ); bucket++ )
+    {
+        seen += pLatencies[ bucket ];
+
+        if( seen > target )
+        {
+            if( bucket < ( 1U << SERVER_LATENCY_SUB_BITS ) )
+            {
+                upperBound = bucket + 1;
+            }
+            else
+            {
+                exponent = ( bucket >> SERVER_LATENCY_SUB_BITS ) - 1;
+                upperBound = ( ( uint64_t ) ( ( 1U << SERVER_LATENCY_SUB_BITS ) +
+                                              ( bucket & ( ( 1U << SERVER_LATENCY_SUB_BITS ) - 1 ) ) + 1 ) ) << exponent;
+            }
+
+            break;
+        }
+    }
+
+    return upperBound;
+}
+
+/*-----------------------------------------------------------*/
+
+static void OnSignal( int signalNumber )
+{
+    ( void ) signalNumber;
+
+    __atomic_store_n( &( serverStop ), 1, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+static void PinToCpu( uint32_t cpu )
+{
+    cpu_set_t cpus;
+
+    CPU_ZERO( &( cpus ) );
+    CPU_SET( cpu % ( uint32_t ) sysconf( _SC_NPROCESSORS_ONLN ), &( cpus ) );
+
+    /* Best effort, for example in containers limited to some CPUs. */
+    ( void ) pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &( cpus ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Opens the socket of a thread: bound with SO_REUSEPORT on the server,
+ * connected on the client. On the server, port 0 is replaced with the port
+ * picked for the first socket. */
+static int OpenSocket( ServerConfig_t * pConfig )
+{
+    int socketFd, enable = 1, bufferSize = SERVER_SOCKET_BUFFER_SIZE, result = 0;
+    struct timeval timeout = { 0, SERVER_RECEIVE_TIMEOUT_US };
+
+    socketFd = socket( pConfig->address.ss_family, SOCK_DGRAM, 0 );
+
+    if( socketFd < 0 )
+    {
+        result = -1;
+    }
+    else
+    {
+        ( void ) setsockopt( socketFd, SOL_SOCKET, SO_RCVBUF, &( bufferSize ), sizeof( bufferSize ) );
+        ( void ) setsockopt( socketFd, SOL_SOCKET, SO_SNDBUF, &( bufferSize ), sizeof( bufferSize ) );
+
+        /* Lets the threads notice serverStop. */
+        result = setsockopt( socketFd, SOL_SOCKET, SO_RCVTIMEO, &( timeout ), sizeof( timeout ) );
+    }
+
+    if( ( result == 0 ) && ( pConfig->clientMode != 0 ) )
+    {
+        result = connect( socketFd, ( const struct sockaddr * ) &( pConfig->address ), pConfig->addressLength );
+    }
+
+    if( ( result == 0 ) && ( pConfig->clientMode == 0 ) )
+    {
+        result = setsockopt( socketFd, SOL_SOCKET, SO_REUSEPORT, &( enable ), sizeof( enable ) );
+
+        if( result == 0 )
+        {
+            result = bind( socketFd, ( const struct sockaddr * ) &( pConfig->address ), pConfig->addressLength );
+        }
+
+        if( result == 0 )
+        {
+            result = getsockname( socketFd, ( struct sockaddr * ) &( pConfig->address ), &( pConfig->addressLength ) );
+        }
+    }
+
+    if( ( result != 0 ) && ( socketFd >= 0 ) )
+    {
+        perror( "socket" );
+        ( void ) close( socketFd );
+        socketFd = -1;
+    }
+
+    return socketFd;
+}
+
+/*-----------------------------------------------------------*/
+
+static int ToStunAddress( const struct sockaddr_storage * pSocketAddress,
+                          StunAttributeAddress_t * pStunAddress )
+{
+    const struct sockaddr_in * pIpv4 = ( const struct sockaddr_in * ) pSocketAddress;
+    const struct sockaddr_in6 * pIpv6 = ( const struct sockaddr_in6 * ) pSocketAddress;
+    int result = 0;
+
+    if( pSocketAddress->ss_family == AF_INET )
+    {
+        pStunAddress->family = STUN_ADDRESS_IPv4;
+        pStunAddress->port = ntohs( pIpv4->sin_port );
+        memcpy( ( void * ) &( pStunAddress->address[ 0 ] ), ( const void * ) &( pIpv4->sin_addr ), STUN_IPV4_ADDRESS_SIZE );
+    }
+    else if( pSocketAddress->ss_family == AF_INET6 )
+    {
+        pStunAddress->family = STUN_ADDRESS_IPv6;
+        pStunAddress->port = ntohs( pIpv6->sin6_port );
+        memcpy( ( void * ) &( pStunAddress->address[ 0 ] ), ( const void * ) &( pIpv6->sin6_addr ), STUN_IPV6_ADDRESS_SIZE );
+    }
+    else
+    {
+        result = -1;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Turns the Binding request received in a buffer into its success response.
+ * Returns the length of the response, or 0 if there is nothing to send. */
+static uint32_t AnswerRequest( ServerThread_t * pThread,
+                               uint32_t messageIndex,
+                               size_t requestLength )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    StunAttributeAddress_t mappedAddress;
+    StunResult_t result;
+    uint32_t responseLength = 0;
+
+    result = StunDeserializer_Init( &( ctx ),
+                                    &( pThread->buffers[ messageIndex ][ 0 ] ),
+                                    requestLength,
+                                    &( header ) );
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( ( header.messageType != STUN_MESSAGE_TYPE_BINDING_REQUEST ) ||
+          ( ToStunAddress( &( pThread->addresses[ messageIndex ] ), &( mappedAddress ) ) != 0 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_InitResponseInPlace( &( ctx ),
+                                                     &( pThread->buffers[ messageIndex ][ 0 ] ),
+                                                     SERVER_BUFFER_LENGTH,
+                                                     STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddAttributeXorMappedAddress( &( ctx ), &( mappedAddress ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddFingerprint( &( ctx ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_Finalize( &( ctx ), &( responseLength ) );
+    }
+
+    return ( result == STUN_RESULT_OK ) ? responseLength : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void * RunServer( void * pArg )
+{
+    ServerThread_t * pThread = ( ServerThread_t * ) pArg;
+    struct mmsghdr * pSend;
+    uint64_t startNs;
+    uint32_t i, responseLength, responseCount;
+    int received, sent, offset;
+
+    PinToCpu( pThread->pConfig->firstCpu + pThread->index );
+
+    for( i = 0; i < SERVER_BATCH_SIZE; i++ )
+    {
+        pThread->receiveVectors[ i ].iov_base = &( pThread->buffers[ i ][ 0 ] );
+        pThread->receiveVectors[ i ].iov_len = SERVER_BUFFER_LENGTH;
+        pThread->receiveMessages[ i ].msg_hdr.msg_iov = &( pThread->receiveVectors[ i ] );
+        pThread->receiveMessages[ i ].msg_hdr.msg_iovlen = 1;
+        pThread->receiveMessages[ i ].msg_hdr.msg_name = &( pThread->addresses[ i ] );
+    }
+
+    while( __atomic_load_n( &( serverStop ), __ATOMIC_RELAXED ) == 0 )
+    {
+        for( i = 0; i < SERVER_BATCH_SIZE; i++ )
+        {
+            pThread->receiveMessages[ i ].msg_hdr.msg_namelen = sizeof( pThread->addresses[ i ] );
+        }
+
+        received = recvmmsg( pThread->socketFd, &( pThread->receiveMessages[ 0 ] ), SERVER_BATCH_SIZE, MSG_WAITFORONE, NULL );
+        startNs = GetTimeNs();
+        responseCount = 0;
+
+        for( i = 0; ( received > 0 ) && ( i < ( uint32_t ) received ); i++ )
+        {
+            responseLength = AnswerRequest( pThread, i, pThread->receiveMessages[ i ].msg_len );
+
+            if( responseLength != 0 )
+            {
+                pSend = &( pThread->sendMessages[ responseCount ] );
+                pThread->sendVectors[ responseCount ].iov_base = &( pThread->buffers[ i ][ 0 ] );
+                pThread->sendVectors[ responseCount ].iov_len = responseLength;
+                pSend->msg_hdr = pThread->receiveMessages[ i ].msg_hdr;
+                pSend->msg_hdr.msg_iov = &( pThread->sendVectors[ responseCount ] );
+                responseCount++;
+            }
+        }
+
+        for( offset = 0; offset < ( int ) responseCount; offset += sent )
+        {
+            sent = sendmmsg( pThread->socketFd, &( pThread->sendMessages[ offset ] ), responseCount - ( uint32_t ) offset, 0 );
+
+            if( sent <= 0 )
+            {
+                break;
+            }
+        }
+
+        if( responseCount != 0 )
+        {
+            /* Time from the batch being received to its responses being
+             * handed to the kernel. */
+            RecordLatency( pThread, GetTimeNs() - startNs, responseCount );
+            __atomic_fetch_add( &( pThread->messages ), responseCount, __ATOMIC_RELAXED );
+        }
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends count Binding requests, with the send time and a sequence number as
+ * transaction ID. Returns the number sent. */
+static uint32_t SendRequests( ServerThread_t * pThread,
+                              uint32_t count )
+{
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    uint64_t nowNs = GetTimeNs();
+    uint32_t i, length;
+    int sent;
+
+    memcpy( ( void * ) &( transactionId[ 0 ] ), ( const void * ) &( nowNs ), sizeof( nowNs ) );
+
+    header.messageType = STUN_MESSAGE_TYPE_BINDING_REQUEST;
+    header.pTransactionId = &( transactionId[ 0 ] );
+
+    for( i = 0; i < count; i++ )
+    {
+        length = 0;
+        pThread->sequence++;
+        memcpy( ( void * ) &( transactionId[ sizeof( nowNs ) ] ), ( const void * ) &( pThread->sequence ), sizeof( pThread->sequence ) );
+        ( void ) StunSerializer_Init( &( ctx ), &( pThread->requests[ i ][ 0 ] ), STUN_HEADER_LENGTH, &( header ) );
+        ( void ) StunSerializer_Finalize( &( ctx ), &( length ) );
+
+        pThread->sendVectors[ i ].iov_base = &( pThread->requests[ i ][ 0 ] );
+        pThread->sendVectors[ i ].iov_len = length;
+        memset( ( void * ) &( pThread->sendMessages[ i ] ), 0, sizeof( pThread->sendMessages[ i ] ) );
+        pThread->sendMessages[ i ].msg_hdr.msg_iov = &( pThread->sendVectors[ i ] );
+        pThread->sendMessages[ i ].msg_hdr.msg_iovlen = 1;
+    }
+
+    sent = sendmmsg( pThread->socketFd, &( pThread->sendMessages[ 0 ] ), count, 0 );
+
+    return ( sent > 0 ) ? ( uint32_t ) sent : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void * RunClient( void * pArg )
+{
+    ServerThread_t * pThread = ( ServerThread_t * ) pArg;
+    StunContext_t ctx;
+    StunHeader_t header;
+    uint64_t sentNs, nowNs;
+    uint32_t i, inflight = 0, count, responses;
+    int received;
+
+    PinToCpu( pThread->pConfig->firstCpu + pThread->index );
+
+    for( i = 0; i < SERVER_BATCH_SIZE; i++ )
+    {
+        pThread->receiveVectors[ i ].iov_base = &( pThread->buffers[ i ][ 0 ] );
+        pThread->receiveVectors[ i ].iov_len = SERVER_BUFFER_LENGTH;
+        pThread->receiveMessages[ i ].msg_hdr.msg_iov = &( pThread->receiveVectors[ i ] );
+        pThread->receiveMessages[ i ].msg_hdr.msg_iovlen = 1;
+    }
+
+    while( __atomic_load_n( &( serverStop ), __ATOMIC_RELAXED ) == 0 )
+    {
+        /* Keep the window full, a batch at a time. */
+        for( count = 1; ( count != 0 ) && ( inflight < pThread->pConfig->inflight ); )
+        {
+            count = pThread->pConfig->inflight - inflight;
+            count = ( count < SERVER_BATCH_SIZE ) ? count : SERVER_BATCH_SIZE;
+            count = SendRequests( pThread, count );
+            inflight += count;
+        }
+
+        received = recvmmsg( pThread->socketFd, &( pThread->receiveMessages[ 0 ] ), SERVER_BATCH_SIZE, MSG_WAITFORONE, NULL );
+        nowNs = GetTimeNs();
+        responses = 0;
+
+        if( received <= 0 )
+        {
+            /* Nothing for a whole receive timeout: what is in flight was
+             * lost. */
+            __atomic_fetch_add( &( pThread->lost ), inflight, __ATOMIC_RELAXED );
+            inflight = 0;
+        }
+
+        for( i = 0; ( received > 0 ) && ( i < ( uint32_t ) received ); i++ )
+        {
+            if( ( StunDeserializer_Init( &( ctx ),
+                                         &( pThread->buffers[ i ][ 0 ] ),
+                                         pThread->receiveMessages[ i ].msg_len,
+                                         &( header ) ) == STUN_RESULT_OK ) &&
+                ( header.messageType == STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE ) )
+            {
+                memcpy( ( void * ) &( sentNs ), ( const void * ) header.pTransactionId, sizeof( sentNs ) );
+                RecordLatency( pThread, nowNs - sentNs, 1 );
+                responses++;
+            }
+        }
+
+        /* Responses arriving after their request was counted as lost do not
+         * reduce the window further. */
+        inflight -= ( responses < inflight ) ? responses : inflight;
+        __atomic_fetch_add( &( pThread->messages ), responses, __ATOMIC_RELAXED );
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+static int ParseOptions( int argc,
+                         char * argv[],
+                         ServerConfig_t * pConfig )
+{
+    struct sockaddr_in * pIpv4 = ( struct sockaddr_in * ) &( pConfig->address );
+    struct sockaddr_in6 * pIpv6 = ( struct sockaddr_in6 * ) &( pConfig->address );
+    const char * pHost = "0.0.0.0";
+    uint16_t port = SERVER_DEFAULT_PORT;
+    int option, result = 0;
+
+    memset( ( void * ) pConfig, 0, sizeof( *pConfig ) );
+    pConfig->threadCount = ( uint32_t ) sysconf( _SC_NPROCESSORS_ONLN );
+    pConfig->inflight = SERVER_DEFAULT_INFLIGHT;
+
+    while( ( result == 0 ) && ( ( option = getopt( argc, argv, "b:c:p:t:o:d:n:" ) ) != -1 ) )
+    {
+        switch( option )
+        {
+            case 'b':
+                pHost = optarg;
+                break;
+
+            case 'c':
+                pHost = optarg;
+                pConfig->clientMode = 1;
+                break;
+
+            case 'p':
+                port = ( uint16_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 't':
+                pConfig->threadCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 'o':
+                pConfig->firstCpu = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 'd':
+                pConfig->durationSeconds = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 'n':
+                pConfig->inflight = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            default:
+                result = -1;
+                break;
+        }
+    }
+
+    if( ( pConfig->clientMode != 0 ) && ( pConfig->durationSeconds == 0 ) )
+    {
+        pConfig->durationSeconds = SERVER_DEFAULT_DURATION_S;
+    }
+
+    if( inet_pton( AF_INET, pHost, &( pIpv4->sin_addr ) ) == 1 )
+    {
+        pIpv4->sin_family = AF_INET;
+        pIpv4->sin_port = htons( port );
+        pConfig->addressLength = sizeof( *pIpv4 );
+    }
+    else if( inet_pton( AF_INET6, pHost, &( pIpv6->sin6_addr ) ) == 1 )
+    {
+        pIpv6->sin6_family = AF_INET6;
+        pIpv6->sin6_port = htons( port );
+        pConfig->addressLength = sizeof( *pIpv6 );
+    }
+    else
+    {
+        result = -1;
+    }
+
+    if( ( result != 0 ) ||
+        ( pConfig->threadCount == 0 ) ||
+        ( pConfig->inflight == 0 ) )
+    {
+        fprintf( stderr,
+                 "Usage: %s [-b address] [-p port] [-t threads] [-o first_cpu] [-d seconds]\n"
+                 "       %s -c address [-p port] [-t threads] [-o first_cpu] [-d seconds] [-n inflight]\n",
+                 argv[ 0 ],
+                 argv[ 0 ] );
+        result = -1;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Prints the rate every second until stopped, then the totals. */
+static void Report( ServerThread_t * pThreads,
+                    const ServerConfig_t * pConfig )
+{
+    static uint64_t latencies[ SERVER_LATENCY_BUCKETS ];
+    uint64_t startNs = GetTimeNs(), lastNs = startNs, nowNs, total = 0, lastTotal = 0, lost = 0;
+    uint32_t i, bucket, seconds = 0;
+
+    while( __atomic_load_n( &( serverStop ), __ATOMIC_RELAXED ) == 0 )
+    {
+        ( void ) sleep( 1 );
+        seconds++;
+
+        nowNs = GetTimeNs();
+        total = 0;
+
+        for( i = 0; i < pConfig->threadCount; i++ )
+        {
+            total += __atomic_load_n( &( pThreads[ i ].messages ), __ATOMIC_RELAXED );
+        }
+
+        printf( "%u s: %.0f %s/s\n",
+                seconds,
+                ( double ) ( total - lastTotal ) * NS_PER_SECOND / ( double ) ( nowNs - lastNs ),
+                ( pConfig->clientMode != 0 ) ? "responses" : "requests" );
+        fflush( stdout );
+
+        lastTotal = total;
+        lastNs = nowNs;
+
+        if( ( pConfig->durationSeconds != 0 ) && ( seconds >= pConfig->durationSeconds ) )
+        {
+            __atomic_store_n( &( serverStop ), 1, __ATOMIC_RELAXED );
+        }
+    }
+
+    for( i = 0; i < pConfig->threadCount; i++ )
+    {
+        ( void ) pthread_join( pThreads[ i ].thread, NULL );
+
+        lost += pThreads[ i ].lost;
+
+        for( bucket = 0; bucket < SERVER_LATENCY_BUCKETS; bucket++ )
+        {
+            latencies[ bucket ] += pThreads[ i ].latencies[ bucket ];
+        }
+    }
+
+    printf( "total: %llu %s in %.1f s, %.0f/s, p50 %.1f us, p99 %.1f us",
+            ( unsigned long long ) total,
+            ( pConfig->clientMode != 0 ) ? "responses" : "requests",
+            ( double ) ( lastNs - startNs ) / NS_PER_SECOND,
+            ( double ) total * NS_PER_SECOND / ( double ) ( lastNs - startNs ),
+            ( double ) GetLatencyPercentile( &( latencies[ 0 ] ), 0.50 ) / 1000.0,
+            ( double ) GetLatencyPercentile( &( latencies[ 0 ] ), 0.99 ) / 1000.0 );
+
+    if( pConfig->clientMode != 0 )
+    {
+        printf( ", %llu lost\n", ( unsigned long long ) lost );
+    }
+    else
+    {
+        printf( " (batch service time)\n" );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Usage: see ParseOptions. */
+int main( int argc,
+          char * argv[] )
+{
+    ServerConfig_t config;
+    ServerThread_t * pThreads = NULL;
+    char host[ INET6_ADDRSTRLEN ];
+    uint32_t i, opened = 0, started = 0;
+    int result;
+
+    result = ParseOptions( argc, argv, &( config ) );
+
+    if( result == 0 )
+    {
+        pThreads = ( ServerThread_t * ) calloc( config.threadCount, sizeof( ServerThread_t ) );
+        result = ( pThreads != NULL ) ? 0 : -1;
+    }
+
+    for( i = 0; ( result == 0 ) && ( i < config.threadCount ); i++ )
+    {
+        pThreads[ i ].pConfig = &( config );
+        pThreads[ i ].index = i;
+        pThreads[ i ].socketFd = OpenSocket( &( config ) );
+        result = ( pThreads[ i ].socketFd >= 0 ) ? 0 : -1;
+        opened += ( result == 0 ) ? 1 : 0;
+    }
+
+    if( result == 0 )
+    {
+        ( void ) signal( SIGINT, OnSignal );
+        ( void ) signal( SIGTERM, OnSignal );
+
+        ( void ) inet_ntop( config.address.ss_family,
+                            ( config.address.ss_family == AF_INET ) ?
+                            ( const void * ) &( ( ( struct sockaddr_in * ) &( config.address ) )->sin_addr ) :
+                            ( const void * ) &( ( ( struct sockaddr_in6 * ) &( config.address ) )->sin6_addr ),
+                            host,
+                            sizeof( host ) );
+        printf( "%s %s port %u with %u threads\n",
+                ( config.clientMode != 0 ) ? "sending to" : "listening on",
+                host,
+                ntohs( ( ( struct sockaddr_in * ) &( config.address ) )->sin_port ),
+                config.threadCount );
+        fflush( stdout );
+    }
+
+    for( i = 0; ( result == 0 ) && ( i < config.threadCount ); i++ )
+    {
+        result = pthread_create( &( pThreads[ i ].thread ),
+                                 NULL,
+                                 ( config.clientMode != 0 ) ? RunClient : RunServer,
+                                 &( pThreads[ i ] ) );
+        started += ( result == 0 ) ? 1 : 0;
+    }
+
+    if( result == 0 )
+    {
+        Report( pThreads, &( config ) );
+    }
+    else
+    {
+        __atomic_store_n( &( serverStop ), 1, __ATOMIC_RELAXED );
+
+        for( i = 0; i < started; i++ )
+        {
+            ( void ) pthread_join( pThreads[ i ].thread, NULL );
+        }
+    }
+
+    for( i = 0; i < opened; i++ )
+    {
+        ( void ) close( pThreads[ i ].socketFd );
+    }
+
+    free( pThreads );
+
+    return ( result == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,60 @@
+#ifndef STUN_ADDRESS_H
+#define STUN_ADDRESS_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+
+/*
+ * Address attribute codec.
+ *
+ * Encodes and decodes the values of the address attributes (MAPPED-ADDRESS,
+ * XOR-MAPPED-ADDRESS and the like) without changing the input. For the
+ * XOR-*-ADDRESS attributes, the port is XOR'ed with the top 16 bits of the
+ * magic cookie and the address with the magic cookie followed by the
+ * transaction ID. These are the 16 bytes of the header from the magic cookie
+ * on, so the codec takes the message the attribute is in and XORs an IPv6
+ * address with them in one 128-bit operation (SSE2 or NEON when the compiler
+ * targets them).
+ */
+
+/* Length of the value of an address attribute of the given family. */
+#define STUN_ADDRESS_VALUE_LENGTH( family )  \
+    ( STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH + \
+      ( ( ( family ) == STUN_ADDRESS_IPv6 ) ? STUN_IPV6_ADDRESS_SIZE : STUN_IPV4_ADDRESS_SIZE ) )
+
+#define STUN_ATTRIBUTE_IS_XOR_ADDRESS( attributeType )                   \
+    ( ( ( attributeType ) == STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) ||  \
+      ( ( attributeType ) == STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) || \
+      ( ( attributeType ) == STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) )
+
+/* Writes the value of an address attribute of pMessage at pValue, which must
+ * have room for STUN_ADDRESS_VALUE_LENGTH( pAddress->family ) bytes. Only the
+ * magic cookie and transaction ID of pMessage are read, and only if
+ * isXorAddress is not 0. */
+StunResult_t StunAddress_Encode( const uint8_t * pMessage,
+                                 const StunAttributeAddress_t * pAddress,
+                                 uint8_t isXorAddress,
+                                 uint8_t * pValue );
+
+/* Reads the value of an address attribute of pMessage. */
+StunResult_t StunAddress_Decode( const uint8_t * pMessage,
+                                 const uint8_t * pValue,
+                                 uint16_t valueLength,
+                                 uint8_t isXorAddress,
+                                 StunAttributeAddress_t * pAddress );
+
+/* Encodes pAddresses[ i ] into ppMessages[ i ] at valueOffset, for a burst of
+ * responses that all have the attribute at the same place (for example, the
+ * first attribute after StunSerializer_InitResponseInPlace or a slot of a
+ * template). Nothing is written if any address is invalid. */
+StunResult_t StunAddress_EncodeBatch( uint8_t * const * ppMessages,
+                                      const StunAttributeAddress_t * pAddresses,
+                                      size_t count,
+                                      size_t valueOffset,
+                                      uint8_t isXorAddress );
+
+#endif /* STUN_ADDRESS_H */
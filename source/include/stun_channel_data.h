@@ -0,0 +1,41 @@
+#ifndef STUN_CHANNEL_DATA_H
+#define STUN_CHANNEL_DATA_H
+
+#include "stun_data_types.h"
+
+/* ChannelData messages are padded to a multiple of 4 bytes over TCP and TLS.
+ * Over UDP, the padding is optional. */
+typedef enum StunTransport
+{
+    STUN_TRANSPORT_UDP,
+    STUN_TRANSPORT_TCP
+} StunTransport_t;
+
+typedef struct StunChannelData
+{
+    uint16_t channelNumber;
+    const uint8_t * pData;
+    uint16_t dataLength;
+} StunChannelData_t;
+
+/* Writes a ChannelData header in front of dataLength bytes of application data
+ * already at &( pBuffer[ STUN_CHANNEL_DATA_VALUE_OFFSET ] ), and the padding
+ * after it for STUN_TRANSPORT_TCP. pMessageLength is the number of bytes to
+ * send. */
+StunResult_t StunChannelData_Serialize( uint8_t * pBuffer,
+                                        size_t bufferLength,
+                                        uint16_t channelNumber,
+                                        uint16_t dataLength,
+                                        StunTransport_t transport,
+                                        size_t * pMessageLength );
+
+/* Validates a ChannelData message, including its padding for the given
+ * transport, and gets its channel number and application data. Use
+ * STUN_FIRST_BYTE_IS_CHANNEL_DATA on the first byte of a received message to
+ * pick between this and StunDeserializer_Init. */
+StunResult_t StunChannelData_Deserialize( const uint8_t * pMessage,
+                                          size_t messageLength,
+                                          StunTransport_t transport,
+                                          StunChannelData_t * pChannelData );
+
+#endif /* STUN_CHANNEL_DATA_H */
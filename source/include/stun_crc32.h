@@ -0,0 +1,19 @@
+#ifndef STUN_CRC32_H
+#define STUN_CRC32_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* The FINGERPRINT attribute value is the CRC-32 of the message XOR'ed with
+ * this value. */
+#define STUN_FINGERPRINT_XOR_VALUE    0x5354554E
+
+/* Returns the CRC-32 (ISO-HDLC, as used by the FINGERPRINT attribute) of
+ * pBuffer, continuing from crc. Pass 0 for the first buffer and the
+ * previous return value to continue over more buffers. */
+uint32_t Stun_Crc32( uint32_t crc,
+                     const uint8_t * pBuffer,
+                     size_t bufferLength );
+
+#endif /* STUN_CRC32_H */
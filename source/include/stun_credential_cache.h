@@ -0,0 +1,94 @@
+#ifndef STUN_CREDENTIAL_CACHE_H
+#define STUN_CREDENTIAL_CACHE_H
+
+#include "stun_data_types.h"
+#include "stun_hmac_sha1.h"
+
+#define STUN_LONG_TERM_KEY_LENGTH    16
+
+/* Longest username plus realm that can be cached. Credentials longer than
+ * this are rejected by StunCredentialCache_Insert and have to be derived by
+ * the caller for every message. */
+#ifndef STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH
+    #define STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH    128
+#endif
+
+/* Number of consecutive entries looked at for a given username and realm. */
+#ifndef STUN_CREDENTIAL_CACHE_PROBE_LENGTH
+    #define STUN_CREDENTIAL_CACHE_PROBE_LENGTH    4
+#endif
+
+/* Entries are aligned to and padded to a multiple of the cache line size, so
+ * that a writer locking an entry does not slow down readers of its
+ * neighbours. The fields compared on every lookup come first. */
+typedef struct STUN_CACHE_LINE_ALIGNED StunCredentialCacheEntry
+{
+    /* Sequence lock. Odd while a writer is updating the entry. Readers never
+     * write to the entry. */
+    uint32_t sequence;
+    uint32_t hash;
+    uint16_t usernameLength;
+    uint16_t realmLength;
+    uint8_t identity[ STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH ];
+    uint8_t longTermKey[ STUN_LONG_TERM_KEY_LENGTH ];
+    StunHmacKey_t hmacKey;
+} StunCredentialCacheEntry_t;
+
+typedef struct StunCredentialCache
+{
+    StunCredentialCacheEntry_t * pEntries;
+    size_t entryMask;
+} StunCredentialCache_t;
+
+/* Computes the long-term credential key MD5( username ":" realm ":" password ).
+ * The strings must already be processed with SASLprep/OpaqueString where
+ * RFC 8489 requires it. */
+StunResult_t StunCredential_ComputeLongTermKey( const uint8_t * pUsername,
+                                                uint16_t usernameLength,
+                                                const uint8_t * pRealm,
+                                                uint16_t realmLength,
+                                                const uint8_t * pPassword,
+                                                uint16_t passwordLength,
+                                                uint8_t * pLongTermKey );
+
+/* Initializes a cache over caller provided entries. entryCount must be a
+ * power of 2. Entries allocated on the heap should be allocated with
+ * STUN_CACHE_LINE_SIZE alignment, for example with aligned_alloc. The cache
+ * can then be shared by any number of threads: lookups do not take any lock
+ * and inserts only lock the entries probed for their credential. */
+StunResult_t StunCredentialCache_Init( StunCredentialCache_t * pCache,
+                                       StunCredentialCacheEntry_t * pEntries,
+                                       size_t entryCount );
+
+/* Derives the long-term key and the HMAC key for the credential and stores
+ * them in the entry that already holds the credential, else in the first
+ * empty probed entry. If neither is found, the probed entry picked by the
+ * hash of the username and realm is replaced, whatever its age, so the same
+ * credential always evicts the same entry. */
+StunResult_t StunCredentialCache_Insert( StunCredentialCache_t * pCache,
+                                         const uint8_t * pUsername,
+                                         uint16_t usernameLength,
+                                         const uint8_t * pRealm,
+                                         uint16_t realmLength,
+                                         const uint8_t * pPassword,
+                                         uint16_t passwordLength );
+
+/* Copies the long-term key and/or the HMAC key of a cached credential. Either
+ * output can be NULL. Returns STUN_RESULT_CREDENTIAL_NOT_FOUND if the
+ * credential is not in the cache. */
+StunResult_t StunCredentialCache_Lookup( const StunCredentialCache_t * pCache,
+                                         const uint8_t * pUsername,
+                                         uint16_t usernameLength,
+                                         const uint8_t * pRealm,
+                                         uint16_t realmLength,
+                                         uint8_t * pLongTermKey,
+                                         StunHmacKey_t * pHmacKey );
+
+/* Removes a credential, for example after its password changed. */
+StunResult_t StunCredentialCache_Invalidate( StunCredentialCache_t * pCache,
+                                             const uint8_t * pUsername,
+                                             uint16_t usernameLength,
+                                             const uint8_t * pRealm,
+                                             uint16_t realmLength );
+
+#endif /* STUN_CREDENTIAL_CACHE_H */
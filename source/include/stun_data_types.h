@@ -34,6 +34,53 @@
 /* Cookie value in the header. */
 #define STUN_HEADER_MAGIC_COOKIE        0x2112A442
 
+/* Class bits of the message type. */
+#define STUN_MESSAGE_CLASS_MASK                 0x0110
+#define STUN_MESSAGE_CLASS_REQUEST              0x0000
+#define STUN_MESSAGE_CLASS_INDICATION           0x0010
+#define STUN_MESSAGE_CLASS_SUCCESS_RESPONSE     0x0100
+#define STUN_MESSAGE_CLASS_ERROR_RESPONSE       0x0110
+#define STUN_MESSAGE_TYPE_TO_SUCCESS_RESPONSE( messageType ) \
+    ( ( uint16_t ) ( ( ( messageType ) & ~STUN_MESSAGE_CLASS_MASK ) | STUN_MESSAGE_CLASS_SUCCESS_RESPONSE ) )
+#define STUN_MESSAGE_TYPE_TO_ERROR_RESPONSE( messageType ) \
+    ( ( uint16_t ) ( ( ( messageType ) & ~STUN_MESSAGE_CLASS_MASK ) | STUN_MESSAGE_CLASS_ERROR_RESPONSE ) )
+
+/*
+ * TURN ChannelData Message:
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |         Channel Number        |            Length             |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                                                               |
+ * /                       Application Data                        /
+ * /                                                               /
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+
+/* Length and offsets of various members in the ChannelData header. */
+#define STUN_CHANNEL_DATA_HEADER_LENGTH             4
+#define STUN_CHANNEL_DATA_CHANNEL_NUMBER_OFFSET     0
+#define STUN_CHANNEL_DATA_LENGTH_OFFSET             2
+#define STUN_CHANNEL_DATA_VALUE_OFFSET              4
+
+/* Channel numbers that can be used for ChannelData messages (RFC 8656,
+ * section 12). 0x5000-0x7FFF are reserved. */
+#define STUN_CHANNEL_NUMBER_MIN                     0x4000
+#define STUN_CHANNEL_NUMBER_MAX                     0x4FFF
+
+/* The first two bits of a STUN message are 0b00. A ChannelData message starts
+ * with its channel number, so its first byte is 64-79, which is also the
+ * TURN Channel range of RFC 7983. */
+#define STUN_FIRST_BYTE_IS_STUN( byte )             ( ( ( byte ) & 0xC0 ) == 0x00 )
+#define STUN_FIRST_BYTE_IS_CHANNEL_DATA( byte )     ( ( ( byte ) & 0xF0 ) == 0x40 )
+
+/* On a socket shared with DTLS, ZRTP and RTP, RFC 7983 only gives STUN the
+ * first bytes 0-3, since all the methods in use fit in 7 bits. Used by
+ * StunDeserializer_ClassifyBatch and the StunDemux APIs. */
+#define STUN_FIRST_BYTE_IS_DEMUXED_STUN( byte )     ( ( byte ) <= 3U )
+
 /*
  * STUN Attribute:
  *
@@ -115,6 +162,113 @@
 #define STUN_FLAG_FINGERPRINT_ATTRIBUTE             ( 1 << 0 )
 #define STUN_FLAG_INTEGRITY_ATTRIBUTE               ( 1 << 1 )
 
+/*
+ * Attribute slots:
+ *
+ * Every attribute type in the ranges 0x0000-0x003F and 0x8000-0x803F gets its
+ * own slot - the former map to 0-63 and the latter to 64-127. All the other
+ * types share the last slot. This covers all the attribute types in
+ * StunAttributeType_t with no collisions.
+ */
+#define STUN_ATTRIBUTE_SLOT_OTHER                   128
+#define STUN_ATTRIBUTE_SLOT_COUNT                   129
+#define STUN_ATTRIBUTE_TYPE_TO_SLOT( type )                     \
+    ( ( ( ( type ) & 0x7FC0 ) == 0 ) ?                          \
+      ( ( ( ( type ) >> 9 ) & 0x40 ) | ( ( type ) & 0x3F ) ) :  \
+      STUN_ATTRIBUTE_SLOT_OTHER )
+
+/* Bitmap with one bit per attribute slot. */
+#define STUN_ATTRIBUTE_SLOT_WORDS                   ( ( STUN_ATTRIBUTE_SLOT_COUNT + 63 ) / 64 )
+#define STUN_ATTRIBUTE_SLOT_IS_SET( pBitmap, slot ) \
+    ( ( ( pBitmap )[ ( slot ) >> 6 ] & ( ( uint64_t ) 1 << ( ( slot ) & 63 ) ) ) != 0 )
+#define STUN_ATTRIBUTE_SLOT_SET( pBitmap, slot ) \
+    ( ( pBitmap )[ ( slot ) >> 6 ] |= ( ( uint64_t ) 1 << ( ( slot ) & 63 ) ) )
+
+/* Attribute types 0x0000-0x7FFF are comprehension-required - a request with
+ * one that is not understood must be rejected with a 420 error response. */
+#define STUN_ATTRIBUTE_IS_COMPREHENSION_REQUIRED( type )    ( ( ( type ) & 0x8000 ) == 0 )
+#define STUN_ATTRIBUTE_TYPE_BIT( type )                     ( ( uint64_t ) 1 << ( type ) )
+
+/* The comprehension-required attribute types in StunAttributeType_t, one bit
+ * per type. All of them are below 0x0040. */
+#define STUN_ATTRIBUTE_KNOWN_TYPES_DEFAULT                              \
+    ( STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS ) |      \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS ) |    \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST ) |      \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS ) |      \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS ) |     \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_USERNAME ) |            \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_PASSWORD ) |            \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY ) |   \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_ERROR_CODE ) |          \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_UNKNOWN_ATTRIBUTES ) |  \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_REFLECTED_FROM ) |      \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_CHANNEL_NUMBER ) |      \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_LIFETIME ) |            \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) |    \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_DATA ) |                \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_REALM ) |               \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_NONCE ) |               \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) | \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_EVEN_PORT ) |           \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_REQUESTED_TRANSPORT ) | \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_DONT_FRAGMENT ) |       \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) |  \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_RESERVATION_TOKEN ) |   \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_PRIORITY ) |            \
+      STUN_ATTRIBUTE_TYPE_BIT( STUN_ATTRIBUTE_TYPE_USE_CANDIDATE ) )
+
+/* Maximum number of unknown attribute types collected from a message. */
+#ifndef STUN_UNKNOWN_ATTRIBUTES_MAX_COUNT
+    #define STUN_UNKNOWN_ATTRIBUTES_MAX_COUNT       8
+#endif
+
+#define STUN_ERROR_CODE_UNKNOWN_ATTRIBUTE           420
+
+/* Maximum number of attributes an attribute index can hold. */
+#ifndef STUN_ATTRIBUTE_INDEX_MAX_ENTRIES
+    #define STUN_ATTRIBUTE_INDEX_MAX_ENTRIES        32
+#endif
+
+#if ( STUN_ATTRIBUTE_INDEX_MAX_ENTRIES > 255 )
+    #error "STUN_ATTRIBUTE_INDEX_MAX_ENTRIES must not be greater than 255."
+#endif
+
+/* In scatter-gather mode, attribute values of at least this many bytes are
+ * referenced in place instead of copied. */
+#ifndef STUN_SCATTER_GATHER_MIN_REFERENCE_LENGTH
+    #define STUN_SCATTER_GATHER_MIN_REFERENCE_LENGTH    64
+#endif
+
+/* Attributes present in a StunDecodedMessage_t. */
+#define STUN_DECODED_FLAG_PRIORITY                  ( 1 << 0 )
+#define STUN_DECODED_FLAG_ICE_CONTROLLING           ( 1 << 1 )
+#define STUN_DECODED_FLAG_ICE_CONTROLLED            ( 1 << 2 )
+#define STUN_DECODED_FLAG_USE_CANDIDATE             ( 1 << 3 )
+#define STUN_DECODED_FLAG_USERNAME                  ( 1 << 4 )
+#define STUN_DECODED_FLAG_XOR_MAPPED_ADDRESS        ( 1 << 5 )
+#define STUN_DECODED_FLAG_XOR_PEER_ADDRESS          ( 1 << 6 )
+#define STUN_DECODED_FLAG_XOR_RELAYED_ADDRESS       ( 1 << 7 )
+#define STUN_DECODED_FLAG_LIFETIME                  ( 1 << 8 )
+#define STUN_DECODED_FLAG_ERROR_CODE                ( 1 << 9 )
+#define STUN_DECODED_FLAG_NONCE                     ( 1 << 10 )
+#define STUN_DECODED_FLAG_REALM                     ( 1 << 11 )
+#define STUN_DECODED_FLAG_MESSAGE_INTEGRITY         ( 1 << 12 )
+#define STUN_DECODED_FLAG_FINGERPRINT               ( 1 << 13 )
+
+/* Cache line size assumed for the alignment of hot structures. */
+#ifndef STUN_CACHE_LINE_SIZE
+    #define STUN_CACHE_LINE_SIZE                    64
+#endif
+
+#if defined( __GNUC__ )
+    #define STUN_CACHE_LINE_ALIGNED    __attribute__( ( aligned( STUN_CACHE_LINE_SIZE ) ) )
+#elif defined( _MSC_VER )
+    #define STUN_CACHE_LINE_ALIGNED    __declspec( align( STUN_CACHE_LINE_SIZE ) )
+#else
+    #define STUN_CACHE_LINE_ALIGNED
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Return value from APIs. */
@@ -129,7 +283,16 @@ typedef enum StunResult
     STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND,
     STUN_RESULT_INVALID_ATTRIBUTE_LENGTH,
     STUN_RESULT_INVALID_ATTRIBUTE_ORDER,
-    STUN_RESULT_NO_ATTRIBUTE_FOUND
+    STUN_RESULT_NO_ATTRIBUTE_FOUND,
+    STUN_RESULT_FINGERPRINT_MISMATCH,
+    STUN_RESULT_INTEGRITY_MISMATCH,
+    STUN_RESULT_CREDENTIAL_NOT_FOUND,
+    STUN_RESULT_NO_MORE_FRAME_FOUND,
+    STUN_RESULT_INVALID_FRAME,
+    STUN_RESULT_INVALID_CHANNEL_DATA,
+    STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED,
+    STUN_RESULT_ENTROPY_SOURCE_FAILED,
+    STUN_RESULT_TRANSACTION_NOT_FOUND
 } StunResult_t;
 
 /* STUN message types. */
@@ -138,7 +301,17 @@ typedef enum StunMessageType
     STUN_MESSAGE_TYPE_BINDING_REQUEST           = 0x0001,
     STUN_MESSAGE_TYPE_BINDING_SUCCESS_RESPONSE  = 0x0101,
     STUN_MESSAGE_TYPE_BINDING_FAILURE_RESPONSE  = 0x0111,
-    STUN_MESSAGE_TYPE_BINDING_INDICATION        = 0x0011
+    STUN_MESSAGE_TYPE_BINDING_INDICATION        = 0x0011,
+
+    /* TURN (RFC 8656). */
+    STUN_MESSAGE_TYPE_ALLOCATE_REQUEST          = 0x0003,
+    STUN_MESSAGE_TYPE_ALLOCATE_SUCCESS_RESPONSE = 0x0103,
+    STUN_MESSAGE_TYPE_ALLOCATE_FAILURE_RESPONSE = 0x0113,
+    STUN_MESSAGE_TYPE_REFRESH_REQUEST           = 0x0004,
+    STUN_MESSAGE_TYPE_CREATE_PERMISSION_REQUEST = 0x0008,
+    STUN_MESSAGE_TYPE_CHANNEL_BIND_REQUEST      = 0x0009,
+    STUN_MESSAGE_TYPE_SEND_INDICATION           = 0x0016,
+    STUN_MESSAGE_TYPE_DATA_INDICATION           = 0x0017
 } StunMessageType_t;
 
 /* STUN attribute types. */
@@ -176,15 +349,117 @@ typedef enum StunAttributeType
 
 /*-----------------------------------------------------------*/
 
+typedef struct StunAttributeIndexEntry
+{
+    uint16_t attributeType;
+    uint16_t attributeValueLength;
+    uint32_t attributeValueOffset;
+    uint8_t nextEntry; /* 1-based index of the next entry in the same slot, 0 if none. */
+} StunAttributeIndexEntry_t;
+
+/* Offsets of all the attributes in a message, grouped by attribute slot. Built
+ * once using StunDeserializer_BuildAttributeIndex. firstEntry, lastEntry and
+ * entryCount of a slot are only valid when its bit is set in usedSlots, so
+ * that building an index does not clear them. */
+typedef struct StunAttributeIndex
+{
+    uint64_t usedSlots[ STUN_ATTRIBUTE_SLOT_WORDS ];
+    uint8_t firstEntry[ STUN_ATTRIBUTE_SLOT_COUNT ]; /* 1-based. */
+    uint8_t lastEntry[ STUN_ATTRIBUTE_SLOT_COUNT ];  /* 1-based. */
+    uint8_t entryCount[ STUN_ATTRIBUTE_SLOT_COUNT ];
+    uint8_t totalEntries;
+    StunAttributeIndexEntry_t entries[ STUN_ATTRIBUTE_INDEX_MAX_ENTRIES ];
+} StunAttributeIndex_t;
+
+/* Unknown comprehension-required attribute types found while walking a
+ * message, collected by StunDeserializer_GetNextAttribute once set up with
+ * StunDeserializer_TrackUnknownAttributes. Types below 0x0040 are understood if
+ * their bit is set in knownTypes, and all the types from 0x0040 to 0x7FFF are
+ * unknown. Each type is listed once. Types found after the list is full are
+ * dropped, but count is then non zero anyway. */
+typedef struct StunUnknownAttributes
+{
+    uint64_t knownTypes;
+    uint16_t attributeTypes[ STUN_UNKNOWN_ATTRIBUTES_MAX_COUNT ];
+    uint16_t count;
+} StunUnknownAttributes_t;
+
+/* One part of a message serialized in scatter-gather mode. It has the same
+ * layout as struct iovec on POSIX systems, so that the parts can be passed to
+ * sendmsg or sendmmsg as msg_iov. */
+typedef struct StunIovec
+{
+    const void * pBase;
+    size_t length;
+} StunIovec_t;
+
+/* State of the scatter-gather mode, set up with
+ * StunSerializer_UseScatterGather. The message is made of the bytes written to
+ * the context buffer (header, attribute headers, padding and short values)
+ * with the long attribute values referenced in place between them. */
+typedef struct StunScatterGather
+{
+    StunIovec_t * pIovecs;
+    size_t maxIovecs;
+    size_t iovecCount;
+    size_t referencedLength; /* Bytes of the message outside the context buffer. */
+    size_t segmentStart;     /* Start of the bytes in the context buffer not in pIovecs yet. */
+} StunScatterGather_t;
+
+/* Attribute added with StunSerializer_ReserveAttribute, whose value is
+ * written later with one of the StunSerializer_FillReserved APIs. */
+typedef struct StunReservedAttribute
+{
+    StunAttributeType_t attributeType;
+    uint16_t valueLength;
+    size_t valueOffset;
+    uint8_t isFilled;
+} StunReservedAttribute_t;
+
 typedef struct StunContext
 {
     uint8_t * pStart;
     size_t totalLength;
     size_t currentIndex;
     uint32_t attributeFlag;
-    StunReadWriteFunctions_t readWriteFunctions;
+    StunReadWriteFunctions_t readWriteFunctions; /* Not set up with STUN_COMPILE_TIME_ENDIANNESS. */
+    StunAttributeIndex_t * pAttributeIndex;
+    StunUnknownAttributes_t * pUnknownAttributes;
+    StunScatterGather_t * pScatterGather;
+    uint32_t unfilledReservations;
 } StunContext_t;
 
+/* An attribute of a message deserialized with StunDeserializer_InitBatch. */
+typedef struct StunBatchAttribute
+{
+    uint16_t attributeType;
+    uint16_t attributeValueLength;
+    uint32_t attributeValueOffset;
+} StunBatchAttribute_t;
+
+/* Struct-of-arrays output of StunDeserializer_InitBatch. All the per-message
+ * arrays are provided by the caller and must have room for the number of
+ * messages in the burst. The attributes of all the messages share
+ * pAttributes - message i owns pAttributeCount[ i ] entries starting at
+ * pAttributeStart[ i ]. */
+typedef struct StunDeserializerBatch
+{
+    uint8_t * const * ppStunMessages;
+    const size_t * pStunMessageLengths;
+    size_t messageCount;
+    StunReadWriteFunctions_t readWriteFunctions;
+
+    StunResult_t * pResults;
+    StunMessageType_t * pMessageTypes;
+    uint8_t ** ppTransactionIds;
+    uint16_t * pAttributeStart;
+    uint16_t * pAttributeCount;
+
+    StunBatchAttribute_t * pAttributes;
+    uint16_t maxAttributes;
+    uint16_t usedAttributes;
+} StunDeserializerBatch_t;
+
 /* This cannot be struct StunHeader to avoid collision with the same name in
  * the KVS WebRTC C-SDK. */
 typedef struct StunMessageHeader
@@ -209,6 +484,76 @@ typedef struct StunAttributesAddress
     uint8_t address[ STUN_IPV6_ADDRESS_SIZE ];
 } StunAttributeAddress_t;
 
+/* Value of an attribute as decoded by StunDeserializer_ParseAll. The member
+ * to use depends on the attribute type. Attributes with other types (for
+ * example, USERNAME or DATA) are only available as the raw attribute. */
+typedef union StunAttributeValue
+{
+    uint32_t uint32Value; /* PRIORITY, LIFETIME, CHANGE-REQUEST, FINGERPRINT. */
+    uint64_t uint64Value; /* ICE-CONTROLLED, ICE-CONTROLLING, RESERVATION-TOKEN. */
+    uint16_t channelNumber;
+    StunAttributeAddress_t address; /* Already XOR'ed for XOR-*-ADDRESS. */
+    struct
+    {
+        uint16_t errorCode;
+        const uint8_t * pErrorPhrase;
+        uint16_t errorPhraseLength;
+    } error;
+} StunAttributeValue_t;
+
+/* Called by StunDeserializer_ParseAll for every attribute of the registered
+ * type. Returning anything other than STUN_RESULT_OK stops the parsing. */
+typedef StunResult_t ( * StunAttributeHandler_t )( void * pUserData,
+                                                   const StunAttribute_t * pAttribute,
+                                                   const StunAttributeValue_t * pValue );
+
+/* Handler and value decoder of every attribute slot. */
+typedef struct StunAttributeHandlerTable
+{
+    StunAttributeHandler_t handlers[ STUN_ATTRIBUTE_SLOT_COUNT ];
+    uint8_t valueKinds[ STUN_ATTRIBUTE_SLOT_COUNT ];
+} StunAttributeHandlerTable_t;
+
+/* The commonly used attributes of a message, filled in one pass by
+ * StunDeserializer_Decode. A field is only valid if its STUN_DECODED_FLAG_* bit
+ * is set in presentAttributes. Spans point into the message. The fields needed
+ * for an ICE connectivity check come first so that they share the first cache
+ * line. */
+typedef struct STUN_CACHE_LINE_ALIGNED StunDecodedMessage
+{
+    StunHeader_t header;
+    uint32_t presentAttributes;
+    uint32_t priority;
+    uint64_t tieBreaker; /* ICE-CONTROLLING or ICE-CONTROLLED, as per the flags. */
+    uint8_t * pUsername;
+    uint16_t usernameLength;
+    uint16_t errorCode;
+    uint32_t lifetime;
+    uint32_t integrityOffset;   /* Offset of the MESSAGE-INTEGRITY attribute header. */
+    uint32_t fingerprintOffset; /* Offset of the FINGERPRINT attribute header. */
+    uint16_t nonceLength;
+    uint16_t realmLength;
+    uint16_t errorPhraseLength;
+    uint8_t * pNonce;
+    uint8_t * pRealm;
+    uint8_t * pErrorPhrase;
+    StunAttributeAddress_t xorMappedAddress;
+    StunAttributeAddress_t xorPeerAddress;
+    StunAttributeAddress_t xorRelayedAddress;
+    StunUnknownAttributes_t unknownAttributes; /* Against STUN_ATTRIBUTE_KNOWN_TYPES_DEFAULT. */
+} StunDecodedMessage_t;
+
+/* The bytes covered by MESSAGE-INTEGRITY or FINGERPRINT, without modifying the
+ * message: header, which is a copy of the message header with the length set
+ * to messageLength, followed by the bodyLength bytes at pBody. */
+typedef struct StunVerificationSpan
+{
+    uint8_t header[ STUN_HEADER_LENGTH ];
+    const uint8_t * pBody;
+    size_t bodyLength;
+    uint16_t messageLength;
+} StunVerificationSpan_t;
+
 /*-----------------------------------------------------------*/
 
 #endif /* STUN_DATA_TYPES_H */
@@ -0,0 +1,36 @@
+#ifndef STUN_DEMUX_H
+#define STUN_DEMUX_H
+
+#include "stun_data_types.h"
+
+/* Protocols that can share a WebRTC socket, told apart by the first byte of
+ * every packet (RFC 7983). */
+typedef enum StunProtocol
+{
+    STUN_PROTOCOL_UNKNOWN,
+    STUN_PROTOCOL_STUN,
+    STUN_PROTOCOL_ZRTP,
+    STUN_PROTOCOL_DTLS,
+    STUN_PROTOCOL_TURN_CHANNEL,
+    STUN_PROTOCOL_RTP
+} StunProtocol_t;
+
+/* Gets the protocol of a received packet. Packets that start like STUN but do
+ * not have the magic cookie and a message length consistent with the packet
+ * length are reported as STUN_PROTOCOL_UNKNOWN. For STUN packets, pStunHeader,
+ * if not NULL, is filled in from the already validated header. */
+StunResult_t StunDemux_Classify( const uint8_t * pPacket,
+                                 size_t packetLength,
+                                 StunProtocol_t * pProtocol,
+                                 StunHeader_t * pStunHeader );
+
+/* Same as StunDemux_Classify for packetCount packets, for example from one
+ * recvmmsg call. pStunHeaders can be NULL; otherwise only the entries of STUN
+ * packets are written. */
+StunResult_t StunDemux_ClassifyBatch( const uint8_t * const * ppPackets,
+                                      const size_t * pPacketLengths,
+                                      size_t packetCount,
+                                      StunProtocol_t * pProtocols,
+                                      StunHeader_t * pStunHeaders );
+
+#endif /* STUN_DEMUX_H */
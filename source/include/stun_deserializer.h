@@ -2,15 +2,82 @@
 #define STUN_DESERIALIZER_H
 
 #include "stun_data_types.h"
+#include "stun_hmac_sha1.h"
 
 StunResult_t StunDeserializer_Init( StunContext_t * pCtx,
                                     uint8_t * pStunMessage,
                                     size_t stunMessageLength,
                                     StunHeader_t * pStunHeader );
 
+/* Classifies a burst of datagrams as STUN or not, without initializing a
+ * context for each of them. Bit i of pStunMask, which must have room for
+ * ( messageCount + 63 ) / 64 words, is set if StunDemux_ClassifyBatch would
+ * report message i as STUN: its first byte is 0-3 (RFC 7983), and it has the
+ * magic cookie and a message length field consistent with its length. */
+StunResult_t StunDeserializer_ClassifyBatch( const uint8_t * const * ppStunMessages,
+                                             const size_t * pStunMessageLengths,
+                                             size_t messageCount,
+                                             uint64_t * pStunMask );
+
+/* Deserializes a burst of messages. The caller sets the output arrays and
+ * pAttributes/maxAttributes in pBatch before calling. The result of each
+ * message is returned in pBatch->pResults - the return value only reports
+ * bad parameters. */
+StunResult_t StunDeserializer_InitBatch( StunDeserializerBatch_t * pBatch,
+                                         uint8_t * const * ppStunMessages,
+                                         const size_t * pStunMessageLengths,
+                                         size_t messageCount );
+
+StunResult_t StunDeserializer_GetBatchAttribute( const StunDeserializerBatch_t * pBatch,
+                                                 size_t messageIndex,
+                                                 uint16_t attributeIndex,
+                                                 StunAttribute_t * pAttribute );
+
+StunResult_t StunDeserializer_GetBatchContext( const StunDeserializerBatch_t * pBatch,
+                                               size_t messageIndex,
+                                               StunContext_t * pCtx );
+
 StunResult_t StunDeserializer_GetNextAttribute( StunContext_t * pCtx,
                                                 StunAttribute_t * pAttribute );
 
+/* Makes StunDeserializer_GetNextAttribute, and the APIs that walk the message
+ * with it, collect the comprehension-required attribute types that are not
+ * understood into pUnknownAttributes. knownTypes has bit t set for every
+ * understood type t below 0x0040 - STUN_ATTRIBUTE_KNOWN_TYPES_DEFAULT lists the
+ * types in StunAttributeType_t. Call it after StunDeserializer_Init and, once
+ * the message is parsed, reject it if pUnknownAttributes->count is not 0. */
+StunResult_t StunDeserializer_TrackUnknownAttributes( StunContext_t * pCtx,
+                                                      StunUnknownAttributes_t * pUnknownAttributes,
+                                                      uint64_t knownTypes );
+
+/* Initializes a handler table with no handlers. */
+StunResult_t StunDeserializer_InitHandlerTable( StunAttributeHandlerTable_t * pTable );
+
+/* Registers the handler for an attribute type, or removes it if handler is
+ * NULL. Types outside 0x0000-0x003F and 0x8000-0x803F share one handler,
+ * which gets their raw value. */
+StunResult_t StunDeserializer_SetAttributeHandler( StunAttributeHandlerTable_t * pTable,
+                                                   StunAttributeType_t attributeType,
+                                                   StunAttributeHandler_t handler );
+
+/* Walks the remaining attributes of the message, with the same checks as
+ * StunDeserializer_GetNextAttribute, and passes every attribute that has a
+ * handler to it along with its decoded value. Attributes without a handler
+ * are skipped without being decoded. */
+StunResult_t StunDeserializer_ParseAll( StunContext_t * pCtx,
+                                        const StunAttributeHandlerTable_t * pTable,
+                                        void * pUserData );
+
+/* Initializes pCtx for the message and decodes its header and the attributes
+ * held in StunDecodedMessage_t in a single walk, with the same checks as
+ * StunDeserializer_GetNextAttribute. Only the first instance of each attribute
+ * is stored. Unknown comprehension-required attributes are collected in
+ * pDecoded->unknownAttributes. */
+StunResult_t StunDeserializer_Decode( StunContext_t * pCtx,
+                                      uint8_t * pStunMessage,
+                                      size_t stunMessageLength,
+                                      StunDecodedMessage_t * pDecoded );
+
 StunResult_t StunDeserializer_ParseAttributeErrorCode( const StunAttribute_t * pAttribute,
                                                        uint16_t * pErrorCode,
                                                        uint8_t ** ppErrorPhrase,
@@ -28,6 +95,22 @@ StunResult_t StunDeserializer_ParseAttributeFingerprint( const StunContext_t * p
                                                          const StunAttribute_t * pAttribute,
                                                          uint32_t * pCrc32Fingerprint );
 
+/* Checks the FINGERPRINT attribute pAttribute, obtained using
+ * StunDeserializer_GetNextAttribute or StunDeserializer_FindAttribute, against
+ * the CRC-32 of the message. Returns STUN_RESULT_FINGERPRINT_MISMATCH if it
+ * does not match. The message is not modified. */
+StunResult_t StunDeserializer_VerifyFingerprint( const StunContext_t * pCtx,
+                                                 const StunAttribute_t * pAttribute );
+
+/* Checks the MESSAGE-INTEGRITY attribute pAttribute against the HMAC-SHA1 of
+ * the message computed with the precomputed key pHmacKey. Returns
+ * STUN_RESULT_INTEGRITY_MISMATCH if it does not match. The length in the
+ * message header is adjusted on a copy, so the message is not modified and a
+ * FINGERPRINT attribute following it can still be verified. */
+StunResult_t StunDeserializer_VerifyIntegrity( const StunContext_t * pCtx,
+                                               const StunAttribute_t * pAttribute,
+                                               const StunHmacKey_t * pHmacKey );
+
 StunResult_t StunDeserializer_ParseAttributeLifetime( const StunContext_t * pCtx,
                                                       const StunAttribute_t * pAttribute,
                                                       uint32_t * pLifetime );
@@ -56,10 +139,34 @@ StunResult_t StunDeserializer_GetFingerprintBuffer( StunContext_t * pCtx,
                                                     uint8_t ** ppStunMessage,
                                                     uint16_t * pStunMessageLength );
 
+/* Same as StunDeserializer_GetIntegrityBuffer and
+ * StunDeserializer_GetFingerprintBuffer, to be called right after
+ * StunDeserializer_GetNextAttribute returns the MESSAGE-INTEGRITY or FINGERPRINT
+ * attribute, but the message is not modified. The HMAC or CRC-32 is computed
+ * over pSpan->header followed by pSpan->pBody, so the message can be in a
+ * read-only or shared buffer. */
+StunResult_t StunDeserializer_GetIntegritySpan( const StunContext_t * pCtx,
+                                                StunVerificationSpan_t * pSpan );
+
+StunResult_t StunDeserializer_GetFingerprintSpan( const StunContext_t * pCtx,
+                                                  StunVerificationSpan_t * pSpan );
+
 StunResult_t StunDeserializer_FindAttribute( StunContext_t * pCtx,
                                              StunAttributeType_t attributeType,
                                              StunAttribute_t * pAttribute );
 
+StunResult_t StunDeserializer_FindAttributeInstance( StunContext_t * pCtx,
+                                                     StunAttributeType_t attributeType,
+                                                     uint16_t instance,
+                                                     StunAttribute_t * pAttribute );
+
+StunResult_t StunDeserializer_GetAttributeCount( StunContext_t * pCtx,
+                                                 StunAttributeType_t attributeType,
+                                                 uint16_t * pCount );
+
+StunResult_t StunDeserializer_BuildAttributeIndex( StunContext_t * pCtx,
+                                                   StunAttributeIndex_t * pIndex );
+
 StunResult_t StunDeserializer_UpdateAttributeNonce( const StunContext_t * pCtx,
                                                     const char * pNonce,
                                                     uint16_t nonceLength,
@@ -3,6 +3,7 @@
 
 /* Standard includes. */
 #include <stdint.h>
+#include <string.h>
 
 /* Endianness Function types. */
 typedef void ( * WriteUint16_t ) ( uint8_t * pDst, uint16_t val );
@@ -24,4 +25,120 @@ typedef struct StunReadWriteFunctions
 
 void Stun_InitReadWriteFunctions( StunReadWriteFunctions_t * pReadWriteFunctions );
 
+/*-----------------------------------------------------------*/
+
+/*
+ * Inline network byte order accessors.
+ *
+ * When the library is built with STUN_COMPILE_TIME_ENDIANNESS, the serializer
+ * and deserializer use these instead of the read/write functions in
+ * StunContext_t and the read/write functions are not set up in the context.
+ * With GCC and Clang, the byte order is known at compile time and every
+ * access is a single (possibly unaligned) load or store and a byte swap,
+ * which is one movbe on x86. Other compilers get byte-by-byte accesses, which
+ * work with either byte order.
+ */
+#if defined( __GNUC__ ) && defined( __BYTE_ORDER__ )
+    #if ( __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
+        #define STUN_NETWORK_ORDER_16( value )    __builtin_bswap16( value )
+        #define STUN_NETWORK_ORDER_32( value )    __builtin_bswap32( value )
+        #define STUN_NETWORK_ORDER_64( value )    __builtin_bswap64( value )
+    #else
+        #define STUN_NETWORK_ORDER_16( value )    ( value )
+        #define STUN_NETWORK_ORDER_32( value )    ( value )
+        #define STUN_NETWORK_ORDER_64( value )    ( value )
+    #endif
+
+static inline void Stun_WriteUint16( uint8_t * pDst,
+                                     uint16_t val )
+{
+    val = STUN_NETWORK_ORDER_16( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
+}
+
+static inline void Stun_WriteUint32( uint8_t * pDst,
+                                     uint32_t val )
+{
+    val = STUN_NETWORK_ORDER_32( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
+}
+
+static inline void Stun_WriteUint64( uint8_t * pDst,
+                                     uint64_t val )
+{
+    val = STUN_NETWORK_ORDER_64( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
+}
+
+static inline uint16_t Stun_ReadUint16( const uint8_t * pSrc )
+{
+    uint16_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return STUN_NETWORK_ORDER_16( val );
+}
+
+static inline uint32_t Stun_ReadUint32( const uint8_t * pSrc )
+{
+    uint32_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return STUN_NETWORK_ORDER_32( val );
+}
+
+static inline uint64_t Stun_ReadUint64( const uint8_t * pSrc )
+{
+    uint64_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return STUN_NETWORK_ORDER_64( val );
+}
+
+#else /* if defined( __GNUC__ ) && defined( __BYTE_ORDER__ ) */
+
+static inline void Stun_WriteUint16( uint8_t * pDst,
+                                     uint16_t val )
+{
+    pDst[ 0 ] = ( uint8_t ) ( val >> 8 );
+    pDst[ 1 ] = ( uint8_t ) ( val );
+}
+
+static inline void Stun_WriteUint32( uint8_t * pDst,
+                                     uint32_t val )
+{
+    Stun_WriteUint16( &( pDst[ 0 ] ), ( uint16_t ) ( val >> 16 ) );
+    Stun_WriteUint16( &( pDst[ 2 ] ), ( uint16_t ) ( val ) );
+}
+
+static inline void Stun_WriteUint64( uint8_t * pDst,
+                                     uint64_t val )
+{
+    Stun_WriteUint32( &( pDst[ 0 ] ), ( uint32_t ) ( val >> 32 ) );
+    Stun_WriteUint32( &( pDst[ 4 ] ), ( uint32_t ) ( val ) );
+}
+
+static inline uint16_t Stun_ReadUint16( const uint8_t * pSrc )
+{
+    return ( uint16_t ) ( ( ( uint16_t ) pSrc[ 0 ] << 8 ) | ( uint16_t ) pSrc[ 1 ] );
+}
+
+static inline uint32_t Stun_ReadUint32( const uint8_t * pSrc )
+{
+    return ( ( uint32_t ) Stun_ReadUint16( &( pSrc[ 0 ] ) ) << 16 ) |
+           ( uint32_t ) Stun_ReadUint16( &( pSrc[ 2 ] ) );
+}
+
+static inline uint64_t Stun_ReadUint64( const uint8_t * pSrc )
+{
+    return ( ( uint64_t ) Stun_ReadUint32( &( pSrc[ 0 ] ) ) << 32 ) |
+           ( uint64_t ) Stun_ReadUint32( &( pSrc[ 4 ] ) );
+}
+
+#endif /* if defined( __GNUC__ ) && defined( __BYTE_ORDER__ ) */
+
+/*-----------------------------------------------------------*/
+
 #endif /* STUN_ENDIANNESS_H */
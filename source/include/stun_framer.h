@@ -0,0 +1,75 @@
+#ifndef STUN_FRAMER_H
+#define STUN_FRAMER_H
+
+#include "stun_data_types.h"
+
+/* Length of the RFC 4571 frame length prefix. */
+#define STUN_FRAMER_RFC4571_PREFIX_LENGTH    2
+
+typedef enum StunFramingMode
+{
+    /* STUN and TURN ChannelData messages sent back to back, as on TURN and
+     * STUN connections over TCP and TLS. ChannelData messages are padded to
+     * a multiple of 4 bytes. */
+    STUN_FRAMING_MODE_TURN,
+    /* Every frame is preceded by a 16 bit length (RFC 4571), as with ICE-TCP
+     * (RFC 6544). */
+    STUN_FRAMING_MODE_RFC4571
+} StunFramingMode_t;
+
+typedef enum StunFrameType
+{
+    STUN_FRAME_TYPE_STUN,
+    STUN_FRAME_TYPE_CHANNEL_DATA,
+    /* Only in RFC 4571 mode, where other protocols (for example, DTLS or RTP)
+     * can share the connection. */
+    STUN_FRAME_TYPE_OTHER
+} StunFrameType_t;
+
+typedef struct StunFrame
+{
+    StunFrameType_t frameType;
+    /* STUN or ChannelData message, without the RFC 4571 length prefix. */
+    const uint8_t * pFrame;
+    size_t frameLength;
+} StunFrame_t;
+
+typedef struct StunFramerContext
+{
+    StunFramingMode_t framingMode;
+
+    /* Chunk being drained. */
+    const uint8_t * pChunk;
+    size_t chunkLength;
+    size_t chunkIndex;
+
+    /* Frame straddling two or more chunks. */
+    uint8_t * pScratch;
+    size_t scratchLength;
+    size_t scratchUsed;
+} StunFramerContext_t;
+
+/* Initializes a framer for one connection. pScratch holds frames that are
+ * split across chunks and must be as large as the largest accepted frame
+ * (65535 + STUN_HEADER_LENGTH bytes for any STUN message). */
+StunResult_t StunFramer_Init( StunFramerContext_t * pCtx,
+                              StunFramingMode_t framingMode,
+                              uint8_t * pScratch,
+                              size_t scratchLength );
+
+/* Passes the bytes returned by the next read on the connection. The previous
+ * chunk must have been drained with StunFramer_GetNextFrame first. */
+StunResult_t StunFramer_AddChunk( StunFramerContext_t * pCtx,
+                                  const uint8_t * pChunk,
+                                  size_t chunkLength );
+
+/* Gets the next complete frame. Frames contained in the chunk point into it
+ * and no bytes are copied. A frame split across chunks is assembled in the
+ * scratch buffer and stays valid until the next call. Returns
+ * STUN_RESULT_NO_MORE_FRAME_FOUND once the chunk is drained, after saving any
+ * partial frame, and STUN_RESULT_INVALID_FRAME if the stream is corrupt, after
+ * which the connection must be closed. */
+StunResult_t StunFramer_GetNextFrame( StunFramerContext_t * pCtx,
+                                      StunFrame_t * pFrame );
+
+#endif /* STUN_FRAMER_H */
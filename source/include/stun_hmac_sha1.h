@@ -0,0 +1,62 @@
+#ifndef STUN_HMAC_SHA1_H
+#define STUN_HMAC_SHA1_H
+
+#include "stun_data_types.h"
+
+#define STUN_SHA1_BLOCK_LENGTH     64
+#define STUN_SHA1_DIGEST_LENGTH    20
+
+/* SHA-1 states after compressing the key XOR'ed with ipad and opad. Computed
+ * once per credential with StunHmac_InitKey and then shared, read-only, by
+ * all the messages signed or verified with that credential. */
+typedef struct StunHmacKey
+{
+    uint32_t innerState[ 5 ];
+    uint32_t outerState[ 5 ];
+} StunHmacKey_t;
+
+/* HMAC-SHA1 computation over data supplied in one or more parts. */
+typedef struct StunHmacContext
+{
+    const StunHmacKey_t * pHmacKey;
+    uint32_t state[ 5 ];
+    uint64_t totalLength;
+    uint8_t block[ STUN_SHA1_BLOCK_LENGTH ];
+    size_t blockLength;
+} StunHmacContext_t;
+
+StunResult_t StunHmac_InitKey( StunHmacKey_t * pHmacKey,
+                               const uint8_t * pKey,
+                               size_t keyLength );
+
+StunResult_t StunHmac_Start( StunHmacContext_t * pHmacCtx,
+                             const StunHmacKey_t * pHmacKey );
+
+StunResult_t StunHmac_Update( StunHmacContext_t * pHmacCtx,
+                              const uint8_t * pData,
+                              size_t dataLength );
+
+StunResult_t StunHmac_Finish( StunHmacContext_t * pHmacCtx,
+                              uint8_t * pHmac );
+
+/* Same as StunHmac_Finish but compares the result with pExpectedHmac in
+ * constant time and returns STUN_RESULT_INTEGRITY_MISMATCH if they differ. */
+StunResult_t StunHmac_VerifyFinish( StunHmacContext_t * pHmacCtx,
+                                    const uint8_t * pExpectedHmac );
+
+/* Computes the HMAC of a span, such as the one returned by
+ * StunSerializer_GetIntegrityBuffer. pHmac must have room for
+ * STUN_HMAC_VALUE_LENGTH bytes. */
+StunResult_t StunHmac_Sign( const StunHmacKey_t * pHmacKey,
+                            const uint8_t * pData,
+                            size_t dataLength,
+                            uint8_t * pHmac );
+
+/* Compares the HMAC of a span, such as the one returned by
+ * StunDeserializer_GetIntegrityBuffer, with pExpectedHmac. */
+StunResult_t StunHmac_Verify( const StunHmacKey_t * pHmacKey,
+                              const uint8_t * pData,
+                              size_t dataLength,
+                              const uint8_t * pExpectedHmac );
+
+#endif /* STUN_HMAC_SHA1_H */
@@ -0,0 +1,49 @@
+#ifndef STUN_RANDOM_H
+#define STUN_RANDOM_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+
+/*
+ * Random transaction IDs and ICE tie-breakers.
+ *
+ * Each thread has its own ChaCha20 generator, so generating takes no system
+ * call and no lock. The generator is seeded from the OS the first time a
+ * thread uses it, reseeded after STUN_RANDOM_RESEED_INTERVAL bytes and, on
+ * POSIX systems, in the child after a fork. The key is replaced with generator
+ * output after every refill and used output is cleared, so earlier output
+ * cannot be recovered from the state of a thread.
+ *
+ * The OS source is getrandom on Linux and /dev/urandom elsewhere. To use
+ * another one, build the library with STUN_RANDOM_GET_ENTROPY defined as a
+ * function-like macro ( pBuffer, length ) that fills the buffer and evaluates
+ * to 0 on success. Requires GCC or Clang.
+ */
+
+/* Bytes generated by a thread before its generator is reseeded. */
+#ifndef STUN_RANDOM_RESEED_INTERVAL
+    #define STUN_RANDOM_RESEED_INTERVAL    ( 1024U * 1024U )
+#endif
+
+/* Fills pBuffer with length random bytes. Returns
+ * STUN_RESULT_ENTROPY_SOURCE_FAILED if the generator needs seeding and the OS
+ * source fails, in which case pBuffer is not written. */
+StunResult_t StunRandom_Fill( uint8_t * pBuffer,
+                              size_t length );
+
+/* Writes STUN_HEADER_TRANSACTION_ID_LENGTH random bytes. */
+StunResult_t StunRandom_GenerateTransactionId( uint8_t * pTransactionId );
+
+/* Generates the transaction ID of the message being serialized in pCtx,
+ * writing it straight into the header. Call it after StunSerializer_Init and
+ * before MESSAGE-INTEGRITY or FINGERPRINT is added. */
+StunResult_t StunRandom_WriteTransactionId( StunContext_t * pCtx );
+
+/* Generates the tie-breaker for ICE-CONTROLLING and ICE-CONTROLLED. */
+StunResult_t StunRandom_GenerateTieBreaker( uint64_t * pTieBreaker );
+
+#endif /* STUN_RANDOM_H */
@@ -2,6 +2,7 @@
 #define STUN_SERIALIZER_H
 
 #include "stun_data_types.h"
+#include "stun_hmac_sha1.h"
 
 StunResult_t StunSerializer_Init( StunContext_t * pCtx,
                                   uint8_t * pBuffer,
@@ -16,6 +17,33 @@ StunResult_t StunSerializer_AddAttributeErrorCode( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeChannelNumber( StunContext_t * pCtx,
                                                        uint16_t channelNumber );
 
+StunResult_t StunSerializer_AddAttributeUnknownAttributes( StunContext_t * pCtx,
+                                                           const uint16_t * pAttributeTypes,
+                                                           uint16_t attributeTypeCount );
+
+/* Starts the 420 (Unknown Attribute) error response to a request, with the
+ * ERROR-CODE and UNKNOWN-ATTRIBUTES attributes, in pBuffer. Other classes of
+ * messages are rejected with STUN_RESULT_BAD_PARAM. pUnknownAttributes
+ * is the one filled while parsing the request. MESSAGE-INTEGRITY and
+ * FINGERPRINT can then be added before calling StunSerializer_Finalize. */
+StunResult_t StunSerializer_InitUnknownAttributesResponse( StunContext_t * pCtx,
+                                                           uint8_t * pBuffer,
+                                                           size_t bufferLength,
+                                                           const StunHeader_t * pRequestHeader,
+                                                           const StunUnknownAttributes_t * pUnknownAttributes );
+
+/* Starts the response to the request received in pBuffer, in the same buffer.
+ * The message type is replaced with responseType (for example,
+ * STUN_MESSAGE_TYPE_TO_SUCCESS_RESPONSE of the request type), which must be a
+ * success or error response with the method of the request. The magic cookie
+ * and the transaction ID are kept where they are and the attributes of the
+ * request are dropped. bufferLength is the size of the buffer, not of the
+ * request, so that the response can be longer than the request. */
+StunResult_t StunSerializer_InitResponseInPlace( StunContext_t * pCtx,
+                                                 uint8_t * pBuffer,
+                                                 size_t bufferLength,
+                                                 StunMessageType_t responseType );
+
 StunResult_t StunSerializer_AddAttributeUseCandidate( StunContext_t * pCtx );
 
 StunResult_t StunSerializer_AddAttributeDontFragment( StunContext_t * pCtx );
@@ -26,6 +54,10 @@ StunResult_t StunSerializer_AddAttributePriority( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeFingerprint( StunContext_t * pCtx,
                                                      uint32_t crc32Fingerprint );
 
+/* Computes the CRC-32 of the message serialized so far and adds the
+ * FINGERPRINT attribute. */
+StunResult_t StunSerializer_AddFingerprint( StunContext_t * pCtx );
+
 StunResult_t StunSerializer_AddAttributeLifetime( StunContext_t * pCtx,
                                                   uint32_t lifetime );
 
@@ -62,33 +94,38 @@ StunResult_t StunSerializer_AddAttributeIntegrity( StunContext_t * pCtx,
                                                    const uint8_t * pIntegrity,
                                                    uint16_t integrityLength );
 
+/* Computes the HMAC-SHA1 of the message serialized so far using the
+ * precomputed key pHmacKey and adds the MESSAGE-INTEGRITY attribute. */
+StunResult_t StunSerializer_AddIntegrity( StunContext_t * pCtx,
+                                          const StunHmacKey_t * pHmacKey );
+
 StunResult_t StunSerializer_AddAttributeAddress( StunContext_t * pCtx,
-                                                 StunAttributeAddress_t * pAddress,
+                                                 const StunAttributeAddress_t * pAddress,
                                                  StunAttributeType_t attributeType );
 
 StunResult_t StunSerializer_AddAttributeMappedAddress( StunContext_t * pCtx,
-                                                       StunAttributeAddress_t * pMappedAddress );
+                                                       const StunAttributeAddress_t * pMappedAddress );
 
 StunResult_t StunSerializer_AddAttributeResponseAddress( StunContext_t * pCtx,
-                                                         StunAttributeAddress_t * pResponseAddress );
+                                                         const StunAttributeAddress_t * pResponseAddress );
 
 StunResult_t StunSerializer_AddAttributeSourceAddress( StunContext_t * pCtx,
-                                                       StunAttributeAddress_t * pSourceAddress );
+                                                       const StunAttributeAddress_t * pSourceAddress );
 
 StunResult_t StunSerializer_AddAttributeChangedAddress( StunContext_t * pCtx,
-                                                        StunAttributeAddress_t * pChangedAddress );
+                                                        const StunAttributeAddress_t * pChangedAddress );
 
 StunResult_t StunSerializer_AddAttributeChangedReflectedFrom( StunContext_t * pCtx,
-                                                              StunAttributeAddress_t * pReflectedFromAddress );
+                                                              const StunAttributeAddress_t * pReflectedFromAddress );
 
 StunResult_t StunSerializer_AddAttributeXorMappedAddress( StunContext_t * pCtx,
-                                                          StunAttributeAddress_t * pMappedAddress );
+                                                          const StunAttributeAddress_t * pMappedAddress );
 
 StunResult_t StunSerializer_AddAttributeXorPeerAddress( StunContext_t * pCtx,
-                                                        StunAttributeAddress_t * pPeerAddress );
+                                                        const StunAttributeAddress_t * pPeerAddress );
 
 StunResult_t StunSerializer_AddAttributeXorRelayedAddress( StunContext_t * pCtx,
-                                                           StunAttributeAddress_t * pRelayedAddress );
+                                                           const StunAttributeAddress_t * pRelayedAddress );
 
 StunResult_t StunSerializer_GetIntegrityBuffer( StunContext_t * pCtx,
                                                 uint8_t ** ppStunMessage,
@@ -101,4 +138,56 @@ StunResult_t StunSerializer_GetFingerprintBuffer( StunContext_t * pCtx,
 StunResult_t StunSerializer_Finalize( StunContext_t * pCtx,
                                       uint32_t * pStunMessageLength );
 
+/* Switches a context, right after StunSerializer_Init, to scatter-gather mode.
+ * Attribute values of at least STUN_SCATTER_GATHER_MIN_REFERENCE_LENGTH bytes
+ * (for example, the DATA of Send indications) are then referenced in place
+ * and must stay valid until the message is sent. Everything else is written
+ * to the buffer given to StunSerializer_Init. After StunSerializer_Finalize,
+ * the message is pScatterGather->iovecCount parts in pIovecs. Every
+ * referenced value takes up to 2 parts and the end of the message 1 more.
+ * MESSAGE-INTEGRITY and FINGERPRINT must be added with
+ * StunSerializer_AddIntegrity and StunSerializer_AddFingerprint, which hash
+ * all the parts. The GetIntegrityBuffer and GetFingerprintBuffer APIs return
+ * STUN_RESULT_BAD_PARAM once a value is referenced. */
+StunResult_t StunSerializer_UseScatterGather( StunContext_t * pCtx,
+                                              StunScatterGather_t * pScatterGather,
+                                              StunIovec_t * pIovecs,
+                                              size_t maxIovecs );
+
+/* Adds an attribute with a valueLength bytes value, zeroed, to be filled
+ * later, when the value is known. Other attributes can be added in the
+ * meantime. StunSerializer_AddIntegrity, StunSerializer_AddFingerprint, the
+ * GetIntegrityBuffer and GetFingerprintBuffer APIs and StunSerializer_Finalize
+ * return STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED until every reserved
+ * attribute is filled, except when only calculating the message size. An
+ * address takes STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH plus
+ * STUN_IPV4_ADDRESS_SIZE or STUN_IPV6_ADDRESS_SIZE bytes. MESSAGE-INTEGRITY
+ * and FINGERPRINT cannot be reserved. */
+StunResult_t StunSerializer_ReserveAttribute( StunContext_t * pCtx,
+                                              StunAttributeType_t attributeType,
+                                              uint16_t valueLength,
+                                              StunReservedAttribute_t * pReservedAttribute );
+
+/* Fill a reserved attribute. The value must have the reserved length. A
+ * reserved attribute can be filled again until MESSAGE-INTEGRITY or
+ * FINGERPRINT is added, after which STUN_RESULT_INVALID_ATTRIBUTE_ORDER is
+ * returned. */
+StunResult_t StunSerializer_FillReservedAttribute( StunContext_t * pCtx,
+                                                   StunReservedAttribute_t * pReservedAttribute,
+                                                   const uint8_t * pValue,
+                                                   uint16_t valueLength );
+
+StunResult_t StunSerializer_FillReservedUint32( StunContext_t * pCtx,
+                                                StunReservedAttribute_t * pReservedAttribute,
+                                                uint32_t value );
+
+StunResult_t StunSerializer_FillReservedUint64( StunContext_t * pCtx,
+                                                StunReservedAttribute_t * pReservedAttribute,
+                                                uint64_t value );
+
+/* XOR's the address if the reserved attribute is one of XOR-*-ADDRESS. */
+StunResult_t StunSerializer_FillReservedAddress( StunContext_t * pCtx,
+                                                 StunReservedAttribute_t * pReservedAttribute,
+                                                 const StunAttributeAddress_t * pAddress );
+
 #endif /* STUN_SERIALIZER_H */
@@ -0,0 +1,276 @@
+#ifndef STUN_STATS_H
+#define STUN_STATS_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+
+/*
+ * Optional counters of what the library does, compiled in when the library
+ * is built with STUN_ENABLE_STATS (GCC or Clang only). The result of every
+ * API returning a StunResult_t is counted, and messages, attributes and
+ * bytes are counted by the serializer and deserializer. Each
+ * thread counts into its own cache line aligned block, so counting takes no
+ * lock or atomic read-modify-write and does not share cache lines between
+ * threads. StunStats_GetSnapshot adds the blocks up when asked. Without
+ * STUN_ENABLE_STATS nothing is counted and snapshots are all zero.
+ */
+
+/* Number of threads that can have their own block at the same time. A thread
+ * gives its block back when it exits (POSIX threads) or calls
+ * StunStats_ReleaseThread, and the next new thread takes it over with its
+ * counts. Threads that find no free block count into one shared block with
+ * atomic adds instead. */
+#ifndef STUN_STATS_MAX_THREADS
+    #define STUN_STATS_MAX_THREADS    16
+#endif
+
+/* Results are counted per value of StunResult_t. Values from
+ * STUN_STATS_RESULT_COUNT - 1 up share the last counter. */
+#define STUN_STATS_RESULT_COUNT                         32
+
+/* Messages are counted per class and method. Methods above 0x00F are counted
+ * as method 0. */
+#define STUN_STATS_MESSAGE_TYPE_COUNT                   64
+#define STUN_STATS_MESSAGE_METHOD( messageType )                              \
+    ( ( ( messageType ) & 0x000F ) | ( ( ( messageType ) & 0x00E0 ) >> 1 ) | \
+      ( ( ( messageType ) & 0x3E00 ) >> 2 ) )
+#define STUN_STATS_MESSAGE_CLASS( messageType )                               \
+    ( ( ( ( messageType ) & 0x0100 ) >> 7 ) | ( ( ( messageType ) & 0x0010 ) >> 4 ) )
+#define STUN_STATS_MESSAGE_TYPE_INDEX( messageType )                          \
+    ( ( STUN_STATS_MESSAGE_CLASS( messageType ) << 4 ) |                      \
+      ( ( STUN_STATS_MESSAGE_METHOD( messageType ) < 16 ) ? STUN_STATS_MESSAGE_METHOD( messageType ) : 0 ) )
+
+/* The APIs whose results are counted. An API that forwards to another one,
+ * for example StunSerializer_AddAttributeXorMappedAddress, counts the result
+ * for both.
+ *
+ * Deserialized messages and attributes are counted once per walk of the
+ * message by the application: StunDeserializer_Init, GetNextAttribute,
+ * ParseAll and Decode count them, StunDeserializer_FindAttribute,
+ * FindAttributeInstance and GetAttributeCount do not count the attributes
+ * they walk over again, and StunDeserializer_BuildAttributeIndex does not
+ * either. */
+typedef enum StunStatsApi
+{
+    STUN_STATS_API_SERIALIZER_INIT = 0,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ERROR_CODE,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_UNKNOWN_ATTRIBUTES,
+    STUN_STATS_API_SERIALIZER_INIT_UNKNOWN_ATTRIBUTES_RESPONSE,
+    STUN_STATS_API_SERIALIZER_INIT_RESPONSE_IN_PLACE,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANNEL_NUMBER,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_USE_CANDIDATE,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_DONT_FRAGMENT,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_PRIORITY,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_FINGERPRINT,
+    STUN_STATS_API_SERIALIZER_ADD_FINGERPRINT,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_LIFETIME,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGE_REQUEST,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ICE_CONTROLLED,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ICE_CONTROLLING,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_USERNAME,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_DATA,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_REALM,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_NONCE,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_REQUESTED_TRANSPORT,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_INTEGRITY,
+    STUN_STATS_API_SERIALIZER_ADD_INTEGRITY,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_MAPPED_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_RESPONSE_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_SOURCE_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGED_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGED_REFLECTED_FROM,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_MAPPED_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_PEER_ADDRESS,
+    STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_RELAYED_ADDRESS,
+    STUN_STATS_API_SERIALIZER_GET_INTEGRITY_BUFFER,
+    STUN_STATS_API_SERIALIZER_GET_FINGERPRINT_BUFFER,
+    STUN_STATS_API_SERIALIZER_FINALIZE,
+    STUN_STATS_API_SERIALIZER_USE_SCATTER_GATHER,
+    STUN_STATS_API_SERIALIZER_RESERVE_ATTRIBUTE,
+    STUN_STATS_API_SERIALIZER_FILL_RESERVED_ATTRIBUTE,
+    STUN_STATS_API_SERIALIZER_FILL_RESERVED_UINT32,
+    STUN_STATS_API_SERIALIZER_FILL_RESERVED_UINT64,
+    STUN_STATS_API_SERIALIZER_FILL_RESERVED_ADDRESS,
+
+    STUN_STATS_API_DESERIALIZER_INIT,
+    STUN_STATS_API_DESERIALIZER_GET_NEXT_ATTRIBUTE,
+    STUN_STATS_API_DESERIALIZER_TRACK_UNKNOWN_ATTRIBUTES,
+    STUN_STATS_API_DESERIALIZER_INIT_HANDLER_TABLE,
+    STUN_STATS_API_DESERIALIZER_SET_ATTRIBUTE_HANDLER,
+    STUN_STATS_API_DESERIALIZER_PARSE_ALL,
+    STUN_STATS_API_DESERIALIZER_DECODE,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ERROR_CODE,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_CHANNEL_NUMBER,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_PRIORITY,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_FINGERPRINT,
+    STUN_STATS_API_DESERIALIZER_VERIFY_FINGERPRINT,
+    STUN_STATS_API_DESERIALIZER_VERIFY_INTEGRITY,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_LIFETIME,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_CHANGE_REQUEST,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ICE_CONTROLLED,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ICE_CONTROLLING,
+    STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ADDRESS,
+    STUN_STATS_API_DESERIALIZER_GET_INTEGRITY_BUFFER,
+    STUN_STATS_API_DESERIALIZER_GET_FINGERPRINT_BUFFER,
+    STUN_STATS_API_DESERIALIZER_GET_INTEGRITY_SPAN,
+    STUN_STATS_API_DESERIALIZER_GET_FINGERPRINT_SPAN,
+    STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE,
+    STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE_INSTANCE,
+    STUN_STATS_API_DESERIALIZER_GET_ATTRIBUTE_COUNT,
+    STUN_STATS_API_DESERIALIZER_BUILD_ATTRIBUTE_INDEX,
+    STUN_STATS_API_DESERIALIZER_UPDATE_ATTRIBUTE_NONCE,
+    STUN_STATS_API_DESERIALIZER_CLASSIFY_BATCH,
+    STUN_STATS_API_DESERIALIZER_INIT_BATCH,
+    STUN_STATS_API_DESERIALIZER_GET_BATCH_ATTRIBUTE,
+    STUN_STATS_API_DESERIALIZER_GET_BATCH_CONTEXT,
+
+    STUN_STATS_API_HMAC_INIT_KEY,
+    STUN_STATS_API_HMAC_START,
+    STUN_STATS_API_HMAC_UPDATE,
+    STUN_STATS_API_HMAC_FINISH,
+    STUN_STATS_API_HMAC_SIGN,
+    STUN_STATS_API_HMAC_VERIFY_FINISH,
+    STUN_STATS_API_HMAC_VERIFY,
+
+    STUN_STATS_API_FRAMER_INIT,
+    STUN_STATS_API_FRAMER_ADD_CHUNK,
+    STUN_STATS_API_FRAMER_GET_NEXT_FRAME,
+
+    STUN_STATS_API_CHANNEL_DATA_SERIALIZE,
+    STUN_STATS_API_CHANNEL_DATA_DESERIALIZE,
+
+    STUN_STATS_API_DEMUX_CLASSIFY,
+    STUN_STATS_API_DEMUX_CLASSIFY_BATCH,
+
+    STUN_STATS_API_TEMPLATE_COMPILE,
+    STUN_STATS_API_TEMPLATE_INSTANTIATE,
+    STUN_STATS_API_TEMPLATE_PATCH_ADDRESS,
+    STUN_STATS_API_TEMPLATE_PATCH_UINT32,
+    STUN_STATS_API_TEMPLATE_PATCH_UINT64,
+    STUN_STATS_API_TEMPLATE_FINISH,
+
+    STUN_STATS_API_CREDENTIAL_COMPUTE_LONG_TERM_KEY,
+    STUN_STATS_API_CREDENTIAL_CACHE_INIT,
+    STUN_STATS_API_CREDENTIAL_CACHE_INSERT,
+    STUN_STATS_API_CREDENTIAL_CACHE_LOOKUP,
+    STUN_STATS_API_CREDENTIAL_CACHE_INVALIDATE,
+
+    STUN_STATS_API_ADDRESS_ENCODE,
+    STUN_STATS_API_ADDRESS_DECODE,
+    STUN_STATS_API_ADDRESS_ENCODE_BATCH,
+
+    STUN_STATS_API_TRANSACTION_TABLE_INIT,
+    STUN_STATS_API_TRANSACTION_TABLE_ENTER,
+    STUN_STATS_API_TRANSACTION_TABLE_EXIT,
+    STUN_STATS_API_TRANSACTION_TABLE_INSERT,
+    STUN_STATS_API_TRANSACTION_TABLE_LOOKUP,
+    STUN_STATS_API_TRANSACTION_TABLE_REMOVE,
+
+    STUN_STATS_API_TIMER_WHEEL_INIT,
+    STUN_STATS_API_TIMER_WHEEL_ARM,
+    STUN_STATS_API_TIMER_WHEEL_CANCEL,
+    STUN_STATS_API_TIMER_WHEEL_START_TRANSACTION,
+    STUN_STATS_API_TIMER_WHEEL_ADVANCE,
+
+    STUN_STATS_API_RANDOM_FILL,
+    STUN_STATS_API_RANDOM_GENERATE_TRANSACTION_ID,
+    STUN_STATS_API_RANDOM_WRITE_TRANSACTION_ID,
+    STUN_STATS_API_RANDOM_GENERATE_TIE_BREAKER,
+
+    STUN_STATS_API_COUNT
+} StunStatsApi_t;
+
+/* Attributes are counted per attribute slot - see STUN_ATTRIBUTE_TYPE_TO_SLOT. */
+typedef struct StunStats
+{
+    uint64_t results[ STUN_STATS_API_COUNT ][ STUN_STATS_RESULT_COUNT ];
+    uint64_t messagesSerialized[ STUN_STATS_MESSAGE_TYPE_COUNT ];
+    uint64_t messagesDeserialized[ STUN_STATS_MESSAGE_TYPE_COUNT ];
+    uint64_t attributesSerialized[ STUN_ATTRIBUTE_SLOT_COUNT ];
+    uint64_t attributesDeserialized[ STUN_ATTRIBUTE_SLOT_COUNT ];
+    uint64_t bytesSerialized;
+    uint64_t bytesDeserialized;
+    uint64_t attributeOrderViolations;
+} StunStats_t;
+
+/* Fills pSnapshot with the counts of all the threads so far. Counts made by
+ * other threads while it runs may or may not be included. */
+StunResult_t StunStats_GetSnapshot( StunStats_t * pSnapshot );
+
+/* Gives the block of the calling thread back for other threads to use, for
+ * threads that stop using the library without exiting. Its counts stay in
+ * the snapshots. The thread gets a block again if it counts something
+ * afterwards. */
+StunResult_t StunStats_ReleaseThread( void );
+
+/*-----------------------------------------------------------*/
+
+/* Counting, used by the library. */
+#if defined( STUN_ENABLE_STATS )
+
+typedef struct STUN_CACHE_LINE_ALIGNED StunStatsBlock
+{
+    StunStats_t stats;
+    uint32_t isShared;
+    uint32_t isClaimed; /* Used by a thread. */
+} StunStatsBlock_t;
+
+extern __thread StunStatsBlock_t * pStunStatsThreadBlock;
+
+StunStatsBlock_t * StunStats_ClaimBlock( void );
+
+static inline void StunStats_Add( StunStatsBlock_t * pBlock,
+                                  uint64_t * pCounter,
+                                  uint64_t value )
+{
+    if( pBlock->isShared != 0U )
+    {
+        ( void ) __atomic_fetch_add( pCounter, value, __ATOMIC_RELAXED );
+    }
+    else
+    {
+        /* Only this thread writes to its block. The atomic load and store
+         * only keep StunStats_GetSnapshot from reading a torn value and
+         * compile to plain moves. */
+        __atomic_store_n( pCounter, __atomic_load_n( pCounter, __ATOMIC_RELAXED ) + value, __ATOMIC_RELAXED );
+    }
+}
+
+    #define STUN_STATS_ADD( member, value )                                                      \
+    do                                                                                           \
+    {                                                                                            \
+        StunStatsBlock_t * pStatsBlock = pStunStatsThreadBlock;                                  \
+                                                                                                 \
+        if( pStatsBlock == NULL )                                                                \
+        {                                                                                        \
+            pStatsBlock = StunStats_ClaimBlock();                                                \
+        }                                                                                        \
+                                                                                                 \
+        StunStats_Add( pStatsBlock, &( pStatsBlock->stats.member ), ( uint64_t ) ( value ) );    \
+    } while( 0 )
+
+static inline StunResult_t StunStats_CountResult( StunStatsApi_t api,
+                                                  StunResult_t result )
+{
+    uint32_t resultIndex = ( ( uint32_t ) result < STUN_STATS_RESULT_COUNT ) ?
+                           ( uint32_t ) result : ( STUN_STATS_RESULT_COUNT - 1U );
+
+    STUN_STATS_ADD( results[ api ][ resultIndex ], 1 );
+
+    return result;
+}
+
+    #define STUN_STATS_RESULT( api, result )    StunStats_CountResult( ( api ), ( result ) )
+
+#else /* if defined( STUN_ENABLE_STATS ) */
+
+    #define STUN_STATS_ADD( member, value )
+    #define STUN_STATS_RESULT( api, result )    ( result )
+
+#endif /* if defined( STUN_ENABLE_STATS ) */
+
+#endif /* STUN_STATS_H */
@@ -0,0 +1,86 @@
+#ifndef STUN_TEMPLATE_H
+#define STUN_TEMPLATE_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+#include "stun_hmac_sha1.h"
+
+/*
+ * Message templates.
+ *
+ * Servers send many messages of the same shape, for example Binding success
+ * responses with XOR-MAPPED-ADDRESS, MESSAGE-INTEGRITY and FINGERPRINT.
+ * Serialize one such message once with the serializer, using any values, and
+ * compile it with StunTemplate_Compile. After that, each new message is made
+ * by StunTemplate_Instantiate, which copies the message and writes the
+ * transaction ID. Then the values that change are patched by attribute type,
+ * and StunTemplate_Finish computes MESSAGE-INTEGRITY and FINGERPRINT. The
+ * attributes, their order and their lengths always stay as in the template.
+ */
+
+/* Every attribute other than MESSAGE-INTEGRITY and FINGERPRINT takes a slot. */
+#define STUN_TEMPLATE_MAX_SLOTS    8
+
+typedef struct StunTemplateSlot
+{
+    uint16_t attributeType;
+    uint16_t valueOffset;
+    uint16_t valueLength;
+} StunTemplateSlot_t;
+
+typedef struct StunTemplate
+{
+    const uint8_t * pMessage; /* Must stay valid while the template is used. */
+    uint16_t messageLength;
+    uint16_t integrityOffset;   /* Offset of the attribute, 0 if not present. */
+    uint16_t fingerprintOffset; /* Offset of the attribute, 0 if not present. */
+    uint16_t slotCount;
+    StunTemplateSlot_t slots[ STUN_TEMPLATE_MAX_SLOTS ];
+} StunTemplate_t;
+
+/* Records the layout of a serialized message. The message is used in place,
+ * not copied. */
+StunResult_t StunTemplate_Compile( StunTemplate_t * pTemplate,
+                                   const uint8_t * pMessage,
+                                   size_t messageLength );
+
+/* Copies the template into pBuffer and writes the transaction ID. The message
+ * is pTemplate->messageLength bytes long. */
+StunResult_t StunTemplate_Instantiate( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       size_t bufferLength,
+                                       const uint8_t * pTransactionId );
+
+/* Patches the value of an address attribute in a message from
+ * StunTemplate_Instantiate. The XOR-*-ADDRESS attributes are XOR'ed with the
+ * transaction ID already in pBuffer. The address family must be the same as
+ * in the template. */
+StunResult_t StunTemplate_PatchAddress( const StunTemplate_t * pTemplate,
+                                        uint8_t * pBuffer,
+                                        StunAttributeType_t attributeType,
+                                        const StunAttributeAddress_t * pAddress );
+
+/* Patches the value of an attribute with a 4 byte value, such as PRIORITY or
+ * LIFETIME. */
+StunResult_t StunTemplate_PatchUint32( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       StunAttributeType_t attributeType,
+                                       uint32_t value );
+
+/* Patches the value of an attribute with an 8 byte value, such as
+ * ICE-CONTROLLING. */
+StunResult_t StunTemplate_PatchUint64( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       StunAttributeType_t attributeType,
+                                       uint64_t value );
+
+/* Computes MESSAGE-INTEGRITY and FINGERPRINT, if the template has them, after
+ * all the patches. pHmacKey can be NULL if there is no MESSAGE-INTEGRITY. */
+StunResult_t StunTemplate_Finish( const StunTemplate_t * pTemplate,
+                                  uint8_t * pBuffer,
+                                  const StunHmacKey_t * pHmacKey );
+
+#endif /* STUN_TEMPLATE_H */
@@ -0,0 +1,132 @@
+#ifndef STUN_TIMER_WHEEL_H
+#define STUN_TIMER_WHEEL_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+
+/*
+ * Hierarchical timing wheel for request retransmissions and other timers.
+ *
+ * Time is counted in ticks of a length chosen by the application, for example
+ * 1 ms, and moved forward with StunTimerWheel_Advance. The wheel has
+ * STUN_TIMER_WHEEL_LEVELS levels of STUN_TIMER_WHEEL_SLOTS slots. Level 0 has
+ * one slot per tick and each slot of level n covers a full turn of level
+ * n - 1, so with 1 ms ticks the wheel holds timers up to 4.6 hours ahead
+ * without any rounding. Timers further ahead are parked in the last level.
+ *
+ * Timers are owned by the application and linked into the wheel, so arming
+ * and cancelling are O(1) and never allocate. The timers expiring in a tick
+ * are passed to the callback given to StunTimerWheel_Init in batches of up to
+ * STUN_TIMER_WHEEL_BATCH_SIZE.
+ *
+ * A timer started with StunTimerWheel_StartTransaction follows RFC 8489
+ * (section 6.2.1) for a request sent over UDP: it expires with
+ * STUN_TIMER_EVENT_RETRANSMIT at RTO, 3 RTO, 7 RTO and so on for the
+ * STUN_TIMER_WHEEL_RC - 1 retransmissions, and with STUN_TIMER_EVENT_TIMEOUT
+ * STUN_TIMER_WHEEL_RM RTO after the last one. The serialized request given to
+ * StunTimerWheel_StartTransaction is returned with every retransmission, so
+ * the callback sends it again as is.
+ *
+ * The wheel is not thread safe. Use one per thread.
+ */
+
+#define STUN_TIMER_WHEEL_SLOT_BITS    6
+#define STUN_TIMER_WHEEL_SLOTS        ( 1U << STUN_TIMER_WHEEL_SLOT_BITS )
+#define STUN_TIMER_WHEEL_LEVELS       4
+
+/* Most timers passed to one call of the callback. */
+#ifndef STUN_TIMER_WHEEL_BATCH_SIZE
+    #define STUN_TIMER_WHEEL_BATCH_SIZE    64
+#endif
+
+/* Number of transmissions of a request, including the first (Rc). */
+#ifndef STUN_TIMER_WHEEL_RC
+    #define STUN_TIMER_WHEEL_RC    7
+#endif
+
+/* Multiple of the initial RTO waited for after the last transmission (Rm). */
+#ifndef STUN_TIMER_WHEEL_RM
+    #define STUN_TIMER_WHEEL_RM    16
+#endif
+
+typedef enum StunTimerEvent
+{
+    STUN_TIMER_EVENT_EXPIRED,    /* A timer armed with StunTimerWheel_Arm. */
+    STUN_TIMER_EVENT_RETRANSMIT, /* Send pMessage again. The timer is already armed for the next one. */
+    STUN_TIMER_EVENT_TIMEOUT     /* No response after the last transmission. */
+} StunTimerEvent_t;
+
+typedef struct StunTimerLink
+{
+    struct StunTimerLink * pNext;
+    struct StunTimerLink * pPrev;
+} StunTimerLink_t;
+
+typedef struct StunTimer
+{
+    StunTimerLink_t link; /* pNext is NULL when the timer is not armed. */
+    uint64_t expiry;
+    void * pContext;      /* For the application. */
+    StunTimerEvent_t event;
+
+    /* Set by StunTimerWheel_StartTransaction. */
+    const uint8_t * pMessage;
+    size_t messageLength;
+    uint64_t initialRto;
+    uint64_t rto;
+    uint32_t transmissions;
+} StunTimer_t;
+
+/* Called from StunTimerWheel_Advance with timers that expired in the same
+ * tick, which is the current tick of the wheel during the call. The callback
+ * can arm, cancel and reuse any timer, including the ones it is given. */
+typedef void ( * StunTimerCallback_t )( void * pCallbackContext,
+                                        StunTimer_t * const * ppTimers,
+                                        size_t timerCount );
+
+typedef struct StunTimerWheel
+{
+    uint64_t currentTick;
+    StunTimerLink_t slots[ STUN_TIMER_WHEEL_LEVELS ][ STUN_TIMER_WHEEL_SLOTS ];
+    uint64_t occupiedSlots; /* One bit per level 0 slot with timers. */
+    StunTimerLink_t expiring; /* Timers of the slot being expired. */
+    StunTimerCallback_t callback;
+    void * pCallbackContext;
+} StunTimerWheel_t;
+
+/* Initializes an empty wheel at currentTick. The wheel must not be moved
+ * after this. */
+StunResult_t StunTimerWheel_Init( StunTimerWheel_t * pWheel,
+                                  uint64_t currentTick,
+                                  StunTimerCallback_t callback,
+                                  void * pCallbackContext );
+
+/* Arms a timer to expire delayTicks after the current tick (at least 1). An
+ * armed timer is re-armed. Timers must be zeroed before their first use. */
+StunResult_t StunTimerWheel_Arm( StunTimerWheel_t * pWheel,
+                                 StunTimer_t * pTimer,
+                                 uint64_t delayTicks );
+
+/* Disarms a timer, for example when the response to its request arrives.
+ * Does nothing if the timer is not armed. */
+StunResult_t StunTimerWheel_Cancel( StunTimerWheel_t * pWheel,
+                                    StunTimer_t * pTimer );
+
+/* Arms the retransmission timer of a request that was just sent for the first
+ * time. pMessage must stay valid until the transaction ends. */
+StunResult_t StunTimerWheel_StartTransaction( StunTimerWheel_t * pWheel,
+                                              StunTimer_t * pTimer,
+                                              const uint8_t * pMessage,
+                                              size_t messageLength,
+                                              uint64_t rtoTicks );
+
+/* Expires the timers due up to and including nowTicks and makes nowTicks the
+ * current tick. */
+StunResult_t StunTimerWheel_Advance( StunTimerWheel_t * pWheel,
+                                     uint64_t nowTicks );
+
+#endif /* STUN_TIMER_WHEEL_H */
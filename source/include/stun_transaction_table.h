@@ -0,0 +1,127 @@
+#ifndef STUN_TRANSACTION_TABLE_H
+#define STUN_TRANSACTION_TABLE_H
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stddef.h>
+
+/* API includes. */
+#include "stun_data_types.h"
+
+/*
+ * Table of outstanding client transactions, keyed by transaction ID.
+ *
+ * Matches a received response (for example, the transaction ID returned in
+ * StunHeader_t by StunDeserializer_Init) to the context of its request. The
+ * table is shared by any number of threads without locks (GCC or Clang
+ * only):
+ * - Entries are kept in groups of STUN_TRANSACTION_TABLE_GROUP_SIZE. Each
+ *   group starts with one tag byte per entry, made from the hash of the
+ *   transaction ID, and all the tags of a group are compared at once with
+ *   SSE2 or NEON. Below 7/8 full, a transaction ID is almost always found in
+ *   the first group it hashes to, with one tag compare and one key compare.
+ * - Each group counts the transactions that did not fit in it and went to a
+ *   later group. A lookup stops at the first group whose count is 0, so
+ *   misses only look at one group unless it overflowed, however many
+ *   transactions were removed before.
+ * - Entries are claimed and released with compare-and-swap on their tag.
+ * - A removed entry is only reused once no thread can still be reading it.
+ *   Threads announce when they use the table with the epoch they read at
+ *   the start (epoch-based reclamation). Each thread using the table gets an
+ *   index into the StunTransactionThread_t array given to
+ *   StunTransactionTable_Init.
+ *
+ * Lookup and Remove announce the calling thread themselves. A thread
+ * that keeps using a context returned by Lookup while other threads may
+ * remove it calls StunTransactionTable_Enter before the lookup and
+ * StunTransactionTable_Exit when done. A removed context can be freed once
+ * StunTransactionTable_IsReclaimable returns 1 for the epoch returned by
+ * StunTransactionTable_Remove.
+ */
+
+#define STUN_TRANSACTION_TABLE_GROUP_SIZE    16
+
+/* Number of consecutive groups looked at for a given transaction ID. Insert
+ * returns STUN_RESULT_OUT_OF_MEMORY when they are all in use. */
+#ifndef STUN_TRANSACTION_TABLE_PROBE_LENGTH
+    #define STUN_TRANSACTION_TABLE_PROBE_LENGTH    4
+#endif
+
+typedef struct StunTransactionEntry
+{
+    uint8_t transactionId[ STUN_HEADER_TRANSACTION_ID_LENGTH ];
+    void * pContext;
+    uint64_t retireEpoch; /* Epoch in which the entry was removed. */
+} StunTransactionEntry_t;
+
+typedef struct STUN_CACHE_LINE_ALIGNED StunTransactionGroup
+{
+    /* One tag byte per entry, kept in words so that they can be loaded
+     * together. */
+    uint64_t tagWords[ STUN_TRANSACTION_TABLE_GROUP_SIZE / sizeof( uint64_t ) ];
+    uint32_t overflowCount; /* Transactions stored in a later group of their probe sequence. */
+    StunTransactionEntry_t entries[ STUN_TRANSACTION_TABLE_GROUP_SIZE ];
+} StunTransactionGroup_t;
+
+/* One per thread using the table, each in its own cache line. */
+typedef struct STUN_CACHE_LINE_ALIGNED StunTransactionThread
+{
+    uint64_t epoch;   /* Epoch read when the thread started using the table, 0 when not using it. */
+    uint32_t nesting; /* Only used by the owning thread. */
+} StunTransactionThread_t;
+
+typedef struct StunTransactionTable
+{
+    StunTransactionGroup_t * pGroups;
+    size_t groupMask;
+    StunTransactionThread_t * pThreads;
+    size_t threadCount;
+    uint64_t epoch;
+} StunTransactionTable_t;
+
+/* Initializes a table over caller provided groups and threads. groupCount
+ * must be a power of 2. */
+StunResult_t StunTransactionTable_Init( StunTransactionTable_t * pTable,
+                                        StunTransactionGroup_t * pGroups,
+                                        size_t groupCount,
+                                        StunTransactionThread_t * pThreads,
+                                        size_t threadCount );
+
+/* Marks the thread as using the table until the matching
+ * StunTransactionTable_Exit. Calls can be nested. */
+StunResult_t StunTransactionTable_Enter( StunTransactionTable_t * pTable,
+                                         size_t threadIndex );
+
+StunResult_t StunTransactionTable_Exit( StunTransactionTable_t * pTable,
+                                        size_t threadIndex );
+
+/* Adds a transaction. The transaction ID is not checked for duplicates.
+ * Returns STUN_RESULT_OUT_OF_MEMORY when the groups it can go in are full,
+ * which includes removed entries that some thread may still be reading. */
+StunResult_t StunTransactionTable_Insert( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void * pContext );
+
+/* Finds the context of a transaction. Returns
+ * STUN_RESULT_TRANSACTION_NOT_FOUND if the transaction is not in the table. */
+StunResult_t StunTransactionTable_Lookup( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void ** ppContext );
+
+/* Removes a transaction and returns its context. When several threads remove
+ * the same transaction, for example on retransmitted responses, only one of
+ * them gets STUN_RESULT_OK. pRetireEpoch can be NULL. */
+StunResult_t StunTransactionTable_Remove( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void ** ppContext,
+                                          uint64_t * pRetireEpoch );
+
+/* Returns 1 if no thread can still be using what was removed in retireEpoch,
+ * 0 otherwise. */
+int StunTransactionTable_IsReclaimable( const StunTransactionTable_t * pTable,
+                                        uint64_t retireEpoch );
+
+#endif /* STUN_TRANSACTION_TABLE_H */
@@ -0,0 +1,231 @@
+/* Standard includes. */
+#include <string.h>
+
+#if defined( __SSE2__ )
+    #include <immintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+    #include <arm_neon.h>
+#endif
+
+/* API includes. */
+#include "stun_address.h"
+#include "stun_endianness.h"
+#include "stun_stats.h"
+
+/*-----------------------------------------------------------*/
+
+static int IsValidFamily( uint16_t family );
+
+static void XorAddressBytes( uint8_t * pDst,
+                             const uint8_t * pSrc,
+                             const uint8_t * pXorKey,
+                             uint16_t family );
+
+static void EncodeAddress( const uint8_t * pMessage,
+                           const StunAttributeAddress_t * pAddress,
+                           uint8_t isXorAddress,
+                           uint8_t * pValue );
+
+/*-----------------------------------------------------------*/
+
+static int IsValidFamily( uint16_t family )
+{
+    return ( family == STUN_ADDRESS_IPv4 ) || ( family == STUN_ADDRESS_IPv6 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* pXorKey is the magic cookie followed by the transaction ID. */
+static void XorAddressBytes( uint8_t * pDst,
+                             const uint8_t * pSrc,
+                             const uint8_t * pXorKey,
+                             uint16_t family )
+{
+    uint32_t word, keyWord;
+
+    #if !defined( __SSE2__ ) && !( defined( __ARM_NEON ) && defined( __aarch64__ ) )
+        uint64_t words[ 2 ], keyWords[ 2 ];
+    #endif
+
+    if( family == STUN_ADDRESS_IPv6 )
+    {
+        #if defined( __SSE2__ )
+            _mm_storeu_si128( ( __m128i * ) pDst,
+                              _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) pSrc ),
+                                             _mm_loadu_si128( ( const __m128i * ) pXorKey ) ) );
+        #elif defined( __ARM_NEON ) && defined( __aarch64__ )
+            vst1q_u8( pDst, veorq_u8( vld1q_u8( pSrc ), vld1q_u8( pXorKey ) ) );
+        #else
+            memcpy( ( void * ) &( words[ 0 ] ), ( const void * ) pSrc, sizeof( words ) );
+            memcpy( ( void * ) &( keyWords[ 0 ] ), ( const void * ) pXorKey, sizeof( keyWords ) );
+            words[ 0 ] ^= keyWords[ 0 ];
+            words[ 1 ] ^= keyWords[ 1 ];
+            memcpy( ( void * ) pDst, ( const void * ) &( words[ 0 ] ), sizeof( words ) );
+        #endif
+    }
+    else
+    {
+        memcpy( ( void * ) &( word ), ( const void * ) pSrc, sizeof( word ) );
+        memcpy( ( void * ) &( keyWord ), ( const void * ) pXorKey, sizeof( keyWord ) );
+        word ^= keyWord;
+        memcpy( ( void * ) pDst, ( const void * ) &( word ), sizeof( word ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void EncodeAddress( const uint8_t * pMessage,
+                           const StunAttributeAddress_t * pAddress,
+                           uint8_t isXorAddress,
+                           uint8_t * pValue )
+{
+    uint16_t port = pAddress->port;
+
+    Stun_WriteUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_FAMILY_OFFSET ] ),
+                      pAddress->family );
+
+    if( isXorAddress != 0 )
+    {
+        port ^= ( uint16_t ) ( STUN_HEADER_MAGIC_COOKIE >> 16 );
+
+        XorAddressBytes( &( pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
+                         &( pAddress->address[ 0 ] ),
+                         &( pMessage[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ),
+                         pAddress->family );
+    }
+    else
+    {
+        memcpy( ( void * ) &( pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
+                ( const void * ) &( pAddress->address[ 0 ] ),
+                STUN_ADDRESS_VALUE_LENGTH( pAddress->family ) - STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH );
+    }
+
+    Stun_WriteUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_PORT_OFFSET ] ),
+                      port );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunAddress_Encode( const uint8_t * pMessage,
+                                 const StunAttributeAddress_t * pAddress,
+                                 uint8_t isXorAddress,
+                                 uint8_t * pValue )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( ( pMessage == NULL ) && ( isXorAddress != 0 ) ) ||
+        ( pAddress == NULL ) ||
+        ( pValue == NULL ) ||
+        ( IsValidFamily( pAddress->family ) == 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        EncodeAddress( pMessage, pAddress, isXorAddress, pValue );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_ADDRESS_ENCODE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunAddress_Decode( const uint8_t * pMessage,
+                                 const uint8_t * pValue,
+                                 uint16_t valueLength,
+                                 uint8_t isXorAddress,
+                                 StunAttributeAddress_t * pAddress )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t family = 0, port;
+
+    if( ( ( pMessage == NULL ) && ( isXorAddress != 0 ) ) ||
+        ( pValue == NULL ) ||
+        ( pAddress == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( valueLength > STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH )
+        {
+            family = Stun_ReadUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_FAMILY_OFFSET ] ) );
+        }
+
+        if( ( IsValidFamily( family ) == 0 ) ||
+            ( valueLength != STUN_ADDRESS_VALUE_LENGTH( family ) ) )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        port = Stun_ReadUint16( &( pValue[ STUN_ATTRIBUTE_ADDRESS_PORT_OFFSET ] ) );
+
+        if( isXorAddress != 0 )
+        {
+            port ^= ( uint16_t ) ( STUN_HEADER_MAGIC_COOKIE >> 16 );
+
+            XorAddressBytes( &( pAddress->address[ 0 ] ),
+                             &( pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
+                             &( pMessage[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ),
+                             family );
+        }
+        else
+        {
+            memcpy( ( void * ) &( pAddress->address[ 0 ] ),
+                    ( const void * ) &( pValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
+                    valueLength - STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH );
+        }
+
+        pAddress->family = family;
+        pAddress->port = port;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_ADDRESS_DECODE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunAddress_EncodeBatch( uint8_t * const * ppMessages,
+                                      const StunAttributeAddress_t * pAddresses,
+                                      size_t count,
+                                      size_t valueOffset,
+                                      uint8_t isXorAddress )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t i;
+
+    if( ( ppMessages == NULL ) ||
+        ( pAddresses == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    for( i = 0; ( result == STUN_RESULT_OK ) && ( i < count ); i++ )
+    {
+        if( ( ppMessages[ i ] == NULL ) ||
+            ( IsValidFamily( pAddresses[ i ].family ) == 0 ) )
+        {
+            result = STUN_RESULT_BAD_PARAM;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        for( i = 0; i < count; i++ )
+        {
+            EncodeAddress( ppMessages[ i ],
+                           &( pAddresses[ i ] ),
+                           isXorAddress,
+                           &( ppMessages[ i ][ valueOffset ] ) );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_ADDRESS_ENCODE_BATCH, result );
+}
+
+/*-----------------------------------------------------------*/
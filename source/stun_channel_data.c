@@ -0,0 +1,117 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_channel_data.h"
+#include "stun_stats.h"
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunChannelData_Serialize( uint8_t * pBuffer,
+                                        size_t bufferLength,
+                                        uint16_t channelNumber,
+                                        uint16_t dataLength,
+                                        StunTransport_t transport,
+                                        size_t * pMessageLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t messageLength = STUN_CHANNEL_DATA_HEADER_LENGTH + ( size_t ) dataLength;
+    size_t paddedLength = STUN_CHANNEL_DATA_HEADER_LENGTH + STUN_ALIGN_SIZE_TO_WORD( ( size_t ) dataLength );
+
+    if( ( pBuffer == NULL ) ||
+        ( pMessageLength == NULL ) ||
+        ( channelNumber < STUN_CHANNEL_NUMBER_MIN ) ||
+        ( channelNumber > STUN_CHANNEL_NUMBER_MAX ) ||
+        ( ( transport != STUN_TRANSPORT_UDP ) &&
+          ( transport != STUN_TRANSPORT_TCP ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( transport == STUN_TRANSPORT_TCP )
+        {
+            messageLength = paddedLength;
+        }
+
+        if( bufferLength < messageLength )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        Stun_WriteUint16( &( pBuffer[ STUN_CHANNEL_DATA_CHANNEL_NUMBER_OFFSET ] ), channelNumber );
+        Stun_WriteUint16( &( pBuffer[ STUN_CHANNEL_DATA_LENGTH_OFFSET ] ), dataLength );
+
+        /* Zero the padding. Nothing is written when there is no padding. */
+        memset( ( void * ) &( pBuffer[ STUN_CHANNEL_DATA_HEADER_LENGTH + dataLength ] ),
+                0,
+                messageLength - STUN_CHANNEL_DATA_HEADER_LENGTH - dataLength );
+
+        *pMessageLength = messageLength;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CHANNEL_DATA_SERIALIZE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunChannelData_Deserialize( const uint8_t * pMessage,
+                                          size_t messageLength,
+                                          StunTransport_t transport,
+                                          StunChannelData_t * pChannelData )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t channelNumber = 0, dataLength = 0;
+    size_t minimumLength, paddedLength;
+
+    if( ( pMessage == NULL ) ||
+        ( pChannelData == NULL ) ||
+        ( ( transport != STUN_TRANSPORT_UDP ) &&
+          ( transport != STUN_TRANSPORT_TCP ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( ( messageLength < STUN_CHANNEL_DATA_HEADER_LENGTH ) ||
+             ( !STUN_FIRST_BYTE_IS_CHANNEL_DATA( pMessage[ 0 ] ) ) )
+    {
+        result = STUN_RESULT_INVALID_CHANNEL_DATA;
+    }
+    else
+    {
+        channelNumber = Stun_ReadUint16( &( pMessage[ STUN_CHANNEL_DATA_CHANNEL_NUMBER_OFFSET ] ) );
+        dataLength = Stun_ReadUint16( &( pMessage[ STUN_CHANNEL_DATA_LENGTH_OFFSET ] ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        minimumLength = STUN_CHANNEL_DATA_HEADER_LENGTH + ( size_t ) dataLength;
+        paddedLength = STUN_CHANNEL_DATA_HEADER_LENGTH + STUN_ALIGN_SIZE_TO_WORD( ( size_t ) dataLength );
+
+        if( transport == STUN_TRANSPORT_TCP )
+        {
+            /* Padding is mandatory. */
+            minimumLength = paddedLength;
+        }
+
+        if( ( messageLength < minimumLength ) ||
+            ( messageLength > paddedLength ) )
+        {
+            result = STUN_RESULT_INVALID_CHANNEL_DATA;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pChannelData->channelNumber = channelNumber;
+        pChannelData->pData = &( pMessage[ STUN_CHANNEL_DATA_VALUE_OFFSET ] );
+        pChannelData->dataLength = dataLength;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CHANNEL_DATA_DESERIALIZE, result );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,605 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_credential_cache.h"
+#include "stun_stats.h"
+
+#define STUN_MD5_BLOCK_LENGTH           64
+#define STUN_MD5_LENGTH_FIELD_SIZE      8
+
+/* Set in the hash of every used entry so that 0 means the entry is empty. */
+#define STUN_CREDENTIAL_CACHE_USED_BIT    0x80000000U
+
+#define STUN_MD5_ROTATE_LEFT( value, bits )    ( ( ( value ) << ( bits ) ) | ( ( value ) >> ( 32 - ( bits ) ) ) )
+
+/* The cache is shared between threads without locks on the read side, which
+ * needs the GCC/Clang atomic builtins. */
+#define STUN_ATOMIC_LOAD_RELAXED( pValue )              __atomic_load_n( ( pValue ), __ATOMIC_RELAXED )
+#define STUN_ATOMIC_LOAD_ACQUIRE( pValue )              __atomic_load_n( ( pValue ), __ATOMIC_ACQUIRE )
+#define STUN_ATOMIC_STORE_RELEASE( pValue, value )      __atomic_store_n( ( pValue ), ( value ), __ATOMIC_RELEASE )
+#define STUN_ATOMIC_COMPARE_EXCHANGE( pValue, pExpected, desired ) \
+    __atomic_compare_exchange_n( ( pValue ), ( pExpected ), ( desired ), 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED )
+#define STUN_ATOMIC_FENCE_ACQUIRE()                     __atomic_thread_fence( __ATOMIC_ACQUIRE )
+#define STUN_ATOMIC_FENCE_RELEASE()                     __atomic_thread_fence( __ATOMIC_RELEASE )
+
+typedef struct Md5Context
+{
+    uint32_t state[ 4 ];
+    uint64_t totalLength;
+    uint8_t block[ STUN_MD5_BLOCK_LENGTH ];
+    size_t blockLength;
+} Md5Context_t;
+
+/*-----------------------------------------------------------*/
+
+static void Md5Compress( uint32_t * pState,
+                         const uint8_t * pBlock );
+
+static void Md5Init( Md5Context_t * pMd5Ctx );
+
+static void Md5Update( Md5Context_t * pMd5Ctx,
+                       const uint8_t * pData,
+                       size_t dataLength );
+
+static void Md5Finish( Md5Context_t * pMd5Ctx,
+                       uint8_t * pDigest );
+
+static uint32_t HashIdentity( const uint8_t * pUsername,
+                              uint16_t usernameLength,
+                              const uint8_t * pRealm,
+                              uint16_t realmLength );
+
+static int EntryMatches( const StunCredentialCacheEntry_t * pEntry,
+                         uint32_t hash,
+                         const uint8_t * pUsername,
+                         uint16_t usernameLength,
+                         const uint8_t * pRealm,
+                         uint16_t realmLength );
+
+static uint32_t LockEntry( StunCredentialCacheEntry_t * pEntry );
+
+static void UnlockEntry( StunCredentialCacheEntry_t * pEntry,
+                         uint32_t sequence );
+
+/*-----------------------------------------------------------*/
+
+static const uint32_t md5Constants[ 64 ] =
+{
+    0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+    0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+    0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+    0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+    0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+    0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+    0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+    0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391
+};
+
+static const uint8_t md5Shifts[ 16 ] =
+{
+    7, 12, 17, 22,
+    5, 9,  14, 20,
+    4, 11, 16, 23,
+    6, 10, 15, 21
+};
+
+/*-----------------------------------------------------------*/
+
+static void Md5Compress( uint32_t * pState,
+                         const uint8_t * pBlock )
+{
+    uint32_t m[ 16 ];
+    uint32_t a, b, c, d, f, temp;
+    int i, g;
+
+    /* MD5 words are little endian. */
+    for( i = 0; i < 16; i++ )
+    {
+        m[ i ] = ( uint32_t ) pBlock[ i * 4 ] |
+                 ( ( uint32_t ) pBlock[ i * 4 + 1 ] << 8 ) |
+                 ( ( uint32_t ) pBlock[ i * 4 + 2 ] << 16 ) |
+                 ( ( uint32_t ) pBlock[ i * 4 + 3 ] << 24 );
+    }
+
+    a = pState[ 0 ];
+    b = pState[ 1 ];
+    c = pState[ 2 ];
+    d = pState[ 3 ];
+
+    for( i = 0; i < 64; i++ )
+    {
+        if( i < 16 )
+        {
+            f = ( b & c ) | ( ~b & d );
+            g = i;
+        }
+        else if( i < 32 )
+        {
+            f = ( d & b ) | ( ~d & c );
+            g = ( 5 * i + 1 ) & 15;
+        }
+        else if( i < 48 )
+        {
+            f = b ^ c ^ d;
+            g = ( 3 * i + 5 ) & 15;
+        }
+        else
+        {
+            f = c ^ ( b | ~d );
+            g = ( 7 * i ) & 15;
+        }
+
+        temp = d;
+        d = c;
+        c = b;
+        f = f + a + md5Constants[ i ] + m[ g ];
+        b = b + STUN_MD5_ROTATE_LEFT( f, md5Shifts[ ( ( i >> 4 ) << 2 ) | ( i & 3 ) ] );
+        a = temp;
+    }
+
+    pState[ 0 ] += a;
+    pState[ 1 ] += b;
+    pState[ 2 ] += c;
+    pState[ 3 ] += d;
+}
+
+/*-----------------------------------------------------------*/
+
+static void Md5Init( Md5Context_t * pMd5Ctx )
+{
+    pMd5Ctx->state[ 0 ] = 0x67452301;
+    pMd5Ctx->state[ 1 ] = 0xEFCDAB89;
+    pMd5Ctx->state[ 2 ] = 0x98BADCFE;
+    pMd5Ctx->state[ 3 ] = 0x10325476;
+    pMd5Ctx->totalLength = 0;
+    pMd5Ctx->blockLength = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void Md5Update( Md5Context_t * pMd5Ctx,
+                       const uint8_t * pData,
+                       size_t dataLength )
+{
+    size_t copyLength;
+
+    pMd5Ctx->totalLength += dataLength;
+
+    while( dataLength > 0 )
+    {
+        copyLength = STUN_MD5_BLOCK_LENGTH - pMd5Ctx->blockLength;
+
+        if( copyLength > dataLength )
+        {
+            copyLength = dataLength;
+        }
+
+        memcpy( ( void * ) &( pMd5Ctx->block[ pMd5Ctx->blockLength ] ), ( const void * ) pData, copyLength );
+        pMd5Ctx->blockLength += copyLength;
+        pData += copyLength;
+        dataLength -= copyLength;
+
+        if( pMd5Ctx->blockLength == STUN_MD5_BLOCK_LENGTH )
+        {
+            Md5Compress( &( pMd5Ctx->state[ 0 ] ), &( pMd5Ctx->block[ 0 ] ) );
+            pMd5Ctx->blockLength = 0;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void Md5Finish( Md5Context_t * pMd5Ctx,
+                       uint8_t * pDigest )
+{
+    uint64_t bitLength = pMd5Ctx->totalLength * 8;
+    int i;
+
+    pMd5Ctx->block[ pMd5Ctx->blockLength ] = 0x80;
+    pMd5Ctx->blockLength++;
+
+    if( pMd5Ctx->blockLength > STUN_MD5_BLOCK_LENGTH - STUN_MD5_LENGTH_FIELD_SIZE )
+    {
+        memset( ( void * ) &( pMd5Ctx->block[ pMd5Ctx->blockLength ] ), 0, STUN_MD5_BLOCK_LENGTH - pMd5Ctx->blockLength );
+        Md5Compress( &( pMd5Ctx->state[ 0 ] ), &( pMd5Ctx->block[ 0 ] ) );
+        pMd5Ctx->blockLength = 0;
+    }
+
+    memset( ( void * ) &( pMd5Ctx->block[ pMd5Ctx->blockLength ] ),
+            0,
+            STUN_MD5_BLOCK_LENGTH - STUN_MD5_LENGTH_FIELD_SIZE - pMd5Ctx->blockLength );
+
+    for( i = 0; i < STUN_MD5_LENGTH_FIELD_SIZE; i++ )
+    {
+        pMd5Ctx->block[ STUN_MD5_BLOCK_LENGTH - STUN_MD5_LENGTH_FIELD_SIZE + i ] = ( uint8_t ) ( bitLength >> ( 8 * i ) );
+    }
+
+    Md5Compress( &( pMd5Ctx->state[ 0 ] ), &( pMd5Ctx->block[ 0 ] ) );
+
+    for( i = 0; i < 16; i++ )
+    {
+        pDigest[ i ] = ( uint8_t ) ( pMd5Ctx->state[ i >> 2 ] >> ( 8 * ( i & 3 ) ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* FNV-1a over the username and the realm. */
+static uint32_t HashIdentity( const uint8_t * pUsername,
+                              uint16_t usernameLength,
+                              const uint8_t * pRealm,
+                              uint16_t realmLength )
+{
+    uint32_t hash = 0x811C9DC5;
+    uint16_t i;
+
+    for( i = 0; i < usernameLength; i++ )
+    {
+        hash = ( hash ^ pUsername[ i ] ) * 0x01000193;
+    }
+
+    /* Separate the two so that "ab" + "c" and "a" + "bc" differ. */
+    hash = ( hash ^ ':' ) * 0x01000193;
+
+    for( i = 0; i < realmLength; i++ )
+    {
+        hash = ( hash ^ pRealm[ i ] ) * 0x01000193;
+    }
+
+    return hash | STUN_CREDENTIAL_CACHE_USED_BIT;
+}
+
+/*-----------------------------------------------------------*/
+
+static int EntryMatches( const StunCredentialCacheEntry_t * pEntry,
+                         uint32_t hash,
+                         const uint8_t * pUsername,
+                         uint16_t usernameLength,
+                         const uint8_t * pRealm,
+                         uint16_t realmLength )
+{
+    /* Readers may see a half written entry here. The lengths are compared
+     * before the identity so that memcmp stays within the entry, and the
+     * caller discards the result if the sequence changed. */
+    return ( STUN_ATOMIC_LOAD_RELAXED( &( pEntry->hash ) ) == hash ) &&
+           ( STUN_ATOMIC_LOAD_RELAXED( &( pEntry->usernameLength ) ) == usernameLength ) &&
+           ( STUN_ATOMIC_LOAD_RELAXED( &( pEntry->realmLength ) ) == realmLength ) &&
+           ( memcmp( ( const void * ) &( pEntry->identity[ 0 ] ), ( const void * ) pUsername, usernameLength ) == 0 ) &&
+           ( memcmp( ( const void * ) &( pEntry->identity[ usernameLength ] ), ( const void * ) pRealm, realmLength ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t LockEntry( StunCredentialCacheEntry_t * pEntry )
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = STUN_ATOMIC_LOAD_RELAXED( &( pEntry->sequence ) );
+    } while( ( ( sequence & 1U ) != 0U ) ||
+             ( STUN_ATOMIC_COMPARE_EXCHANGE( &( pEntry->sequence ), &( sequence ), sequence + 1U ) == 0 ) );
+
+    /* Make the odd sequence visible before any change to the entry. */
+    STUN_ATOMIC_FENCE_RELEASE();
+
+    return sequence + 1U;
+}
+
+/*-----------------------------------------------------------*/
+
+static void UnlockEntry( StunCredentialCacheEntry_t * pEntry,
+                         uint32_t sequence )
+{
+    STUN_ATOMIC_STORE_RELEASE( &( pEntry->sequence ), sequence + 1U );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunCredential_ComputeLongTermKey( const uint8_t * pUsername,
+                                                uint16_t usernameLength,
+                                                const uint8_t * pRealm,
+                                                uint16_t realmLength,
+                                                const uint8_t * pPassword,
+                                                uint16_t passwordLength,
+                                                uint8_t * pLongTermKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    Md5Context_t md5Ctx;
+    const uint8_t separator = ':';
+
+    if( ( ( pUsername == NULL ) && ( usernameLength > 0 ) ) ||
+        ( ( pRealm == NULL ) && ( realmLength > 0 ) ) ||
+        ( ( pPassword == NULL ) && ( passwordLength > 0 ) ) ||
+        ( pLongTermKey == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        Md5Init( &( md5Ctx ) );
+        Md5Update( &( md5Ctx ), pUsername, usernameLength );
+        Md5Update( &( md5Ctx ), &( separator ), 1 );
+        Md5Update( &( md5Ctx ), pRealm, realmLength );
+        Md5Update( &( md5Ctx ), &( separator ), 1 );
+        Md5Update( &( md5Ctx ), pPassword, passwordLength );
+        Md5Finish( &( md5Ctx ), pLongTermKey );
+
+        /* The last block holds the end of the password. */
+        memset( ( void * ) &( md5Ctx ), 0, sizeof( md5Ctx ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CREDENTIAL_COMPUTE_LONG_TERM_KEY, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunCredentialCache_Init( StunCredentialCache_t * pCache,
+                                       StunCredentialCacheEntry_t * pEntries,
+                                       size_t entryCount )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCache == NULL ) ||
+        ( pEntries == NULL ) ||
+        ( entryCount == 0 ) ||
+        ( ( entryCount & ( entryCount - 1 ) ) != 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pEntries, 0, entryCount * sizeof( StunCredentialCacheEntry_t ) );
+
+        pCache->pEntries = pEntries;
+        pCache->entryMask = entryCount - 1;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CREDENTIAL_CACHE_INIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunCredentialCache_Insert( StunCredentialCache_t * pCache,
+                                         const uint8_t * pUsername,
+                                         uint16_t usernameLength,
+                                         const uint8_t * pRealm,
+                                         uint16_t realmLength,
+                                         const uint8_t * pPassword,
+                                         uint16_t passwordLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunCredentialCacheEntry_t * pEntry = NULL;
+    uint8_t longTermKey[ STUN_LONG_TERM_KEY_LENGTH ];
+    StunHmacKey_t hmacKey;
+    uint32_t hash = 0;
+    uint32_t sequences[ STUN_CREDENTIAL_CACHE_PROBE_LENGTH ];
+    size_t i, index, probeLength, wrappedLength, victimIndex = 0;
+    int found = 0;
+
+    if( ( pCache == NULL ) ||
+        ( pCache->pEntries == NULL ) ||
+        ( ( size_t ) usernameLength + realmLength > STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    /* Derive the keys before taking the entry locks. */
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunCredential_ComputeLongTermKey( pUsername,
+                                                    usernameLength,
+                                                    pRealm,
+                                                    realmLength,
+                                                    pPassword,
+                                                    passwordLength,
+                                                    &( longTermKey[ 0 ] ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_InitKey( &( hmacKey ), &( longTermKey[ 0 ] ), STUN_LONG_TERM_KEY_LENGTH );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        hash = HashIdentity( pUsername, usernameLength, pRealm, realmLength );
+
+        /* Probe each entry once, even in a cache smaller than the probe
+         * length. */
+        probeLength = STUN_CREDENTIAL_CACHE_PROBE_LENGTH;
+
+        if( probeLength > pCache->entryMask + 1 )
+        {
+            probeLength = pCache->entryMask + 1;
+        }
+
+        /* Lock all the probed entries, so that two inserts of the same
+         * credential cannot both miss each other and fill two entries. The
+         * entries are locked in increasing index order - the entries of the
+         * probe window that wrapped around to the start of the cache first -
+         * so that inserts with overlapping windows cannot deadlock. */
+        index = hash & pCache->entryMask;
+        wrappedLength = 0;
+
+        if( index + probeLength > pCache->entryMask + 1 )
+        {
+            wrappedLength = index + probeLength - ( pCache->entryMask + 1 );
+        }
+
+        for( i = 0; i < probeLength; i++ )
+        {
+            sequences[ ( i + probeLength - wrappedLength ) % probeLength ] =
+                LockEntry( &( pCache->pEntries[ ( hash + ( ( i + probeLength - wrappedLength ) % probeLength ) ) & pCache->entryMask ] ) );
+        }
+
+        /* Reuse the entry of the same credential, else an empty one, else
+         * evict the entry picked by the hash. */
+        victimIndex = ( hash + ( ( hash >> 16 ) % probeLength ) ) & pCache->entryMask;
+
+        for( i = 0; ( i < probeLength ) && ( found == 0 ); i++ )
+        {
+            index = ( hash + i ) & pCache->entryMask;
+
+            if( EntryMatches( &( pCache->pEntries[ index ] ), hash, pUsername, usernameLength, pRealm, realmLength ) != 0 )
+            {
+                victimIndex = index;
+                found = 1;
+            }
+            else if( ( pCache->pEntries[ index ].hash == 0 ) &&
+                     ( pEntry == NULL ) )
+            {
+                pEntry = &( pCache->pEntries[ index ] );
+            }
+        }
+
+        if( ( found != 0 ) || ( pEntry == NULL ) )
+        {
+            pEntry = &( pCache->pEntries[ victimIndex ] );
+        }
+
+        STUN_ATOMIC_STORE_RELEASE( &( pEntry->hash ), hash );
+        STUN_ATOMIC_STORE_RELEASE( &( pEntry->usernameLength ), usernameLength );
+        STUN_ATOMIC_STORE_RELEASE( &( pEntry->realmLength ), realmLength );
+        memcpy( ( void * ) &( pEntry->identity[ 0 ] ), ( const void * ) pUsername, usernameLength );
+        memcpy( ( void * ) &( pEntry->identity[ usernameLength ] ), ( const void * ) pRealm, realmLength );
+        memcpy( ( void * ) &( pEntry->longTermKey[ 0 ] ), ( const void * ) &( longTermKey[ 0 ] ), STUN_LONG_TERM_KEY_LENGTH );
+        memcpy( ( void * ) &( pEntry->hmacKey ), ( const void * ) &( hmacKey ), sizeof( hmacKey ) );
+
+        for( i = 0; i < probeLength; i++ )
+        {
+            UnlockEntry( &( pCache->pEntries[ ( hash + i ) & pCache->entryMask ] ), sequences[ i ] );
+        }
+
+        memset( ( void * ) &( longTermKey[ 0 ] ), 0, sizeof( longTermKey ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CREDENTIAL_CACHE_INSERT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunCredentialCache_Lookup( const StunCredentialCache_t * pCache,
+                                         const uint8_t * pUsername,
+                                         uint16_t usernameLength,
+                                         const uint8_t * pRealm,
+                                         uint16_t realmLength,
+                                         uint8_t * pLongTermKey,
+                                         StunHmacKey_t * pHmacKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const StunCredentialCacheEntry_t * pEntry;
+    uint32_t hash, sequence;
+    size_t i;
+    int matches = 0;
+
+    if( ( pCache == NULL ) ||
+        ( pCache->pEntries == NULL ) ||
+        ( ( pUsername == NULL ) && ( usernameLength > 0 ) ) ||
+        ( ( pRealm == NULL ) && ( realmLength > 0 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( ( size_t ) usernameLength + realmLength > STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH )
+    {
+        /* Never cached. */
+        result = STUN_RESULT_CREDENTIAL_NOT_FOUND;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        hash = HashIdentity( pUsername, usernameLength, pRealm, realmLength );
+
+        for( i = 0; ( i < STUN_CREDENTIAL_CACHE_PROBE_LENGTH ) && ( matches == 0 ); i++ )
+        {
+            pEntry = &( pCache->pEntries[ ( hash + i ) & pCache->entryMask ] );
+
+            /* Sequence lock read side: retry while a writer is active or if
+             * one was active while the entry was being read. */
+            do
+            {
+                sequence = STUN_ATOMIC_LOAD_ACQUIRE( &( pEntry->sequence ) );
+
+                if( ( sequence & 1U ) != 0U )
+                {
+                    continue;
+                }
+
+                matches = EntryMatches( pEntry, hash, pUsername, usernameLength, pRealm, realmLength );
+
+                if( matches != 0 )
+                {
+                    if( pLongTermKey != NULL )
+                    {
+                        memcpy( ( void * ) pLongTermKey, ( const void * ) &( pEntry->longTermKey[ 0 ] ), STUN_LONG_TERM_KEY_LENGTH );
+                    }
+
+                    if( pHmacKey != NULL )
+                    {
+                        memcpy( ( void * ) pHmacKey, ( const void * ) &( pEntry->hmacKey ), sizeof( StunHmacKey_t ) );
+                    }
+                }
+
+                STUN_ATOMIC_FENCE_ACQUIRE();
+            } while( ( ( sequence & 1U ) != 0U ) ||
+                     ( STUN_ATOMIC_LOAD_RELAXED( &( pEntry->sequence ) ) != sequence ) );
+        }
+
+        if( matches == 0 )
+        {
+            result = STUN_RESULT_CREDENTIAL_NOT_FOUND;
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CREDENTIAL_CACHE_LOOKUP, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunCredentialCache_Invalidate( StunCredentialCache_t * pCache,
+                                             const uint8_t * pUsername,
+                                             uint16_t usernameLength,
+                                             const uint8_t * pRealm,
+                                             uint16_t realmLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunCredentialCacheEntry_t * pEntry;
+    uint32_t hash, sequence;
+    size_t i;
+
+    if( ( pCache == NULL ) ||
+        ( pCache->pEntries == NULL ) ||
+        ( ( pUsername == NULL ) && ( usernameLength > 0 ) ) ||
+        ( ( pRealm == NULL ) && ( realmLength > 0 ) ) ||
+        ( ( size_t ) usernameLength + realmLength > STUN_CREDENTIAL_CACHE_MAX_IDENTITY_LENGTH ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        hash = HashIdentity( pUsername, usernameLength, pRealm, realmLength );
+
+        for( i = 0; i < STUN_CREDENTIAL_CACHE_PROBE_LENGTH; i++ )
+        {
+            pEntry = &( pCache->pEntries[ ( hash + i ) & pCache->entryMask ] );
+            sequence = LockEntry( pEntry );
+
+            if( EntryMatches( pEntry, hash, pUsername, usernameLength, pRealm, realmLength ) != 0 )
+            {
+                STUN_ATOMIC_STORE_RELEASE( &( pEntry->hash ), 0U );
+                memset( ( void * ) &( pEntry->longTermKey[ 0 ] ), 0, STUN_LONG_TERM_KEY_LENGTH );
+                memset( ( void * ) &( pEntry->hmacKey ), 0, sizeof( StunHmacKey_t ) );
+            }
+
+            UnlockEntry( pEntry, sequence );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_CREDENTIAL_CACHE_INVALIDATE, result );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,189 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_demux.h"
+#include "stun_stats.h"
+
+/* Number of packets ahead of the current one to prefetch in
+ * StunDemux_ClassifyBatch. */
+#ifndef STUN_DEMUX_PREFETCH_DISTANCE
+    #define STUN_DEMUX_PREFETCH_DISTANCE    4
+#endif
+
+#if defined( __GNUC__ )
+    #define STUN_PREFETCH( pAddress )    __builtin_prefetch( ( pAddress ), 0, 3 )
+#else
+    #define STUN_PREFETCH( pAddress )
+#endif
+
+/* Short names for the table. */
+#define UNK    STUN_PROTOCOL_UNKNOWN
+#define STN    STUN_PROTOCOL_STUN
+#define ZRT    STUN_PROTOCOL_ZRTP
+#define DTL    STUN_PROTOCOL_DTLS
+#define TRN    STUN_PROTOCOL_TURN_CHANNEL
+#define RTP    STUN_PROTOCOL_RTP
+
+/*-----------------------------------------------------------*/
+
+static int IsValidStunHeader( const uint8_t * pPacket,
+                              size_t packetLength );
+
+static void FillStunHeader( const uint8_t * pPacket,
+                            StunHeader_t * pStunHeader );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Protocol of a packet by its first byte, from RFC 7983 Section 7:
+ *
+ *   [0..3]     -> STUN, as STUN_FIRST_BYTE_IS_DEMUXED_STUN
+ *   [16..19]   -> ZRTP
+ *   [20..63]   -> DTLS
+ *   [64..79]   -> TURN Channel, as STUN_FIRST_BYTE_IS_CHANNEL_DATA
+ *   [128..191] -> RTP/RTCP
+ *
+ * Everything else is dropped.
+ */
+static const uint8_t protocolTable[ 256 ] =
+{
+    STN, STN, STN, STN, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /*   0 -  15 */
+    ZRT, ZRT, ZRT, ZRT, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, /*  16 -  31 */
+    DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, /*  32 -  47 */
+    DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, DTL, /*  48 -  63 */
+    TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, TRN, /*  64 -  79 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /*  80 -  95 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /*  96 - 111 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /* 112 - 127 */
+    RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, /* 128 - 143 */
+    RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, /* 144 - 159 */
+    RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, /* 160 - 175 */
+    RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, RTP, /* 176 - 191 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /* 192 - 207 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /* 208 - 223 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, /* 224 - 239 */
+    UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK, UNK  /* 240 - 255 */
+};
+
+/*-----------------------------------------------------------*/
+
+/* The same checks as StunDeserializer_Init and
+ * StunDeserializer_ClassifyBatch. */
+static int IsValidStunHeader( const uint8_t * pPacket,
+                              size_t packetLength )
+{
+    return ( packetLength >= STUN_HEADER_LENGTH ) &&
+           ( Stun_ReadUint32( &( pPacket[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) == STUN_HEADER_MAGIC_COOKIE ) &&
+           ( ( ( size_t ) Stun_ReadUint16( &( pPacket[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) ) + STUN_HEADER_LENGTH ) == packetLength );
+}
+
+/*-----------------------------------------------------------*/
+
+static void FillStunHeader( const uint8_t * pPacket,
+                            StunHeader_t * pStunHeader )
+{
+    pStunHeader->messageType = ( StunMessageType_t ) Stun_ReadUint16( pPacket );
+    pStunHeader->pTransactionId = ( uint8_t * ) &( pPacket[ STUN_HEADER_TRANSACTION_ID_OFFSET ] );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDemux_Classify( const uint8_t * pPacket,
+                                 size_t packetLength,
+                                 StunProtocol_t * pProtocol,
+                                 StunHeader_t * pStunHeader )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunProtocol_t protocol = STUN_PROTOCOL_UNKNOWN;
+
+    if( ( ( pPacket == NULL ) && ( packetLength > 0 ) ) ||
+        ( pProtocol == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( packetLength > 0 ) )
+    {
+        protocol = ( StunProtocol_t ) protocolTable[ pPacket[ 0 ] ];
+
+        if( protocol == STUN_PROTOCOL_STUN )
+        {
+            if( IsValidStunHeader( pPacket, packetLength ) == 0 )
+            {
+                protocol = STUN_PROTOCOL_UNKNOWN;
+            }
+            else if( pStunHeader != NULL )
+            {
+                FillStunHeader( pPacket, pStunHeader );
+            }
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        *pProtocol = protocol;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DEMUX_CLASSIFY, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDemux_ClassifyBatch( const uint8_t * const * ppPackets,
+                                      const size_t * pPacketLengths,
+                                      size_t packetCount,
+                                      StunProtocol_t * pProtocols,
+                                      StunHeader_t * pStunHeaders )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunProtocol_t protocol;
+    const uint8_t * pPacket;
+    size_t i;
+
+    if( ( ppPackets == NULL ) ||
+        ( pPacketLengths == NULL ) ||
+        ( pProtocols == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    for( i = 0; ( result == STUN_RESULT_OK ) && ( i < packetCount ); i++ )
+    {
+        /* Most packets only need their first byte, which is likely not in the
+         * cache yet. */
+        if( ( i + STUN_DEMUX_PREFETCH_DISTANCE < packetCount ) &&
+            ( ppPackets[ i + STUN_DEMUX_PREFETCH_DISTANCE ] != NULL ) )
+        {
+            STUN_PREFETCH( ppPackets[ i + STUN_DEMUX_PREFETCH_DISTANCE ] );
+        }
+
+        pPacket = ppPackets[ i ];
+        protocol = STUN_PROTOCOL_UNKNOWN;
+
+        if( ( pPacket != NULL ) &&
+            ( pPacketLengths[ i ] > 0 ) )
+        {
+            protocol = ( StunProtocol_t ) protocolTable[ pPacket[ 0 ] ];
+
+            if( protocol == STUN_PROTOCOL_STUN )
+            {
+                if( IsValidStunHeader( pPacket, pPacketLengths[ i ] ) == 0 )
+                {
+                    protocol = STUN_PROTOCOL_UNKNOWN;
+                }
+                else if( pStunHeaders != NULL )
+                {
+                    FillStunHeader( pPacket, &( pStunHeaders[ i ] ) );
+                }
+            }
+        }
+
+        pProtocols[ i ] = protocol;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DEMUX_CLASSIFY_BATCH, result );
+}
+
+/*-----------------------------------------------------------*/
@@ -4,18 +4,102 @@
 
 /* API includes. */
 #include "stun_deserializer.h"
+#include "stun_address.h"
+#include "stun_crc32.h"
+#include "stun_hmac_sha1.h"
+#include "stun_stats.h"
 
 /* Read/Write macros. */
-#define STUN_WRITE_UINT16   ( pCtx->readWriteFunctions.writeUint16Fn )
-#define STUN_WRITE_UINT32   ( pCtx->readWriteFunctions.writeUint32Fn )
-#define STUN_WRITE_UINT64   ( pCtx->readWriteFunctions.writeUint64Fn )
-#define STUN_READ_UINT16    ( pCtx->readWriteFunctions.readUint16Fn )
-#define STUN_READ_UINT32    ( pCtx->readWriteFunctions.readUint32Fn )
-#define STUN_READ_UINT64    ( pCtx->readWriteFunctions.readUint64Fn )
+#if defined( STUN_COMPILE_TIME_ENDIANNESS )
+    #define STUN_WRITE_UINT16   Stun_WriteUint16
+    #define STUN_WRITE_UINT32   Stun_WriteUint32
+    #define STUN_WRITE_UINT64   Stun_WriteUint64
+    #define STUN_READ_UINT16    Stun_ReadUint16
+    #define STUN_READ_UINT32    Stun_ReadUint32
+    #define STUN_READ_UINT64    Stun_ReadUint64
+#else
+    #define STUN_WRITE_UINT16   ( pCtx->readWriteFunctions.writeUint16Fn )
+    #define STUN_WRITE_UINT32   ( pCtx->readWriteFunctions.writeUint32Fn )
+    #define STUN_WRITE_UINT64   ( pCtx->readWriteFunctions.writeUint64Fn )
+    #define STUN_READ_UINT16    ( pCtx->readWriteFunctions.readUint16Fn )
+    #define STUN_READ_UINT32    ( pCtx->readWriteFunctions.readUint32Fn )
+    #define STUN_READ_UINT64    ( pCtx->readWriteFunctions.readUint64Fn )
+#endif
+
+/* How StunDeserializer_ParseAll decodes the value of each attribute slot. */
+typedef enum StunAttributeValueKind
+{
+    STUN_ATTRIBUTE_VALUE_KIND_RAW = 0,
+    STUN_ATTRIBUTE_VALUE_KIND_UINT32,
+    STUN_ATTRIBUTE_VALUE_KIND_UINT64,
+    STUN_ATTRIBUTE_VALUE_KIND_CHANNEL_NUMBER,
+    STUN_ATTRIBUTE_VALUE_KIND_ERROR_CODE,
+    STUN_ATTRIBUTE_VALUE_KIND_ADDRESS,
+    STUN_ATTRIBUTE_VALUE_KIND_XOR_ADDRESS
+} StunAttributeValueKind_t;
+
+/* STUN_DECODED_FLAG_* of the attributes held in StunDecodedMessage_t, per
+ * attribute slot. */
+static const uint16_t decodedFlags[ STUN_ATTRIBUTE_SLOT_COUNT ] =
+{
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_PRIORITY ) ]            = STUN_DECODED_FLAG_PRIORITY,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING ) ]     = STUN_DECODED_FLAG_ICE_CONTROLLING,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED ) ]      = STUN_DECODED_FLAG_ICE_CONTROLLED,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_USE_CANDIDATE ) ]       = STUN_DECODED_FLAG_USE_CANDIDATE,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_USERNAME ) ]            = STUN_DECODED_FLAG_USERNAME,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) ]  = STUN_DECODED_FLAG_XOR_MAPPED_ADDRESS,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) ]    = STUN_DECODED_FLAG_XOR_PEER_ADDRESS,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) ] = STUN_DECODED_FLAG_XOR_RELAYED_ADDRESS,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_LIFETIME ) ]            = STUN_DECODED_FLAG_LIFETIME,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_ERROR_CODE ) ]          = STUN_DECODED_FLAG_ERROR_CODE,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_NONCE ) ]               = STUN_DECODED_FLAG_NONCE,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_REALM ) ]               = STUN_DECODED_FLAG_REALM,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY ) ]   = STUN_DECODED_FLAG_MESSAGE_INTEGRITY,
+    [ STUN_ATTRIBUTE_TYPE_TO_SLOT( STUN_ATTRIBUTE_TYPE_FINGERPRINT ) ]         = STUN_DECODED_FLAG_FINGERPRINT,
+};
 
 /*-----------------------------------------------------------*/
 
 /* Static Functions. */
+static StunResult_t InitMessage( StunContext_t * pCtx,
+                                 uint8_t * pStunMessage,
+                                 size_t stunMessageLength,
+                                 StunHeader_t * pStunHeader );
+
+static StunResult_t ReadNextAttribute( StunContext_t * pCtx,
+                                       StunAttribute_t * pAttribute );
+
+static void CountMessage( const StunHeader_t * pStunHeader,
+                          size_t stunMessageLength );
+
+static void CountAttribute( StunResult_t result,
+                            const StunAttribute_t * pAttribute );
+
+static StunResult_t FindAttributeInstance( StunContext_t * pCtx,
+                                           StunAttributeType_t attributeType,
+                                           uint16_t instance,
+                                           StunAttribute_t * pAttribute );
+
+static uint8_t GetAttributeValueKind( StunAttributeType_t attributeType );
+
+static StunResult_t DecodeAttributeValue( const StunContext_t * pCtx,
+                                          const StunAttribute_t * pAttribute,
+                                          uint8_t valueKind,
+                                          StunAttributeValue_t * pValue );
+
+static StunResult_t DecodeMessageAttribute( const StunContext_t * pCtx,
+                                            const StunAttribute_t * pAttribute,
+                                            size_t attributeOffset,
+                                            StunDecodedMessage_t * pDecoded );
+
+static StunResult_t GetVerificationSpan( const StunContext_t * pCtx,
+                                         size_t attributeEnd,
+                                         uint16_t attributeValueLength,
+                                         StunVerificationSpan_t * pSpan );
+
+static void RecordUnknownAttribute( StunUnknownAttributes_t * pUnknownAttributes,
+                                    uint16_t attributeType );
+
 static StunResult_t ParseAttributeUint32( const StunContext_t * pCtx,
                                           const StunAttribute_t * pAttribute,
                                           uint32_t * pVal,
@@ -26,6 +110,350 @@ static StunResult_t ParseAttributeUint64( const StunContext_t * pCtx,
                                           uint64_t * pVal,
                                           StunAttributeType_t attributeType );
 
+static void FillAttributeFromIndex( const StunContext_t * pCtx,
+                                    const StunAttributeIndexEntry_t * pEntry,
+                                    StunAttribute_t * pAttribute );
+
+static StunResult_t FindAttributeInIndex( const StunContext_t * pCtx,
+                                          StunAttributeType_t attributeType,
+                                          uint16_t instance,
+                                          StunAttribute_t * pAttribute );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t GetAttributeValueKind( StunAttributeType_t attributeType )
+{
+    uint8_t valueKind = STUN_ATTRIBUTE_VALUE_KIND_RAW;
+
+    switch( attributeType )
+    {
+        case STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST:
+        case STUN_ATTRIBUTE_TYPE_LIFETIME:
+        case STUN_ATTRIBUTE_TYPE_PRIORITY:
+        case STUN_ATTRIBUTE_TYPE_FINGERPRINT:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_UINT32;
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_RESERVATION_TOKEN:
+        case STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED:
+        case STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_UINT64;
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_CHANNEL_NUMBER:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_CHANNEL_NUMBER;
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_ERROR_CODE:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_ERROR_CODE;
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_REFLECTED_FROM:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_ADDRESS;
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS:
+            valueKind = STUN_ATTRIBUTE_VALUE_KIND_XOR_ADDRESS;
+            break;
+
+        default:
+            /* Raw value only. */
+            break;
+    }
+
+    return valueKind;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Decodes a value without the type and pointer checks of the
+ * StunDeserializer_ParseAttribute* APIs, as the attribute comes straight from
+ * the walk in StunDeserializer_ParseAll. Uses the inline accessors whatever
+ * the byte order mode, so that decoding takes no indirect call. */
+static StunResult_t DecodeAttributeValue( const StunContext_t * pCtx,
+                                          const StunAttribute_t * pAttribute,
+                                          uint8_t valueKind,
+                                          StunAttributeValue_t * pValue )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t length = pAttribute->attributeValueLength;
+
+    switch( valueKind )
+    {
+        case STUN_ATTRIBUTE_VALUE_KIND_UINT32:
+            if( length != sizeof( uint32_t ) )
+            {
+                result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+            }
+            else
+            {
+                pValue->uint32Value = Stun_ReadUint32( &( pAttribute->pAttributeValue[ 0 ] ) );
+            }
+            break;
+
+        case STUN_ATTRIBUTE_VALUE_KIND_UINT64:
+            if( length != sizeof( uint64_t ) )
+            {
+                result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+            }
+            else
+            {
+                pValue->uint64Value = Stun_ReadUint64( &( pAttribute->pAttributeValue[ 0 ] ) );
+            }
+            break;
+
+        case STUN_ATTRIBUTE_VALUE_KIND_CHANNEL_NUMBER:
+            if( length != STUN_ATTRIBUTE_CHANNEL_NUMBER_LENGTH )
+            {
+                result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+            }
+            else
+            {
+                pValue->channelNumber = Stun_ReadUint16( &( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_CHANNEL_NUMBER_OFFSET ] ) );
+            }
+            break;
+
+        case STUN_ATTRIBUTE_VALUE_KIND_ERROR_CODE:
+            if( length < STUN_ATTRIBUTE_ERROR_CODE_HEADER_LENGTH )
+            {
+                result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+            }
+            else
+            {
+                pValue->error.errorCode = STUN_GET_ERROR( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ERROR_CODE_CLASS_OFFSET ],
+                                                          pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ERROR_CODE_NUMBER_OFFSET ] );
+                pValue->error.pErrorPhrase = &( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ERROR_CODE_REASON_PHRASE_OFFSET ] );
+                pValue->error.errorPhraseLength = length - STUN_ATTRIBUTE_ERROR_CODE_HEADER_LENGTH;
+            }
+            break;
+
+        case STUN_ATTRIBUTE_VALUE_KIND_ADDRESS:
+        case STUN_ATTRIBUTE_VALUE_KIND_XOR_ADDRESS:
+            result = StunAddress_Decode( pCtx->pStart,
+                                         pAttribute->pAttributeValue,
+                                         length,
+                                         ( valueKind == STUN_ATTRIBUTE_VALUE_KIND_XOR_ADDRESS ),
+                                         &( pValue->address ) );
+            break;
+
+        default:
+            /* Raw value only. */
+            break;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static void RecordUnknownAttribute( StunUnknownAttributes_t * pUnknownAttributes,
+                                    uint16_t attributeType )
+{
+    uint16_t i;
+    int isKnown = 0;
+
+    if( attributeType < 64U )
+    {
+        isKnown = ( ( pUnknownAttributes->knownTypes & STUN_ATTRIBUTE_TYPE_BIT( attributeType ) ) != 0 );
+    }
+
+    for( i = 0; ( isKnown == 0 ) && ( i < pUnknownAttributes->count ); i++ )
+    {
+        /* Already listed. */
+        isKnown = ( pUnknownAttributes->attributeTypes[ i ] == attributeType );
+    }
+
+    if( ( isKnown == 0 ) &&
+        ( pUnknownAttributes->count < STUN_UNKNOWN_ATTRIBUTES_MAX_COUNT ) )
+    {
+        pUnknownAttributes->attributeTypes[ pUnknownAttributes->count ] = attributeType;
+        pUnknownAttributes->count++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The MESSAGE-INTEGRITY and FINGERPRINT values cover the message up to the
+ * attribute ending at attributeEnd, with the length in the header set as if
+ * the message ended with that attribute. Used by both the Verify and the
+ * Get*Span APIs. */
+static StunResult_t GetVerificationSpan( const StunContext_t * pCtx,
+                                         size_t attributeEnd,
+                                         uint16_t attributeValueLength,
+                                         StunVerificationSpan_t * pSpan )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t attributeOffset;
+
+    if( attributeEnd < ( STUN_HEADER_LENGTH + STUN_ATTRIBUTE_TOTAL_LENGTH( ( size_t ) attributeValueLength ) ) )
+    {
+        result = STUN_RESULT_INVALID_ATTRIBUTE_ORDER;
+    }
+    else if( attributeEnd > pCtx->totalLength )
+    {
+        result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+    }
+    else
+    {
+        attributeOffset = attributeEnd - STUN_ATTRIBUTE_TOTAL_LENGTH( ( size_t ) attributeValueLength );
+
+        pSpan->messageLength = ( uint16_t ) ( attributeEnd - STUN_HEADER_LENGTH );
+
+        memcpy( ( void * ) &( pSpan->header[ 0 ] ),
+                ( const void * ) pCtx->pStart,
+                STUN_HEADER_LENGTH );
+        Stun_WriteUint16( &( pSpan->header[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                          pSpan->messageLength );
+
+        pSpan->pBody = &( pCtx->pStart[ STUN_HEADER_LENGTH ] );
+        pSpan->bodyLength = attributeOffset - STUN_HEADER_LENGTH;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Stores the first instance of every attribute that StunDecodedMessage_t
+ * holds and ignores the others. attributeOffset is the offset of the
+ * attribute header, as the value pointer is NULL for an empty attribute. One
+ * table lookup tells if the attribute is held and one switch decodes it
+ * straight into pDecoded, with the inline accessors. */
+static StunResult_t DecodeMessageAttribute( const StunContext_t * pCtx,
+                                            const StunAttribute_t * pAttribute,
+                                            size_t attributeOffset,
+                                            StunDecodedMessage_t * pDecoded )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const uint8_t * pValue = pAttribute->pAttributeValue;
+    uint16_t length = pAttribute->attributeValueLength;
+    uint32_t flag, seenMask;
+
+    /* None of them is in the shared slot. */
+    flag = decodedFlags[ STUN_ATTRIBUTE_TYPE_TO_SLOT( pAttribute->attributeType ) ];
+
+    /* Only the offsets of these two are recorded, so check their length on
+     * every instance as the callers verify them from the offset alone. */
+    if( ( ( flag == STUN_DECODED_FLAG_MESSAGE_INTEGRITY ) && ( length != STUN_HMAC_VALUE_LENGTH ) ) ||
+        ( ( flag == STUN_DECODED_FLAG_FINGERPRINT ) && ( length != STUN_ATTRIBUTE_FINGERPRINT_LENGTH ) ) )
+    {
+        result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+    }
+
+    /* Both ICE roles share the tie-breaker, so only the first of them is
+     * kept. */
+    seenMask = ( ( flag & ( STUN_DECODED_FLAG_ICE_CONTROLLING | STUN_DECODED_FLAG_ICE_CONTROLLED ) ) != 0 ) ?
+               ( STUN_DECODED_FLAG_ICE_CONTROLLING | STUN_DECODED_FLAG_ICE_CONTROLLED ) : flag;
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( flag != 0 ) &&
+        ( ( pDecoded->presentAttributes & seenMask ) == 0 ) )
+    {
+        switch( flag )
+        {
+            case STUN_DECODED_FLAG_PRIORITY:
+            case STUN_DECODED_FLAG_LIFETIME:
+
+                if( length != sizeof( uint32_t ) )
+                {
+                    result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+                }
+                else if( flag == STUN_DECODED_FLAG_PRIORITY )
+                {
+                    pDecoded->priority = Stun_ReadUint32( pValue );
+                }
+                else
+                {
+                    pDecoded->lifetime = Stun_ReadUint32( pValue );
+                }
+
+                break;
+
+            case STUN_DECODED_FLAG_ICE_CONTROLLING:
+            case STUN_DECODED_FLAG_ICE_CONTROLLED:
+
+                if( length != sizeof( uint64_t ) )
+                {
+                    result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+                }
+                else
+                {
+                    pDecoded->tieBreaker = Stun_ReadUint64( pValue );
+                }
+
+                break;
+
+            case STUN_DECODED_FLAG_USERNAME:
+                pDecoded->pUsername = pAttribute->pAttributeValue;
+                pDecoded->usernameLength = length;
+                break;
+
+            case STUN_DECODED_FLAG_NONCE:
+                pDecoded->pNonce = pAttribute->pAttributeValue;
+                pDecoded->nonceLength = length;
+                break;
+
+            case STUN_DECODED_FLAG_REALM:
+                pDecoded->pRealm = pAttribute->pAttributeValue;
+                pDecoded->realmLength = length;
+                break;
+
+            case STUN_DECODED_FLAG_XOR_MAPPED_ADDRESS:
+                result = StunAddress_Decode( pCtx->pStart, pValue, length, 1, &( pDecoded->xorMappedAddress ) );
+                break;
+
+            case STUN_DECODED_FLAG_XOR_PEER_ADDRESS:
+                result = StunAddress_Decode( pCtx->pStart, pValue, length, 1, &( pDecoded->xorPeerAddress ) );
+                break;
+
+            case STUN_DECODED_FLAG_XOR_RELAYED_ADDRESS:
+                result = StunAddress_Decode( pCtx->pStart, pValue, length, 1, &( pDecoded->xorRelayedAddress ) );
+                break;
+
+            case STUN_DECODED_FLAG_ERROR_CODE:
+
+                if( length < STUN_ATTRIBUTE_ERROR_CODE_HEADER_LENGTH )
+                {
+                    result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+                }
+                else
+                {
+                    pDecoded->errorCode = STUN_GET_ERROR( pValue[ STUN_ATTRIBUTE_ERROR_CODE_CLASS_OFFSET ],
+                                                          pValue[ STUN_ATTRIBUTE_ERROR_CODE_NUMBER_OFFSET ] );
+                    pDecoded->pErrorPhrase = &( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ERROR_CODE_REASON_PHRASE_OFFSET ] );
+                    pDecoded->errorPhraseLength = length - STUN_ATTRIBUTE_ERROR_CODE_HEADER_LENGTH;
+                }
+
+                break;
+
+            case STUN_DECODED_FLAG_MESSAGE_INTEGRITY:
+                pDecoded->integrityOffset = ( uint32_t ) attributeOffset;
+                break;
+
+            case STUN_DECODED_FLAG_FINGERPRINT:
+                pDecoded->fingerprintOffset = ( uint32_t ) attributeOffset;
+                break;
+
+            default:
+                /* USE-CANDIDATE has no value. */
+                break;
+        }
+
+        if( result == STUN_RESULT_OK )
+        {
+            pDecoded->presentAttributes |= flag;
+        }
+    }
+
+    return result;
+}
+
 /*-----------------------------------------------------------*/
 
 static StunResult_t ParseAttributeUint32( const StunContext_t * pCtx,
@@ -35,6 +463,11 @@ static StunResult_t ParseAttributeUint32( const StunContext_t * pCtx,
 {
     StunResult_t result = STUN_RESULT_OK;
 
+    #if defined( STUN_COMPILE_TIME_ENDIANNESS )
+        /* The context only holds the read functions. */
+        ( void ) pCtx;
+    #endif
+
     if( ( pAttribute == NULL ) ||
         ( pVal == NULL ) ||
         ( pAttribute->attributeType != attributeType ) ||
@@ -68,6 +501,11 @@ static StunResult_t ParseAttributeUint64( const StunContext_t * pCtx,
 {
     StunResult_t result = STUN_RESULT_OK;
 
+    #if defined( STUN_COMPILE_TIME_ENDIANNESS )
+        /* The context only holds the read functions. */
+        ( void ) pCtx;
+    #endif
+
     if( ( pAttribute == NULL ) ||
         ( pVal == NULL ) ||
         ( pAttribute->attributeType != attributeType ) ||
@@ -94,10 +532,76 @@ static StunResult_t ParseAttributeUint64( const StunContext_t * pCtx,
 
 /*-----------------------------------------------------------*/
 
-StunResult_t StunDeserializer_Init( StunContext_t * pCtx,
-                                    uint8_t * pStunMessage,
-                                    size_t stunMessageLength,
-                                    StunHeader_t * pStunHeader )
+static void FillAttributeFromIndex( const StunContext_t * pCtx,
+                                    const StunAttributeIndexEntry_t * pEntry,
+                                    StunAttribute_t * pAttribute )
+{
+    pAttribute->attributeType = ( StunAttributeType_t ) pEntry->attributeType;
+    pAttribute->attributeValueLength = pEntry->attributeValueLength;
+
+    if( pEntry->attributeValueLength > 0 )
+    {
+        pAttribute->pAttributeValue = &( pCtx->pStart[ pEntry->attributeValueOffset ] );
+    }
+    else
+    {
+        pAttribute->pAttributeValue = NULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t FindAttributeInIndex( const StunContext_t * pCtx,
+                                          StunAttributeType_t attributeType,
+                                          uint16_t instance,
+                                          StunAttribute_t * pAttribute )
+{
+    StunResult_t result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+    const StunAttributeIndex_t * pIndex = pCtx->pAttributeIndex;
+    const StunAttributeIndexEntry_t * pEntry;
+    uint16_t remaining = instance;
+    uint8_t slot, entry = 0;
+
+    slot = STUN_ATTRIBUTE_TYPE_TO_SLOT( attributeType );
+
+    if( STUN_ATTRIBUTE_SLOT_IS_SET( pIndex->usedSlots, slot ) )
+    {
+        entry = pIndex->firstEntry[ slot ];
+    }
+
+    /* All the entries in a slot other than STUN_ATTRIBUTE_SLOT_OTHER have the
+     * same type and therefore, the first entry is the one we are looking for
+     * unless the caller wants a repeated attribute. */
+    while( entry != 0 )
+    {
+        pEntry = &( pIndex->entries[ entry - 1 ] );
+
+        if( pEntry->attributeType == ( uint16_t ) attributeType )
+        {
+            if( remaining == 0 )
+            {
+                FillAttributeFromIndex( pCtx, pEntry, pAttribute );
+                result = STUN_RESULT_OK;
+                break;
+            }
+
+            remaining--;
+        }
+
+        entry = pEntry->nextEntry;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* StunDeserializer_Init without the counting, for the APIs that walk a
+ * message again on a local context. */
+static StunResult_t InitMessage( StunContext_t * pCtx,
+                                 uint8_t * pStunMessage,
+                                 size_t stunMessageLength,
+                                 StunHeader_t * pStunHeader )
 {
     StunResult_t result = STUN_RESULT_OK;
     uint32_t magicCookie;
@@ -113,12 +617,18 @@ StunResult_t StunDeserializer_Init( StunContext_t * pCtx,
 
     if( result == STUN_RESULT_OK )
     {
-        Stun_InitReadWriteFunctions( &( pCtx->readWriteFunctions ) );
+        #if !defined( STUN_COMPILE_TIME_ENDIANNESS )
+            Stun_InitReadWriteFunctions( &( pCtx->readWriteFunctions ) );
+        #endif
 
         pCtx->pStart = pStunMessage;
         pCtx->totalLength = stunMessageLength;
         pCtx->currentIndex = 0;
         pCtx->attributeFlag = 0;
+        pCtx->pAttributeIndex = NULL;
+        pCtx->pUnknownAttributes = NULL;
+        pCtx->pScatterGather = NULL;
+        pCtx->unfilledReservations = 0;
 
         pStunHeader->messageType = STUN_READ_UINT16( &( pCtx->pStart[ pCtx->currentIndex ] ) );
         messageLengthInHeader = STUN_READ_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
@@ -145,23 +655,16 @@ StunResult_t StunDeserializer_Init( StunContext_t * pCtx,
 
 /*-----------------------------------------------------------*/
 
-StunResult_t StunDeserializer_GetNextAttribute( StunContext_t * pCtx,
-                                                StunAttribute_t * pAttribute )
+/* StunDeserializer_GetNextAttribute without the parameter checks and the
+ * counting. */
+static StunResult_t ReadNextAttribute( StunContext_t * pCtx,
+                                       StunAttribute_t * pAttribute )
 {
     StunResult_t result = STUN_RESULT_OK;
 
-    if( ( pCtx == NULL ) ||
-        ( pAttribute == NULL ) )
+    if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_HEADER_LENGTH )
     {
-        result = STUN_RESULT_BAD_PARAM;
-    }
-
-    if( result == STUN_RESULT_OK )
-    {
-        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_HEADER_LENGTH )
-        {
-            result = STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND;
-        }
+        result = STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND;
     }
 
     if( result == STUN_RESULT_OK )
@@ -187,42 +690,370 @@ StunResult_t StunDeserializer_GetNextAttribute( StunContext_t * pCtx,
 
     if( result == STUN_RESULT_OK )
     {
-        if( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT )
-        {
-            pCtx->attributeFlag |= STUN_FLAG_FINGERPRINT_ATTRIBUTE;
-        }
-        if( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY )
-        {
-            pCtx->attributeFlag |= STUN_FLAG_INTEGRITY_ATTRIBUTE;
-        }
-
-        /* Read attribute length. */
-        pAttribute->attributeValueLength = STUN_READ_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
-                                                                              STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+        if( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT )
+        {
+            pCtx->attributeFlag |= STUN_FLAG_FINGERPRINT_ATTRIBUTE;
+        }
+        if( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY )
+        {
+            pCtx->attributeFlag |= STUN_FLAG_INTEGRITY_ATTRIBUTE;
+        }
+
+        /* Read attribute length. */
+        pAttribute->attributeValueLength = STUN_READ_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
+                                                                              STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+
+        /* Check that we have enough data to read attribute value. */
+        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( pAttribute->attributeValueLength ) )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( pAttribute->attributeValueLength > 0 )
+        {
+            pAttribute->pAttributeValue = &( pCtx->pStart[ pCtx->currentIndex +
+                                                           STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] );
+        }
+        else
+        {
+            pAttribute->pAttributeValue = NULL;
+        }
+
+        pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( pAttribute->attributeValueLength ) );
+
+        if( ( pCtx->pUnknownAttributes != NULL ) &&
+            STUN_ATTRIBUTE_IS_COMPREHENSION_REQUIRED( pAttribute->attributeType ) )
+        {
+            RecordUnknownAttribute( pCtx->pUnknownAttributes,
+                                    ( uint16_t ) pAttribute->attributeType );
+        }
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Counts a message taken by the application. Nothing without
+ * STUN_ENABLE_STATS. */
+static void CountMessage( const StunHeader_t * pStunHeader,
+                          size_t stunMessageLength )
+{
+    ( void ) pStunHeader;
+    ( void ) stunMessageLength;
+
+    STUN_STATS_ADD( messagesDeserialized[ STUN_STATS_MESSAGE_TYPE_INDEX( pStunHeader->messageType ) ], 1 );
+    STUN_STATS_ADD( bytesDeserialized, stunMessageLength );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Counts an attribute walked by the application. */
+static void CountAttribute( StunResult_t result,
+                            const StunAttribute_t * pAttribute )
+{
+    ( void ) pAttribute;
+
+    if( result == STUN_RESULT_OK )
+    {
+        STUN_STATS_ADD( attributesDeserialized[ STUN_ATTRIBUTE_TYPE_TO_SLOT( pAttribute->attributeType ) ], 1 );
+    }
+    else if( result == STUN_RESULT_INVALID_ATTRIBUTE_ORDER )
+    {
+        STUN_STATS_ADD( attributeOrderViolations, 1 );
+    }
+    else
+    {
+        /* Nothing to count. */
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Finds an attribute on a local context, so that the caller's iteration is
+ * not disturbed and the attributes are not counted again. */
+static StunResult_t FindAttributeInstance( StunContext_t * pCtx,
+                                           StunAttributeType_t attributeType,
+                                           uint16_t instance,
+                                           StunAttribute_t * pAttribute )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunContext_t localCtx;
+    StunHeader_t localHeader;
+    uint16_t remaining = instance;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pAttribute == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pCtx->pAttributeIndex != NULL ) )
+    {
+        result = FindAttributeInIndex( pCtx,
+                                       attributeType,
+                                       instance,
+                                       pAttribute );
+    }
+    else
+    {
+        if( result == STUN_RESULT_OK )
+        {
+            result = InitMessage( &( localCtx ),
+                                  pCtx->pStart,
+                                  pCtx->totalLength,
+                                  &( localHeader ) );
+        }
+
+        if( result == STUN_RESULT_OK )
+        {
+            do
+            {
+                result = ReadNextAttribute( &( localCtx ),
+                                            pAttribute );
+
+                if( ( result == STUN_RESULT_OK ) &&
+                    ( pAttribute->attributeType == attributeType ) )
+                {
+                    if( remaining == 0 )
+                    {
+                        break;
+                    }
+
+                    remaining--;
+                }
+            } while( result == STUN_RESULT_OK );
+
+            /* Set the return code to STUN_RESULT_NO_ATTRIBUTE_FOUND, if we do
+             * not find the attribute after iterating over all the attributes. */
+            if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+            {
+                result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_Init( StunContext_t * pCtx,
+                                    uint8_t * pStunMessage,
+                                    size_t stunMessageLength,
+                                    StunHeader_t * pStunHeader )
+{
+    StunResult_t result;
+
+    result = InitMessage( pCtx, pStunMessage, stunMessageLength, pStunHeader );
+
+    if( result == STUN_RESULT_OK )
+    {
+        CountMessage( pStunHeader, stunMessageLength );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_INIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetNextAttribute( StunContext_t * pCtx,
+                                                StunAttribute_t * pAttribute )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pAttribute == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = ReadNextAttribute( pCtx, pAttribute );
+        CountAttribute( result, pAttribute );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_NEXT_ATTRIBUTE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_TrackUnknownAttributes( StunContext_t * pCtx,
+                                                      StunUnknownAttributes_t * pUnknownAttributes,
+                                                      uint64_t knownTypes )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pUnknownAttributes == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pUnknownAttributes->knownTypes = knownTypes;
+        pUnknownAttributes->count = 0;
+
+        pCtx->pUnknownAttributes = pUnknownAttributes;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_TRACK_UNKNOWN_ATTRIBUTES, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_InitHandlerTable( StunAttributeHandlerTable_t * pTable )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( pTable == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pTable, 0, sizeof( StunAttributeHandlerTable_t ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_INIT_HANDLER_TABLE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_SetAttributeHandler( StunAttributeHandlerTable_t * pTable,
+                                                   StunAttributeType_t attributeType,
+                                                   StunAttributeHandler_t handler )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t slot;
+
+    if( pTable == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        slot = STUN_ATTRIBUTE_TYPE_TO_SLOT( attributeType );
+
+        /* Work out the decoder once here instead of for every attribute. The
+         * shared slot can hold any type, so it only gets the raw value. */
+        pTable->handlers[ slot ] = handler;
+        pTable->valueKinds[ slot ] = ( slot == STUN_ATTRIBUTE_SLOT_OTHER ) ?
+                                     ( uint8_t ) STUN_ATTRIBUTE_VALUE_KIND_RAW :
+                                     GetAttributeValueKind( attributeType );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_SET_ATTRIBUTE_HANDLER, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_ParseAll( StunContext_t * pCtx,
+                                        const StunAttributeHandlerTable_t * pTable,
+                                        void * pUserData )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunAttribute_t attribute;
+    StunAttributeValue_t value;
+    uint8_t slot;
+
+    if( ( pCtx == NULL ) ||
+        ( pTable == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    while( result == STUN_RESULT_OK )
+    {
+        result = ReadNextAttribute( pCtx, &( attribute ) );
+        CountAttribute( result, &( attribute ) );
+
+        if( result == STUN_RESULT_OK )
+        {
+            slot = STUN_ATTRIBUTE_TYPE_TO_SLOT( attribute.attributeType );
+
+            if( pTable->handlers[ slot ] != NULL )
+            {
+                result = DecodeAttributeValue( pCtx, &( attribute ), pTable->valueKinds[ slot ], &( value ) );
+
+                if( result == STUN_RESULT_OK )
+                {
+                    result = pTable->handlers[ slot ]( pUserData, &( attribute ), &( value ) );
+                }
+            }
+        }
+    }
+
+    if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+    {
+        result = STUN_RESULT_OK;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ALL, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_Decode( StunContext_t * pCtx,
+                                      uint8_t * pStunMessage,
+                                      size_t stunMessageLength,
+                                      StunDecodedMessage_t * pDecoded )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunAttribute_t attribute;
+    size_t attributeOffset;
+
+    if( pDecoded == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pDecoded->presentAttributes = 0;
 
-        /* Check that we have enough data to read attribute value. */
-        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( pAttribute->attributeValueLength ) )
-        {
-            result = STUN_RESULT_OUT_OF_MEMORY;
-        }
+        result = InitMessage( pCtx,
+                              pStunMessage,
+                              stunMessageLength,
+                              &( pDecoded->header ) );
     }
 
     if( result == STUN_RESULT_OK )
     {
-        if( pAttribute->attributeValueLength > 0 )
-        {
-            pAttribute->pAttributeValue = &( pCtx->pStart[ pCtx->currentIndex +
-                                                           STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] );
-        }
-        else
+        CountMessage( &( pDecoded->header ), stunMessageLength );
+
+        pDecoded->unknownAttributes.knownTypes = STUN_ATTRIBUTE_KNOWN_TYPES_DEFAULT;
+        pDecoded->unknownAttributes.count = 0;
+        pCtx->pUnknownAttributes = &( pDecoded->unknownAttributes );
+    }
+
+    while( result == STUN_RESULT_OK )
+    {
+        attributeOffset = pCtx->currentIndex;
+        result = ReadNextAttribute( pCtx, &( attribute ) );
+        CountAttribute( result, &( attribute ) );
+
+        if( result == STUN_RESULT_OK )
         {
-            pAttribute->pAttributeValue = NULL;
+            result = DecodeMessageAttribute( pCtx, &( attribute ), attributeOffset, pDecoded );
         }
+    }
 
-        pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( pAttribute->attributeValueLength ) );
+    if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+    {
+        result = STUN_RESULT_OK;
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_DECODE, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -255,7 +1086,7 @@ StunResult_t StunDeserializer_ParseAttributeErrorCode( const StunAttribute_t * p
         *pErrorPhraseLength = errorPhaseLength;
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ERROR_CODE, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -266,6 +1097,11 @@ StunResult_t StunDeserializer_ParseAttributeChannelNumber( const StunContext_t *
 {
     StunResult_t result = STUN_RESULT_OK;
 
+    #if defined( STUN_COMPILE_TIME_ENDIANNESS )
+        /* The context only holds the read functions. */
+        ( void ) pCtx;
+    #endif
+
     if( ( pAttribute == NULL ) ||
         ( pChannelNumber == NULL ) ||
         ( pAttribute->attributeType != STUN_ATTRIBUTE_TYPE_CHANNEL_NUMBER ) ||
@@ -287,7 +1123,7 @@ StunResult_t StunDeserializer_ParseAttributeChannelNumber( const StunContext_t *
         *pChannelNumber = STUN_READ_UINT16( &( pAttribute->pAttributeValue[ 0 ] ) );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_CHANNEL_NUMBER, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -296,10 +1132,14 @@ StunResult_t StunDeserializer_ParseAttributePriority( const StunContext_t * pCtx
                                                       const StunAttribute_t * pAttribute,
                                                       uint32_t * pPriority )
 {
-    return ParseAttributeUint32( pCtx,
-                                 pAttribute,
-                                 pPriority,
-                                 STUN_ATTRIBUTE_TYPE_PRIORITY );
+    StunResult_t result;
+
+    result = ParseAttributeUint32( pCtx,
+                                   pAttribute,
+                                   pPriority,
+                                   STUN_ATTRIBUTE_TYPE_PRIORITY );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_PRIORITY, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -308,10 +1148,132 @@ StunResult_t StunDeserializer_ParseAttributeFingerprint( const StunContext_t * p
                                                          const StunAttribute_t * pAttribute,
                                                          uint32_t * pCrc32Fingerprint )
 {
-    return ParseAttributeUint32( pCtx,
-                                 pAttribute,
-                                 pCrc32Fingerprint,
-                                 STUN_ATTRIBUTE_TYPE_FINGERPRINT );
+    StunResult_t result;
+
+    result = ParseAttributeUint32( pCtx,
+                                   pAttribute,
+                                   pCrc32Fingerprint,
+                                   STUN_ATTRIBUTE_TYPE_FINGERPRINT );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_FINGERPRINT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_VerifyFingerprint( const StunContext_t * pCtx,
+                                                 const StunAttribute_t * pAttribute )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunVerificationSpan_t span;
+    uint32_t crc32Fingerprint;
+    size_t attributeEnd = 0;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pAttribute == NULL ) ||
+        ( pAttribute->pAttributeValue < &( pCtx->pStart[ STUN_HEADER_LENGTH + STUN_ATTRIBUTE_HEADER_LENGTH ] ) ) ||
+        ( pAttribute->pAttributeValue > &( pCtx->pStart[ pCtx->totalLength ] ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunDeserializer_ParseAttributeFingerprint( pCtx,
+                                                             pAttribute,
+                                                             &( crc32Fingerprint ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        attributeEnd = ( size_t ) ( pAttribute->pAttributeValue - pCtx->pStart ) + STUN_ATTRIBUTE_FINGERPRINT_LENGTH;
+
+        /* Fingerprint must be the last attribute. */
+        if( attributeEnd != pCtx->totalLength )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_ORDER;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = GetVerificationSpan( pCtx,
+                                      attributeEnd,
+                                      STUN_ATTRIBUTE_FINGERPRINT_LENGTH,
+                                      &( span ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( ( Stun_Crc32( Stun_Crc32( 0, &( span.header[ 0 ] ), STUN_HEADER_LENGTH ),
+                          span.pBody,
+                          span.bodyLength ) ^ STUN_FINGERPRINT_XOR_VALUE ) != crc32Fingerprint )
+        {
+            result = STUN_RESULT_FINGERPRINT_MISMATCH;
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_VERIFY_FINGERPRINT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_VerifyIntegrity( const StunContext_t * pCtx,
+                                               const StunAttribute_t * pAttribute,
+                                               const StunHmacKey_t * pHmacKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunHmacContext_t hmacCtx;
+    StunVerificationSpan_t span;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pAttribute == NULL ) ||
+        ( pHmacKey == NULL ) ||
+        ( pAttribute->pAttributeValue < &( pCtx->pStart[ STUN_HEADER_LENGTH + STUN_ATTRIBUTE_HEADER_LENGTH ] ) ) ||
+        ( pAttribute->pAttributeValue > &( pCtx->pStart[ pCtx->totalLength ] ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( ( pAttribute->attributeType != STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY ) ||
+            ( pAttribute->attributeValueLength != STUN_HMAC_VALUE_LENGTH ) )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = GetVerificationSpan( pCtx,
+                                      ( size_t ) ( pAttribute->pAttributeValue - pCtx->pStart ) + STUN_HMAC_VALUE_LENGTH,
+                                      STUN_HMAC_VALUE_LENGTH,
+                                      &( span ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Start( &( hmacCtx ), pHmacKey );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Update( &( hmacCtx ), &( span.header[ 0 ] ), STUN_HEADER_LENGTH );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Update( &( hmacCtx ), span.pBody, span.bodyLength );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_VerifyFinish( &( hmacCtx ), pAttribute->pAttributeValue );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_VERIFY_INTEGRITY, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -320,10 +1282,14 @@ StunResult_t StunDeserializer_ParseAttributeLifetime( const StunContext_t * pCtx
                                                       const StunAttribute_t * pAttribute,
                                                       uint32_t * pLifetime )
 {
-    return ParseAttributeUint32( pCtx,
-                                 pAttribute,
-                                 pLifetime,
-                                 STUN_ATTRIBUTE_TYPE_LIFETIME );
+    StunResult_t result;
+
+    result = ParseAttributeUint32( pCtx,
+                                   pAttribute,
+                                   pLifetime,
+                                   STUN_ATTRIBUTE_TYPE_LIFETIME );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_LIFETIME, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -332,10 +1298,14 @@ StunResult_t StunDeserializer_ParseAttributeChangeRequest( const StunContext_t *
                                                            const StunAttribute_t * pAttribute,
                                                            uint32_t * pChangeFlag )
 {
-    return ParseAttributeUint32( pCtx,
-                                 pAttribute,
-                                 pChangeFlag,
-                                 STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST );
+    StunResult_t result;
+
+    result = ParseAttributeUint32( pCtx,
+                                   pAttribute,
+                                   pChangeFlag,
+                                   STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_CHANGE_REQUEST, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -344,10 +1314,14 @@ StunResult_t StunDeserializer_ParseAttributeIceControlled( const StunContext_t *
                                                            const StunAttribute_t * pAttribute,
                                                            uint64_t * pIceControlledValue )
 {
-    return ParseAttributeUint64( pCtx,
-                                 pAttribute,
-                                 pIceControlledValue,
-                                 STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED );
+    StunResult_t result;
+
+    result = ParseAttributeUint64( pCtx,
+                                   pAttribute,
+                                   pIceControlledValue,
+                                   STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ICE_CONTROLLED, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -356,11 +1330,15 @@ StunResult_t StunDeserializer_ParseAttributeIceControlling( const StunContext_t
                                                             const StunAttribute_t * pAttribute,
                                                             uint64_t * pIceControllingValue )
 {
+    StunResult_t result;
+
 
-    return ParseAttributeUint64( pCtx,
-                                 pAttribute,
-                                 pIceControllingValue,
-                                 STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING );
+    result = ParseAttributeUint64( pCtx,
+                                   pAttribute,
+                                   pIceControllingValue,
+                                   STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ICE_CONTROLLING, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -370,11 +1348,9 @@ StunResult_t StunDeserializer_ParseAttributeAddress( const StunContext_t * pCtx,
                                                      StunAttributeAddress_t * pAddress )
 {
     StunResult_t result = STUN_RESULT_OK;
-    uint16_t msbMagic = ( STUN_HEADER_MAGIC_COOKIE >> 16 );
-    uint32_t word, xorWord, i;
-    uint8_t byte, xorByte;
 
-    if( ( pAttribute == NULL ) ||
+    if( ( pCtx == NULL ) ||
+        ( pAttribute == NULL ) ||
         ( pAttribute->pAttributeValue == NULL ) ||
         ( pAddress == NULL ) )
     {
@@ -383,38 +1359,14 @@ StunResult_t StunDeserializer_ParseAttributeAddress( const StunContext_t * pCtx,
 
     if( result == STUN_RESULT_OK )
     {
-        pAddress->family = STUN_READ_UINT16( &( pAttribute->pAttributeValue[ 0 ] ) );
-        pAddress->port = STUN_READ_UINT16( &( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ADDRESS_PORT_OFFSET ] ) );
-
-        memcpy( ( void * ) &( pAddress->address[ 0 ] ),
-                ( const void * ) &( pAttribute->pAttributeValue[ STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
-                pAttribute->attributeValueLength - STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH );
-
-        if( ( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) ||
-            ( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) ||
-            ( pAttribute->attributeType == STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) )
-        {
-            /* XOR the port with high-bits of the magic cookie. */
-            pAddress->port = msbMagic ^ pAddress->port;
-
-            /* XOR first 4 bytes of IP address with magic cookie. */
-            word = STUN_READ_UINT32( &( pAddress->address[ 0 ] ) );
-            xorWord = word ^ STUN_HEADER_MAGIC_COOKIE;
-            STUN_WRITE_UINT32( &( pAddress->address[ 0 ] ), xorWord );
-
-            if( pAddress->family == STUN_ADDRESS_IPv6 )
-            {
-                for( i = 0; i < STUN_HEADER_TRANSACTION_ID_LENGTH; i++ )
-                {
-                    byte = pAddress->address[ STUN_IPV4_ADDRESS_SIZE + i ];
-                    xorByte = byte ^ pCtx->pStart[ STUN_HEADER_TRANSACTION_ID_OFFSET + i ];
-                    pAddress->address[ STUN_IPV4_ADDRESS_SIZE + i ] = xorByte;
-                }
-            }
-        }
+        result = StunAddress_Decode( pCtx->pStart,
+                                     pAttribute->pAttributeValue,
+                                     pAttribute->attributeValueLength,
+                                     STUN_ATTRIBUTE_IS_XOR_ADDRESS( pAttribute->attributeType ),
+                                     pAddress );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_PARSE_ATTRIBUTE_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -441,7 +1393,7 @@ StunResult_t StunDeserializer_GetIntegrityBuffer( StunContext_t * pCtx,
         *pStunMessageLength = pCtx->currentIndex - STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_HMAC_VALUE_LENGTH );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_INTEGRITY_BUFFER, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -468,7 +1420,57 @@ StunResult_t StunDeserializer_GetFingerprintBuffer( StunContext_t * pCtx,
         *pStunMessageLength = pCtx->currentIndex - STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ATTRIBUTE_FINGERPRINT_LENGTH );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_FINGERPRINT_BUFFER, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetIntegritySpan( const StunContext_t * pCtx,
+                                                StunVerificationSpan_t * pSpan )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pSpan == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = GetVerificationSpan( pCtx,
+                                      pCtx->currentIndex,
+                                      STUN_HMAC_VALUE_LENGTH,
+                                      pSpan );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_INTEGRITY_SPAN, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetFingerprintSpan( const StunContext_t * pCtx,
+                                                  StunVerificationSpan_t * pSpan )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pSpan == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = GetVerificationSpan( pCtx,
+                                      pCtx->currentIndex,
+                                      STUN_ATTRIBUTE_FINGERPRINT_LENGTH,
+                                      pSpan );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_FINGERPRINT_SPAN, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -476,48 +1478,205 @@ StunResult_t StunDeserializer_GetFingerprintBuffer( StunContext_t * pCtx,
 StunResult_t StunDeserializer_FindAttribute( StunContext_t * pCtx,
                                              StunAttributeType_t attributeType,
                                              StunAttribute_t * pAttribute )
+{
+    StunResult_t result;
+
+    result = FindAttributeInstance( pCtx,
+                                    attributeType,
+                                    0,
+                                    pAttribute );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_FindAttributeInstance( StunContext_t * pCtx,
+                                                     StunAttributeType_t attributeType,
+                                                     uint16_t instance,
+                                                     StunAttribute_t * pAttribute )
+{
+    StunResult_t result;
+
+    result = FindAttributeInstance( pCtx,
+                                    attributeType,
+                                    instance,
+                                    pAttribute );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_FIND_ATTRIBUTE_INSTANCE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetAttributeCount( StunContext_t * pCtx,
+                                                 StunAttributeType_t attributeType,
+                                                 uint16_t * pCount )
 {
     StunResult_t result = STUN_RESULT_OK;
     StunContext_t localCtx;
     StunHeader_t localHeader;
+    StunAttribute_t attribute;
+    const StunAttributeIndex_t * pIndex;
+    uint8_t slot, entry;
+    uint16_t count = 0;
 
     if( ( pCtx == NULL ) ||
         ( pCtx->pStart == NULL ) ||
-        ( pAttribute == NULL ) )
+        ( pCount == NULL ) )
     {
         result = STUN_RESULT_BAD_PARAM;
     }
 
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pCtx->pAttributeIndex != NULL ) )
+    {
+        pIndex = pCtx->pAttributeIndex;
+        slot = STUN_ATTRIBUTE_TYPE_TO_SLOT( attributeType );
+
+        if( !STUN_ATTRIBUTE_SLOT_IS_SET( pIndex->usedSlots, slot ) )
+        {
+            count = 0;
+        }
+        else if( slot != STUN_ATTRIBUTE_SLOT_OTHER )
+        {
+            count = pIndex->entryCount[ slot ];
+        }
+        else
+        {
+            /* Multiple types share this slot and therefore, we need to
+             * compare types. */
+            for( entry = pIndex->firstEntry[ slot ]; entry != 0; entry = pIndex->entries[ entry - 1 ].nextEntry )
+            {
+                if( pIndex->entries[ entry - 1 ].attributeType == ( uint16_t ) attributeType )
+                {
+                    count++;
+                }
+            }
+        }
+    }
+    else
+    {
+        if( result == STUN_RESULT_OK )
+        {
+            result = InitMessage( &( localCtx ),
+                                  pCtx->pStart,
+                                  pCtx->totalLength,
+                                  &( localHeader ) );
+        }
+
+        while( result == STUN_RESULT_OK )
+        {
+            result = ReadNextAttribute( &( localCtx ),
+                                        &( attribute ) );
+
+            if( ( result == STUN_RESULT_OK ) &&
+                ( attribute.attributeType == attributeType ) )
+            {
+                count++;
+            }
+        }
+
+        if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+        {
+            result = STUN_RESULT_OK;
+        }
+    }
+
     if( result == STUN_RESULT_OK )
     {
-        result = StunDeserializer_Init( &( localCtx ),
-                                        pCtx->pStart,
-                                        pCtx->totalLength,
-                                        &( localHeader ) );
+        *pCount = count;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_ATTRIBUTE_COUNT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_BuildAttributeIndex( StunContext_t * pCtx,
+                                                   StunAttributeIndex_t * pIndex )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunContext_t localCtx;
+    StunAttribute_t attribute;
+    StunAttributeIndexEntry_t * pEntry;
+    size_t attributeOffset;
+    uint8_t slot;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pCtx->totalLength < STUN_HEADER_LENGTH ) ||
+        ( pIndex == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
     }
 
     if( result == STUN_RESULT_OK )
     {
-        do
-        {
-            result = StunDeserializer_GetNextAttribute( &( localCtx ),
-                                                        pAttribute );
+        memset( ( void * ) &( pIndex->usedSlots[ 0 ] ), 0, sizeof( pIndex->usedSlots ) );
+        pIndex->totalEntries = 0;
+
+        /* Walk the message on a local context so that the caller's iteration,
+         * if any, is not disturbed. */
+        localCtx = *pCtx;
+        localCtx.currentIndex = STUN_HEADER_LENGTH;
+        localCtx.attributeFlag = 0;
+        localCtx.pAttributeIndex = NULL;
+
+        pCtx->pAttributeIndex = NULL;
+    }
 
-            if( pAttribute->attributeType == attributeType )
+    while( result == STUN_RESULT_OK )
+    {
+        attributeOffset = localCtx.currentIndex;
+
+        result = ReadNextAttribute( &( localCtx ),
+                                    &( attribute ) );
+
+        if( result == STUN_RESULT_OK )
+        {
+            if( pIndex->totalEntries == STUN_ATTRIBUTE_INDEX_MAX_ENTRIES )
             {
-                break;
+                result = STUN_RESULT_OUT_OF_MEMORY;
             }
-        } while( result == STUN_RESULT_OK );
+        }
 
-        /* Set the return code to STUN_RESULT_NO_ATTRIBUTE_FOUND, if we do not
-         * find the attribute after iterating over all the attributes. */
-        if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+        if( result == STUN_RESULT_OK )
         {
-            result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+            slot = STUN_ATTRIBUTE_TYPE_TO_SLOT( attribute.attributeType );
+
+            pEntry = &( pIndex->entries[ pIndex->totalEntries ] );
+            pEntry->attributeType = ( uint16_t ) attribute.attributeType;
+            pEntry->attributeValueLength = attribute.attributeValueLength;
+            pEntry->attributeValueOffset = ( uint32_t ) ( attributeOffset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET );
+            pEntry->nextEntry = 0;
+
+            pIndex->totalEntries++;
+
+            /* Append to the list of the slot to preserve the order of the
+             * repeated attributes. */
+            if( !STUN_ATTRIBUTE_SLOT_IS_SET( pIndex->usedSlots, slot ) )
+            {
+                STUN_ATTRIBUTE_SLOT_SET( pIndex->usedSlots, slot );
+                pIndex->firstEntry[ slot ] = pIndex->totalEntries;
+                pIndex->entryCount[ slot ] = 0;
+            }
+            else
+            {
+                pIndex->entries[ pIndex->lastEntry[ slot ] - 1 ].nextEntry = pIndex->totalEntries;
+            }
+
+            pIndex->lastEntry[ slot ] = pIndex->totalEntries;
+            pIndex->entryCount[ slot ]++;
         }
     }
 
-    return result;
+    if( result == STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND )
+    {
+        pCtx->pAttributeIndex = pIndex;
+        result = STUN_RESULT_OK;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_BUILD_ATTRIBUTE_INDEX, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -545,7 +1704,7 @@ StunResult_t StunDeserializer_UpdateAttributeNonce( const StunContext_t * pCtx,
                 nonceLength );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_UPDATE_ATTRIBUTE_NONCE, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -0,0 +1,412 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_deserializer.h"
+#include "stun_stats.h"
+
+/* Read/Write macros. */
+#if defined( STUN_COMPILE_TIME_ENDIANNESS )
+    #define STUN_READ_UINT16    Stun_ReadUint16
+    #define STUN_READ_UINT32    Stun_ReadUint32
+#else
+    #define STUN_READ_UINT16    ( pBatch->readWriteFunctions.readUint16Fn )
+    #define STUN_READ_UINT32    ( pBatch->readWriteFunctions.readUint32Fn )
+#endif
+
+/* Prefetch the headers this many messages ahead of the one being
+ * deserialized. */
+#ifndef STUN_BATCH_PREFETCH_DISTANCE
+    #define STUN_BATCH_PREFETCH_DISTANCE    4
+#endif
+
+#if defined( __GNUC__ )
+    #define STUN_PREFETCH( pAddress )    __builtin_prefetch( ( pAddress ), 0, 3 )
+    #define STUN_NOINLINE                __attribute__( ( noinline ) )
+#else
+    #define STUN_PREFETCH( pAddress )
+    #define STUN_NOINLINE
+#endif
+
+/* The largest message whose length fits in the header length field. */
+#define STUN_MAX_MESSAGE_LENGTH             ( STUN_HEADER_LENGTH + 0xFFFF )
+
+/*-----------------------------------------------------------*/
+
+/* Static Functions. */
+static uint32_t LoadWord( const uint8_t * pSrc );
+
+/* Not inlined: in the loop over the burst there are not enough registers
+ * left for the attribute walk, and the compiler spills the offset of the next
+ * attribute, which every iteration depends on. */
+STUN_NOINLINE static StunResult_t AppendBatchAttributes( const StunDeserializerBatch_t * pBatch,
+                                                         const uint8_t * pMessage,
+                                                         size_t messageLength,
+                                                         uint16_t * pUsedAttributes );
+
+static StunResult_t DeserializeBatchMessage( const StunDeserializerBatch_t * pBatch,
+                                             uint8_t * pMessage,
+                                             size_t messageLength,
+                                             uint16_t * pMessageType,
+                                             uint8_t ** ppTransactionId,
+                                             uint16_t * pUsedAttributes );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t LoadWord( const uint8_t * pSrc )
+{
+    uint32_t word;
+
+    /* memcpy compiles to a single load and is safe for unaligned buffers. */
+    memcpy( ( void * ) &( word ), ( const void * ) pSrc, sizeof( word ) );
+
+    return word;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_ClassifyBatch( const uint8_t * const * ppStunMessages,
+                                             const size_t * pStunMessageLengths,
+                                             size_t messageCount,
+                                             uint64_t * pStunMask )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const uint8_t * pMessage;
+    uint32_t magicCookie;
+    size_t i, messageLength;
+    const uint8_t magicCookieBytes[ sizeof( uint32_t ) ] =
+    {
+        ( uint8_t ) ( STUN_HEADER_MAGIC_COOKIE >> 24 ),
+        ( uint8_t ) ( STUN_HEADER_MAGIC_COOKIE >> 16 ),
+        ( uint8_t ) ( STUN_HEADER_MAGIC_COOKIE >> 8 ),
+        ( uint8_t ) ( STUN_HEADER_MAGIC_COOKIE )
+    };
+
+    if( ( ppStunMessages == NULL ) ||
+        ( pStunMessageLengths == NULL ) ||
+        ( pStunMask == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        /* Compare the magic cookie as loaded from the wire so that no byte
+         * swapping is needed per message. */
+        magicCookie = LoadWord( &( magicCookieBytes[ 0 ] ) );
+
+        memset( ( void * ) pStunMask, 0, ( ( messageCount + 63 ) / 64 ) * sizeof( uint64_t ) );
+
+        for( i = 0; i < messageCount; i++ )
+        {
+            pMessage = ppStunMessages[ i ];
+            messageLength = pStunMessageLengths[ i ];
+
+            /* On a shared socket most datagrams are not STUN, and the first
+             * byte alone rejects them, with the RFC 7983 ranges of
+             * StunDemux_ClassifyBatch, so that only STUN messages cost more
+             * than one load. The message length in the header must match
+             * the datagram length. */
+            if( ( pMessage != NULL ) &&
+                ( messageLength >= STUN_HEADER_LENGTH ) &&
+                ( messageLength <= STUN_MAX_MESSAGE_LENGTH ) &&
+                STUN_FIRST_BYTE_IS_DEMUXED_STUN( pMessage[ 0 ] ) &&
+                ( LoadWord( &( pMessage[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) == magicCookie ) &&
+                ( ( ( ( size_t ) pMessage[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] << 8 ) |
+                    pMessage[ STUN_HEADER_MESSAGE_LENGTH_OFFSET + 1 ] ) == ( messageLength - STUN_HEADER_LENGTH ) ) )
+            {
+                pStunMask[ i / 64 ] |= ( uint64_t ) 1 << ( i % 64 );
+            }
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_CLASSIFY_BATCH, result );
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t AppendBatchAttributes( const StunDeserializerBatch_t * pBatch,
+                                           const uint8_t * pMessage,
+                                           size_t messageLength,
+                                           uint16_t * pUsedAttributes )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t offset = STUN_HEADER_LENGTH;
+    StunBatchAttribute_t * pAttributes = pBatch->pAttributes;
+    StunBatchAttribute_t * pAttribute;
+    /* Local copies so that the stores to the attribute table, which the
+     * compiler cannot tell apart from the batch, do not force it to reload
+     * them in every iteration. */
+    uint16_t usedAttributes = *pUsedAttributes;
+    uint16_t maxAttributes = pBatch->maxAttributes;
+    uint32_t attributeFlag = 0;
+    uint16_t attributeType, attributeValueLength;
+
+    /* The same checks as StunDeserializer_GetNextAttribute. */
+    while( ( result == STUN_RESULT_OK ) &&
+           ( offset < messageLength ) &&
+           ( ( messageLength - offset ) >= STUN_ATTRIBUTE_HEADER_LENGTH ) )
+    {
+        attributeType = STUN_READ_UINT16( &( pMessage[ offset ] ) );
+        attributeValueLength = STUN_READ_UINT16( &( pMessage[ offset + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+
+        if( ( ( attributeFlag & STUN_FLAG_FINGERPRINT_ATTRIBUTE ) != 0 ) ||
+            ( ( ( attributeFlag & STUN_FLAG_INTEGRITY_ATTRIBUTE ) != 0 ) &&
+              ( attributeType != STUN_ATTRIBUTE_TYPE_FINGERPRINT ) ) )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_ORDER;
+            STUN_STATS_ADD( attributeOrderViolations, 1 );
+        }
+        else if( ( messageLength - offset ) < STUN_ATTRIBUTE_TOTAL_LENGTH( ( size_t ) attributeValueLength ) )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+        else if( usedAttributes == maxAttributes )
+        {
+            /* The shared attribute table is full. */
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+        else
+        {
+            if( attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT )
+            {
+                attributeFlag |= STUN_FLAG_FINGERPRINT_ATTRIBUTE;
+            }
+            else if( attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY )
+            {
+                attributeFlag |= STUN_FLAG_INTEGRITY_ATTRIBUTE;
+            }
+
+            pAttribute = &( pAttributes[ usedAttributes ] );
+            pAttribute->attributeType = attributeType;
+            pAttribute->attributeValueLength = attributeValueLength;
+            pAttribute->attributeValueOffset = ( uint32_t ) ( offset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET );
+
+            usedAttributes++;
+
+            STUN_STATS_ADD( attributesDeserialized[ STUN_ATTRIBUTE_TYPE_TO_SLOT( attributeType ) ], 1 );
+
+            offset += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( ( size_t ) attributeValueLength ) );
+        }
+    }
+
+    *pUsedAttributes = usedAttributes;
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t DeserializeBatchMessage( const StunDeserializerBatch_t * pBatch,
+                                             uint8_t * pMessage,
+                                             size_t messageLength,
+                                             uint16_t * pMessageType,
+                                             uint8_t ** ppTransactionId,
+                                             uint16_t * pUsedAttributes )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint32_t magicCookie;
+    uint16_t messageLengthInHeader;
+
+    ( void ) pBatch;
+
+    *pMessageType = 0;
+    *ppTransactionId = NULL;
+
+    if( ( pMessage == NULL ) ||
+        ( messageLength < STUN_HEADER_LENGTH ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        *pMessageType = STUN_READ_UINT16( &( pMessage[ 0 ] ) );
+        messageLengthInHeader = STUN_READ_UINT16( &( pMessage[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
+        magicCookie = STUN_READ_UINT32( &( pMessage[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) );
+
+        if( magicCookie != STUN_HEADER_MAGIC_COOKIE )
+        {
+            result = STUN_RESULT_MAGIC_COOKIE_MISMATCH;
+        }
+        else if( ( ( size_t ) messageLengthInHeader + STUN_HEADER_LENGTH ) != messageLength )
+        {
+            result = STUN_RESULT_INVALID_MESSAGE_LENGTH;
+        }
+        else
+        {
+            *ppTransactionId = &( pMessage[ STUN_HEADER_TRANSACTION_ID_OFFSET ] );
+            result = AppendBatchAttributes( pBatch, pMessage, messageLength, pUsedAttributes );
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        STUN_STATS_ADD( messagesDeserialized[ STUN_STATS_MESSAGE_TYPE_INDEX( *pMessageType ) ], 1 );
+        STUN_STATS_ADD( bytesDeserialized, messageLength );
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_InitBatch( StunDeserializerBatch_t * pBatch,
+                                         uint8_t * const * ppStunMessages,
+                                         const size_t * pStunMessageLengths,
+                                         size_t messageCount )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunResult_t messageResult;
+    uint16_t attributeStart, usedAttributes = 0, messageType;
+    uint8_t * pTransactionId;
+    size_t i;
+
+    if( ( pBatch == NULL ) ||
+        ( ppStunMessages == NULL ) ||
+        ( pStunMessageLengths == NULL ) ||
+        ( pBatch->pResults == NULL ) ||
+        ( pBatch->pMessageTypes == NULL ) ||
+        ( pBatch->ppTransactionIds == NULL ) ||
+        ( pBatch->pAttributeStart == NULL ) ||
+        ( pBatch->pAttributeCount == NULL ) ||
+        ( ( pBatch->pAttributes == NULL ) &&
+          ( pBatch->maxAttributes != 0 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        /* Set up the read functions once for the whole burst. */
+        #if !defined( STUN_COMPILE_TIME_ENDIANNESS )
+            Stun_InitReadWriteFunctions( &( pBatch->readWriteFunctions ) );
+        #endif
+
+        pBatch->ppStunMessages = ppStunMessages;
+        pBatch->pStunMessageLengths = pStunMessageLengths;
+        pBatch->messageCount = messageCount;
+
+        for( i = 0; i < messageCount; i++ )
+        {
+            if( ( i + STUN_BATCH_PREFETCH_DISTANCE ) < messageCount )
+            {
+                STUN_PREFETCH( ppStunMessages[ i + STUN_BATCH_PREFETCH_DISTANCE ] );
+            }
+
+            attributeStart = usedAttributes;
+
+            messageResult = DeserializeBatchMessage( pBatch,
+                                                     ppStunMessages[ i ],
+                                                     pStunMessageLengths[ i ],
+                                                     &( messageType ),
+                                                     &( pTransactionId ),
+                                                     &( usedAttributes ) );
+
+            if( messageResult != STUN_RESULT_OK )
+            {
+                /* Give back the attribute table entries of the rejected
+                 * message. */
+                usedAttributes = attributeStart;
+            }
+
+            /* Write every output array once per message. */
+            pBatch->pResults[ i ] = messageResult;
+            pBatch->pMessageTypes[ i ] = ( StunMessageType_t ) messageType;
+            pBatch->ppTransactionIds[ i ] = pTransactionId;
+            pBatch->pAttributeStart[ i ] = attributeStart;
+            pBatch->pAttributeCount[ i ] = usedAttributes - attributeStart;
+        }
+
+        pBatch->usedAttributes = usedAttributes;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_INIT_BATCH, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetBatchAttribute( const StunDeserializerBatch_t * pBatch,
+                                                 size_t messageIndex,
+                                                 uint16_t attributeIndex,
+                                                 StunAttribute_t * pAttribute )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const StunBatchAttribute_t * pBatchAttribute;
+
+    if( ( pBatch == NULL ) ||
+        ( messageIndex >= pBatch->messageCount ) ||
+        ( pAttribute == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( attributeIndex >= pBatch->pAttributeCount[ messageIndex ] )
+        {
+            result = STUN_RESULT_NO_MORE_ATTRIBUTE_FOUND;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pBatchAttribute = &( pBatch->pAttributes[ pBatch->pAttributeStart[ messageIndex ] + attributeIndex ] );
+
+        pAttribute->attributeType = ( StunAttributeType_t ) pBatchAttribute->attributeType;
+        pAttribute->attributeValueLength = pBatchAttribute->attributeValueLength;
+
+        if( pBatchAttribute->attributeValueLength > 0 )
+        {
+            pAttribute->pAttributeValue = &( pBatch->ppStunMessages[ messageIndex ][ pBatchAttribute->attributeValueOffset ] );
+        }
+        else
+        {
+            pAttribute->pAttributeValue = NULL;
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_BATCH_ATTRIBUTE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunDeserializer_GetBatchContext( const StunDeserializerBatch_t * pBatch,
+                                               size_t messageIndex,
+                                               StunContext_t * pCtx )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pBatch == NULL ) ||
+        ( messageIndex >= pBatch->messageCount ) ||
+        ( pCtx == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = pBatch->pResults[ messageIndex ];
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        /* Same state as StunDeserializer_Init leaves the context in, without
+         * setting up the read/write functions again. */
+        pCtx->pStart = pBatch->ppStunMessages[ messageIndex ];
+        pCtx->totalLength = pBatch->pStunMessageLengths[ messageIndex ];
+        pCtx->currentIndex = STUN_HEADER_LENGTH;
+        pCtx->attributeFlag = 0;
+        #if !defined( STUN_COMPILE_TIME_ENDIANNESS )
+            pCtx->readWriteFunctions = pBatch->readWriteFunctions;
+        #endif
+        pCtx->pAttributeIndex = NULL;
+        pCtx->pUnknownAttributes = NULL;
+        pCtx->pScatterGather = NULL;
+        pCtx->unfilledReservations = 0;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_DESERIALIZER_GET_BATCH_CONTEXT, result );
+}
+
+/*-----------------------------------------------------------*/
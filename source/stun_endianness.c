@@ -1,6 +1,12 @@
+/* Standard includes. */
+#include <string.h>
+
 /* API includes. */
 #include "stun_endianness.h"
 
+/* The buffers passed to the functions below may not be aligned and therefore,
+ * they are accessed using memcpy which compiles to a single load or store. */
+
 #define SWAP_BYTES_16( value )          \
     ( ( ( ( value ) >> 8 ) & 0xFF ) |   \
       ( ( ( value ) & 0xFF ) << 8 ) )
@@ -25,84 +31,114 @@
 
 void WriteUint16Swap( uint8_t * pDst, uint16_t val )
 {
-    *( ( uint16_t * )( pDst ) ) = SWAP_BYTES_16( val );
+    uint16_t swapped = ( uint16_t ) SWAP_BYTES_16( val );
+
+    memcpy( ( void * ) pDst, ( const void * ) &( swapped ), sizeof( swapped ) );
 }
 
 /*-----------------------------------------------------------*/
 
 void WriteUint32Swap( uint8_t * pDst, uint32_t val )
 {
-    *( ( uint32_t * )( pDst ) ) = SWAP_BYTES_32( val );
+    uint32_t swapped = ( uint32_t ) SWAP_BYTES_32( val );
+
+    memcpy( ( void * ) pDst, ( const void * ) &( swapped ), sizeof( swapped ) );
 }
 
 /*-----------------------------------------------------------*/
 
 void WriteUint64Swap( uint8_t * pDst, uint64_t val )
 {
-    *( ( uint64_t * )( pDst ) ) = SWAP_BYTES_64( val );
+    uint64_t swapped = ( uint64_t ) SWAP_BYTES_64( val );
+
+    memcpy( ( void * ) pDst, ( const void * ) &( swapped ), sizeof( swapped ) );
 }
 
 /*-----------------------------------------------------------*/
 
 uint16_t ReadUint16Swap( const uint8_t * pSrc )
 {
-    return SWAP_BYTES_16( *( ( uint16_t * )( pSrc ) ) );
+    uint16_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return ( uint16_t ) SWAP_BYTES_16( val );
 }
 
 /*-----------------------------------------------------------*/
 
 uint32_t ReadUint32Swap( const uint8_t * pSrc )
 {
-    return SWAP_BYTES_32( *( ( uint32_t * )( pSrc ) ) );
+    uint32_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return ( uint32_t ) SWAP_BYTES_32( val );
 }
 
 /*-----------------------------------------------------------*/
 
 uint64_t ReadUint64Swap( const uint8_t * pSrc )
 {
-    return SWAP_BYTES_64( *( ( uint64_t * )( pSrc ) ) );
+    uint64_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return ( uint64_t ) SWAP_BYTES_64( val );
 }
 
 /*-----------------------------------------------------------*/
 
 void WriteUint16NoSwap( uint8_t * pDst, uint16_t val )
 {
-    *( ( uint16_t * )( pDst ) ) = ( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
 }
 
 /*-----------------------------------------------------------*/
 
 void WriteUint32NoSwap( uint8_t * pDst, uint32_t val )
 {
-    *( ( uint32_t * )( pDst ) ) = ( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
 }
 
 /*-----------------------------------------------------------*/
 
 void WriteUint64NoSwap( uint8_t * pDst, uint64_t val )
 {
-    *( ( uint64_t * )( pDst ) ) = ( val );
+    memcpy( ( void * ) pDst, ( const void * ) &( val ), sizeof( val ) );
 }
 
 /*-----------------------------------------------------------*/
 
 uint16_t ReadUint16NoSwap( const uint8_t * pSrc )
 {
-    return *( ( uint16_t * )( pSrc ) );
+    uint16_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return val;
 }
 
 /*-----------------------------------------------------------*/
 
 uint32_t ReadUint32NoSwap( const uint8_t * pSrc )
 {
-    return *( ( uint32_t * )( pSrc ) );
+    uint32_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return val;
 }
 
 /*-----------------------------------------------------------*/
 
 uint64_t ReadUint64NoSwap( const uint8_t * pSrc )
 {
-    return *( ( uint64_t * )( pSrc ) );
+    uint64_t val;
+
+    memcpy( ( void * ) &( val ), ( const void * ) pSrc, sizeof( val ) );
+
+    return val;
 }
 
 /*-----------------------------------------------------------*/
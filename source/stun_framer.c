@@ -0,0 +1,330 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_framer.h"
+#include "stun_stats.h"
+
+/*-----------------------------------------------------------*/
+
+static size_t GetLengthFieldEnd( const StunFramerContext_t * pCtx );
+
+static StunResult_t GetFrameLength( const StunFramerContext_t * pCtx,
+                                    const uint8_t * pBuffer,
+                                    size_t bufferLength,
+                                    size_t * pFrameLength );
+
+static StunResult_t FillFrame( const StunFramerContext_t * pCtx,
+                               const uint8_t * pBuffer,
+                               size_t frameLength,
+                               StunFrame_t * pFrame );
+
+static StunResult_t AssembleFrame( StunFramerContext_t * pCtx,
+                                   StunFrame_t * pFrame );
+
+/*-----------------------------------------------------------*/
+
+/* Number of bytes needed to know the length of a frame. */
+static size_t GetLengthFieldEnd( const StunFramerContext_t * pCtx )
+{
+    size_t lengthFieldEnd = STUN_FRAMER_RFC4571_PREFIX_LENGTH;
+
+    if( pCtx->framingMode == STUN_FRAMING_MODE_TURN )
+    {
+        /* Same for STUN and ChannelData. */
+        lengthFieldEnd = STUN_CHANNEL_DATA_HEADER_LENGTH;
+    }
+
+    return lengthFieldEnd;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Gets the number of stream bytes taken by the frame starting at pBuffer,
+ * including the RFC 4571 length prefix or the ChannelData padding. Returns
+ * STUN_RESULT_NO_MORE_FRAME_FOUND if bufferLength is too short to tell. */
+static StunResult_t GetFrameLength( const StunFramerContext_t * pCtx,
+                                    const uint8_t * pBuffer,
+                                    size_t bufferLength,
+                                    size_t * pFrameLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t length;
+
+    if( bufferLength < GetLengthFieldEnd( pCtx ) )
+    {
+        result = STUN_RESULT_NO_MORE_FRAME_FOUND;
+    }
+    else if( pCtx->framingMode == STUN_FRAMING_MODE_RFC4571 )
+    {
+        *pFrameLength = STUN_FRAMER_RFC4571_PREFIX_LENGTH + Stun_ReadUint16( pBuffer );
+    }
+    else if( STUN_FIRST_BYTE_IS_STUN( pBuffer[ 0 ] ) )
+    {
+        length = Stun_ReadUint16( &( pBuffer[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) );
+
+        /* STUN messages are always padded to a multiple of 4 bytes. Anything
+         * else means that the stream is out of sync. */
+        if( ( length & 0x3 ) != 0 )
+        {
+            result = STUN_RESULT_INVALID_FRAME;
+        }
+        else
+        {
+            *pFrameLength = STUN_HEADER_LENGTH + length;
+        }
+    }
+    else if( STUN_FIRST_BYTE_IS_CHANNEL_DATA( pBuffer[ 0 ] ) )
+    {
+        length = Stun_ReadUint16( &( pBuffer[ STUN_CHANNEL_DATA_LENGTH_OFFSET ] ) );
+        *pFrameLength = STUN_CHANNEL_DATA_HEADER_LENGTH + STUN_ALIGN_SIZE_TO_WORD( length );
+    }
+    else
+    {
+        result = STUN_RESULT_INVALID_FRAME;
+    }
+
+    /* A frame that could not be assembled if it were split must be rejected
+     * even when it is not, so that the result does not depend on how the
+     * stream was chunked. */
+    if( ( result == STUN_RESULT_OK ) &&
+        ( *pFrameLength > pCtx->scratchLength ) )
+    {
+        result = STUN_RESULT_OUT_OF_MEMORY;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t FillFrame( const StunFramerContext_t * pCtx,
+                               const uint8_t * pBuffer,
+                               size_t frameLength,
+                               StunFrame_t * pFrame )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    int isStun;
+
+    if( pCtx->framingMode == STUN_FRAMING_MODE_RFC4571 )
+    {
+        pFrame->pFrame = &( pBuffer[ STUN_FRAMER_RFC4571_PREFIX_LENGTH ] );
+        pFrame->frameLength = frameLength - STUN_FRAMER_RFC4571_PREFIX_LENGTH;
+
+        /* Other protocols can share the connection, so use the narrower
+         * RFC 7983 ranges and the magic cookie to pick out STUN. */
+        isStun = ( pFrame->frameLength >= STUN_HEADER_LENGTH ) &&
+                 ( pFrame->pFrame[ 0 ] <= 3 ) &&
+                 ( Stun_ReadUint32( &( pFrame->pFrame[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) == STUN_HEADER_MAGIC_COOKIE );
+
+        if( isStun != 0 )
+        {
+            pFrame->frameType = STUN_FRAME_TYPE_STUN;
+        }
+        else if( ( pFrame->frameLength >= STUN_CHANNEL_DATA_HEADER_LENGTH ) &&
+                 STUN_FIRST_BYTE_IS_CHANNEL_DATA( pFrame->pFrame[ 0 ] ) )
+        {
+            pFrame->frameType = STUN_FRAME_TYPE_CHANNEL_DATA;
+        }
+        else
+        {
+            pFrame->frameType = STUN_FRAME_TYPE_OTHER;
+        }
+    }
+    else if( STUN_FIRST_BYTE_IS_STUN( pBuffer[ 0 ] ) )
+    {
+        if( Stun_ReadUint32( &( pBuffer[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) != STUN_HEADER_MAGIC_COOKIE )
+        {
+            result = STUN_RESULT_INVALID_FRAME;
+        }
+        else
+        {
+            pFrame->frameType = STUN_FRAME_TYPE_STUN;
+            pFrame->pFrame = pBuffer;
+            pFrame->frameLength = frameLength;
+        }
+    }
+    else
+    {
+        /* Including the padding, which StunChannelData_Deserialize checks
+         * for STUN_TRANSPORT_TCP. */
+        pFrame->frameType = STUN_FRAME_TYPE_CHANNEL_DATA;
+        pFrame->pFrame = pBuffer;
+        pFrame->frameLength = frameLength;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Continues the frame saved in the scratch buffer with bytes from the current
+ * chunk. */
+static StunResult_t AssembleFrame( StunFramerContext_t * pCtx,
+                                   StunFrame_t * pFrame )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t frameLength = 0, copyLength;
+
+    /* The length field itself may be split. */
+    copyLength = GetLengthFieldEnd( pCtx );
+
+    if( pCtx->scratchUsed < copyLength )
+    {
+        copyLength -= pCtx->scratchUsed;
+
+        if( copyLength > pCtx->chunkLength - pCtx->chunkIndex )
+        {
+            copyLength = pCtx->chunkLength - pCtx->chunkIndex;
+        }
+
+        memcpy( ( void * ) &( pCtx->pScratch[ pCtx->scratchUsed ] ),
+                ( const void * ) &( pCtx->pChunk[ pCtx->chunkIndex ] ),
+                copyLength );
+        pCtx->scratchUsed += copyLength;
+        pCtx->chunkIndex += copyLength;
+    }
+
+    result = GetFrameLength( pCtx, pCtx->pScratch, pCtx->scratchUsed, &( frameLength ) );
+
+    if( result == STUN_RESULT_OK )
+    {
+        copyLength = frameLength - pCtx->scratchUsed;
+
+        if( copyLength > pCtx->chunkLength - pCtx->chunkIndex )
+        {
+            copyLength = pCtx->chunkLength - pCtx->chunkIndex;
+        }
+
+        memcpy( ( void * ) &( pCtx->pScratch[ pCtx->scratchUsed ] ),
+                ( const void * ) &( pCtx->pChunk[ pCtx->chunkIndex ] ),
+                copyLength );
+        pCtx->scratchUsed += copyLength;
+        pCtx->chunkIndex += copyLength;
+
+        if( pCtx->scratchUsed < frameLength )
+        {
+            result = STUN_RESULT_NO_MORE_FRAME_FOUND;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pCtx->scratchUsed = 0;
+        result = FillFrame( pCtx, pCtx->pScratch, frameLength, pFrame );
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunFramer_Init( StunFramerContext_t * pCtx,
+                              StunFramingMode_t framingMode,
+                              uint8_t * pScratch,
+                              size_t scratchLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pScratch == NULL ) ||
+        ( scratchLength < STUN_HEADER_LENGTH ) ||
+        ( ( framingMode != STUN_FRAMING_MODE_TURN ) &&
+          ( framingMode != STUN_FRAMING_MODE_RFC4571 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pCtx, 0, sizeof( StunFramerContext_t ) );
+
+        pCtx->framingMode = framingMode;
+        pCtx->pScratch = pScratch;
+        pCtx->scratchLength = scratchLength;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_FRAMER_INIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunFramer_AddChunk( StunFramerContext_t * pCtx,
+                                  const uint8_t * pChunk,
+                                  size_t chunkLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( ( pChunk == NULL ) && ( chunkLength > 0 ) ) ||
+        ( pCtx->chunkIndex != pCtx->chunkLength ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pCtx->pChunk = pChunk;
+        pCtx->chunkLength = chunkLength;
+        pCtx->chunkIndex = 0;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_FRAMER_ADD_CHUNK, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunFramer_GetNextFrame( StunFramerContext_t * pCtx,
+                                      StunFrame_t * pFrame )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const uint8_t * pBuffer;
+    size_t available, frameLength = 0;
+
+    if( ( pCtx == NULL ) ||
+        ( pFrame == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        available = pCtx->chunkLength - pCtx->chunkIndex;
+
+        if( available == 0 )
+        {
+            result = STUN_RESULT_NO_MORE_FRAME_FOUND;
+        }
+        else if( pCtx->scratchUsed > 0 )
+        {
+            result = AssembleFrame( pCtx, pFrame );
+        }
+        else
+        {
+            pBuffer = &( pCtx->pChunk[ pCtx->chunkIndex ] );
+            result = GetFrameLength( pCtx, pBuffer, available, &( frameLength ) );
+
+            if( ( result == STUN_RESULT_OK ) &&
+                ( frameLength <= available ) )
+            {
+                /* Complete frame in the chunk - no copy. */
+                pCtx->chunkIndex += frameLength;
+                result = FillFrame( pCtx, pBuffer, frameLength, pFrame );
+            }
+            else if( ( result == STUN_RESULT_OK ) ||
+                     ( result == STUN_RESULT_NO_MORE_FRAME_FOUND ) )
+            {
+                /* Only the start of the frame is here. Keep it for the next
+                 * chunk. GetFrameLength made sure that it fits. */
+                memcpy( ( void * ) pCtx->pScratch, ( const void * ) pBuffer, available );
+                pCtx->scratchUsed = available;
+                pCtx->chunkIndex = pCtx->chunkLength;
+                result = STUN_RESULT_NO_MORE_FRAME_FOUND;
+            }
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_FRAMER_GET_NEXT_FRAME, result );
+}
+
+/*-----------------------------------------------------------*/
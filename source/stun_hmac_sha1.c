@@ -0,0 +1,428 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_hmac_sha1.h"
+#include "stun_endianness.h"
+#include "stun_stats.h"
+
+#define STUN_HMAC_IPAD                  0x36
+#define STUN_HMAC_OPAD                  0x5C
+
+/* Room needed after the data in the last block for the 0x80 terminator and
+ * the 64-bit bit count. */
+#define STUN_SHA1_LENGTH_FIELD_SIZE     8
+
+#define STUN_SHA1_ROTATE_LEFT( value, bits )    ( ( ( value ) << ( bits ) ) | ( ( value ) >> ( 32 - ( bits ) ) ) )
+
+/*-----------------------------------------------------------*/
+
+static void Sha1Compress( uint32_t * pState,
+                          const uint8_t * pBlock );
+
+static void Sha1Update( uint32_t * pState,
+                        uint64_t * pTotalLength,
+                        uint8_t * pBlock,
+                        size_t * pBlockLength,
+                        const uint8_t * pData,
+                        size_t dataLength );
+
+static void Sha1Finish( uint32_t * pState,
+                        uint64_t totalLength,
+                        uint8_t * pBlock,
+                        size_t blockLength,
+                        uint8_t * pDigest );
+
+static void Sha1InitState( uint32_t * pState );
+
+/*-----------------------------------------------------------*/
+
+static void Sha1InitState( uint32_t * pState )
+{
+    pState[ 0 ] = 0x67452301;
+    pState[ 1 ] = 0xEFCDAB89;
+    pState[ 2 ] = 0x98BADCFE;
+    pState[ 3 ] = 0x10325476;
+    pState[ 4 ] = 0xC3D2E1F0;
+}
+/*-----------------------------------------------------------*/
+
+static void Sha1Compress( uint32_t * pState,
+                          const uint8_t * pBlock )
+{
+    uint32_t w[ 16 ];
+    uint32_t a, b, c, d, e, f, k, temp;
+    int i;
+
+    for( i = 0; i < 16; i++ )
+    {
+        w[ i ] = Stun_ReadUint32( &( pBlock[ i * 4 ] ) );
+    }
+
+    a = pState[ 0 ];
+    b = pState[ 1 ];
+    c = pState[ 2 ];
+    d = pState[ 3 ];
+    e = pState[ 4 ];
+
+    /* The message schedule is kept in a 16 word circular buffer. */
+    for( i = 0; i < 80; i++ )
+    {
+        if( i >= 16 )
+        {
+            temp = w[ ( i + 13 ) & 15 ] ^ w[ ( i + 8 ) & 15 ] ^ w[ ( i + 2 ) & 15 ] ^ w[ i & 15 ];
+            w[ i & 15 ] = STUN_SHA1_ROTATE_LEFT( temp, 1 );
+        }
+
+        if( i < 20 )
+        {
+            f = ( b & c ) | ( ~b & d );
+            k = 0x5A827999;
+        }
+        else if( i < 40 )
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if( i < 60 )
+        {
+            f = ( b & c ) | ( b & d ) | ( c & d );
+            k = 0x8F1BBCDC;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        temp = STUN_SHA1_ROTATE_LEFT( a, 5 ) + f + e + k + w[ i & 15 ];
+        e = d;
+        d = c;
+        c = STUN_SHA1_ROTATE_LEFT( b, 30 );
+        b = a;
+        a = temp;
+    }
+
+    pState[ 0 ] += a;
+    pState[ 1 ] += b;
+    pState[ 2 ] += c;
+    pState[ 3 ] += d;
+    pState[ 4 ] += e;
+}
+/*-----------------------------------------------------------*/
+
+static void Sha1Update( uint32_t * pState,
+                        uint64_t * pTotalLength,
+                        uint8_t * pBlock,
+                        size_t * pBlockLength,
+                        const uint8_t * pData,
+                        size_t dataLength )
+{
+    size_t blockLength = *pBlockLength, copyLength;
+
+    *pTotalLength += dataLength;
+
+    /* Top up a partially filled block first. */
+    if( blockLength > 0 )
+    {
+        copyLength = STUN_SHA1_BLOCK_LENGTH - blockLength;
+
+        if( copyLength > dataLength )
+        {
+            copyLength = dataLength;
+        }
+
+        memcpy( ( void * ) &( pBlock[ blockLength ] ), ( const void * ) pData, copyLength );
+        blockLength += copyLength;
+        pData += copyLength;
+        dataLength -= copyLength;
+
+        if( blockLength == STUN_SHA1_BLOCK_LENGTH )
+        {
+            Sha1Compress( pState, pBlock );
+            blockLength = 0;
+        }
+    }
+
+    /* Whole blocks are compressed straight from the caller's buffer. */
+    while( dataLength >= STUN_SHA1_BLOCK_LENGTH )
+    {
+        Sha1Compress( pState, pData );
+        pData += STUN_SHA1_BLOCK_LENGTH;
+        dataLength -= STUN_SHA1_BLOCK_LENGTH;
+    }
+
+    if( dataLength > 0 )
+    {
+        memcpy( ( void * ) &( pBlock[ blockLength ] ), ( const void * ) pData, dataLength );
+        blockLength += dataLength;
+    }
+
+    *pBlockLength = blockLength;
+}
+/*-----------------------------------------------------------*/
+
+static void Sha1Finish( uint32_t * pState,
+                        uint64_t totalLength,
+                        uint8_t * pBlock,
+                        size_t blockLength,
+                        uint8_t * pDigest )
+{
+    int i;
+
+    pBlock[ blockLength ] = 0x80;
+    blockLength++;
+
+    if( blockLength > STUN_SHA1_BLOCK_LENGTH - STUN_SHA1_LENGTH_FIELD_SIZE )
+    {
+        memset( ( void * ) &( pBlock[ blockLength ] ), 0, STUN_SHA1_BLOCK_LENGTH - blockLength );
+        Sha1Compress( pState, pBlock );
+        blockLength = 0;
+    }
+
+    memset( ( void * ) &( pBlock[ blockLength ] ), 0, STUN_SHA1_BLOCK_LENGTH - STUN_SHA1_LENGTH_FIELD_SIZE - blockLength );
+    Stun_WriteUint64( &( pBlock[ STUN_SHA1_BLOCK_LENGTH - STUN_SHA1_LENGTH_FIELD_SIZE ] ), totalLength * 8 );
+    Sha1Compress( pState, pBlock );
+
+    for( i = 0; i < 5; i++ )
+    {
+        Stun_WriteUint32( &( pDigest[ i * 4 ] ), pState[ i ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_InitKey( StunHmacKey_t * pHmacKey,
+                               const uint8_t * pKey,
+                               size_t keyLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t block[ STUN_SHA1_BLOCK_LENGTH ];
+    uint8_t paddedKey[ STUN_SHA1_BLOCK_LENGTH ];
+    uint64_t totalLength = 0;
+    size_t blockLength = 0;
+    int i;
+
+    if( ( pHmacKey == NULL ) ||
+        ( ( pKey == NULL ) && ( keyLength > 0 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) &( paddedKey[ 0 ] ), 0, sizeof( paddedKey ) );
+
+        /* Keys longer than a block are replaced by their SHA-1 digest. */
+        if( keyLength > STUN_SHA1_BLOCK_LENGTH )
+        {
+            Sha1InitState( &( pHmacKey->innerState[ 0 ] ) );
+            Sha1Update( &( pHmacKey->innerState[ 0 ] ), &totalLength, &( block[ 0 ] ), &blockLength, pKey, keyLength );
+            Sha1Finish( &( pHmacKey->innerState[ 0 ] ), totalLength, &( block[ 0 ] ), blockLength, &( paddedKey[ 0 ] ) );
+        }
+        else if( keyLength > 0 )
+        {
+            memcpy( ( void * ) &( paddedKey[ 0 ] ), ( const void * ) pKey, keyLength );
+        }
+
+        for( i = 0; i < STUN_SHA1_BLOCK_LENGTH; i++ )
+        {
+            block[ i ] = paddedKey[ i ] ^ STUN_HMAC_IPAD;
+        }
+
+        Sha1InitState( &( pHmacKey->innerState[ 0 ] ) );
+        Sha1Compress( &( pHmacKey->innerState[ 0 ] ), &( block[ 0 ] ) );
+
+        for( i = 0; i < STUN_SHA1_BLOCK_LENGTH; i++ )
+        {
+            block[ i ] = paddedKey[ i ] ^ STUN_HMAC_OPAD;
+        }
+
+        Sha1InitState( &( pHmacKey->outerState[ 0 ] ) );
+        Sha1Compress( &( pHmacKey->outerState[ 0 ] ), &( block[ 0 ] ) );
+
+        /* Do not leave key material on the stack. */
+        memset( ( void * ) &( paddedKey[ 0 ] ), 0, sizeof( paddedKey ) );
+        memset( ( void * ) &( block[ 0 ] ), 0, sizeof( block ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_INIT_KEY, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_Start( StunHmacContext_t * pHmacCtx,
+                             const StunHmacKey_t * pHmacKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pHmacCtx == NULL ) ||
+        ( pHmacKey == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pHmacCtx->pHmacKey = pHmacKey;
+        memcpy( ( void * ) &( pHmacCtx->state[ 0 ] ),
+                ( const void * ) &( pHmacKey->innerState[ 0 ] ),
+                sizeof( pHmacCtx->state ) );
+
+        /* The inner state already covers one block, the key XOR ipad. */
+        pHmacCtx->totalLength = STUN_SHA1_BLOCK_LENGTH;
+        pHmacCtx->blockLength = 0;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_START, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_Update( StunHmacContext_t * pHmacCtx,
+                              const uint8_t * pData,
+                              size_t dataLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pHmacCtx == NULL ) ||
+        ( ( pData == NULL ) && ( dataLength > 0 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) && ( dataLength > 0 ) )
+    {
+        Sha1Update( &( pHmacCtx->state[ 0 ] ),
+                    &( pHmacCtx->totalLength ),
+                    &( pHmacCtx->block[ 0 ] ),
+                    &( pHmacCtx->blockLength ),
+                    pData,
+                    dataLength );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_UPDATE, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_Finish( StunHmacContext_t * pHmacCtx,
+                              uint8_t * pHmac )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t innerDigest[ STUN_SHA1_DIGEST_LENGTH ];
+
+    if( ( pHmacCtx == NULL ) ||
+        ( pHmac == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        Sha1Finish( &( pHmacCtx->state[ 0 ] ),
+                    pHmacCtx->totalLength,
+                    &( pHmacCtx->block[ 0 ] ),
+                    pHmacCtx->blockLength,
+                    &( innerDigest[ 0 ] ) );
+
+        /* The outer hash is the outer state plus the single, always partial,
+         * block holding the inner digest. */
+        memcpy( ( void * ) &( pHmacCtx->state[ 0 ] ),
+                ( const void * ) &( pHmacCtx->pHmacKey->outerState[ 0 ] ),
+                sizeof( pHmacCtx->state ) );
+        memcpy( ( void * ) &( pHmacCtx->block[ 0 ] ),
+                ( const void * ) &( innerDigest[ 0 ] ),
+                STUN_SHA1_DIGEST_LENGTH );
+
+        Sha1Finish( &( pHmacCtx->state[ 0 ] ),
+                    STUN_SHA1_BLOCK_LENGTH + STUN_SHA1_DIGEST_LENGTH,
+                    &( pHmacCtx->block[ 0 ] ),
+                    STUN_SHA1_DIGEST_LENGTH,
+                    pHmac );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_FINISH, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_Sign( const StunHmacKey_t * pHmacKey,
+                            const uint8_t * pData,
+                            size_t dataLength,
+                            uint8_t * pHmac )
+{
+    StunResult_t result;
+    StunHmacContext_t hmacCtx;
+
+    result = StunHmac_Start( &( hmacCtx ), pHmacKey );
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Update( &( hmacCtx ), pData, dataLength );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Finish( &( hmacCtx ), pHmac );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_SIGN, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_VerifyFinish( StunHmacContext_t * pHmacCtx,
+                                    const uint8_t * pExpectedHmac )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t hmac[ STUN_HMAC_VALUE_LENGTH ];
+    uint8_t difference = 0;
+    int i;
+
+    if( pExpectedHmac == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Finish( pHmacCtx, &( hmac[ 0 ] ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        /* Look at every byte so that the time taken does not depend on
+         * where the first difference is. */
+        for( i = 0; i < STUN_HMAC_VALUE_LENGTH; i++ )
+        {
+            difference |= ( uint8_t ) ( hmac[ i ] ^ pExpectedHmac[ i ] );
+        }
+
+        if( difference != 0 )
+        {
+            result = STUN_RESULT_INTEGRITY_MISMATCH;
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_VERIFY_FINISH, result );
+}
+/*-----------------------------------------------------------*/
+
+StunResult_t StunHmac_Verify( const StunHmacKey_t * pHmacKey,
+                              const uint8_t * pData,
+                              size_t dataLength,
+                              const uint8_t * pExpectedHmac )
+{
+    StunResult_t result;
+    StunHmacContext_t hmacCtx;
+
+    result = StunHmac_Start( &( hmacCtx ), pHmacKey );
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Update( &( hmacCtx ), pData, dataLength );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_VerifyFinish( &( hmacCtx ), pExpectedHmac );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_HMAC_VERIFY, result );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,404 @@
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+#if !defined( STUN_RANDOM_GET_ENTROPY )
+    #if defined( __linux__ )
+        #include <errno.h>
+        #include <sys/random.h>
+    #endif
+#endif
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    #include <pthread.h>
+    #define STUN_RANDOM_HAS_FORK    1
+#endif
+
+/* API includes. */
+#include "stun_random.h"
+#include "stun_stats.h"
+
+/* ChaCha20 state and key sizes, in 32-bit words, and block length, in bytes. */
+#define CHACHA20_STATE_WORDS    16
+#define CHACHA20_KEY_WORDS      8
+#define CHACHA20_BLOCK_LENGTH   64
+
+/* ChaCha20 blocks generated together. The blocks are computed side by side,
+ * one per lane of a GCC vector, which is SIMD code on targets with SIMD (two
+ * SSE2 or NEON registers per vector) and scalar code on the others. */
+#define CHACHA20_LANES    8
+
+/* Output generated per refill. The first CHACHA20_KEY_WORDS words become the
+ * next key and the rest is handed out. */
+#define STUN_RANDOM_BUFFER_LENGTH    ( CHACHA20_LANES * CHACHA20_BLOCK_LENGTH )
+#define STUN_RANDOM_KEY_LENGTH       ( CHACHA20_KEY_WORDS * sizeof( uint32_t ) )
+
+typedef uint32_t ChaCha20Vector_t __attribute__( ( vector_size( CHACHA20_LANES * sizeof( uint32_t ) ) ) );
+
+#define ROTATE_LEFT( value, bits )    ( ( ( value ) << ( bits ) ) | ( ( value ) >> ( 32 - ( bits ) ) ) )
+
+typedef struct StunRandomState
+{
+    uint32_t key[ CHACHA20_KEY_WORDS ];
+    uint64_t counter;
+    uint8_t buffer[ STUN_RANDOM_BUFFER_LENGTH ];
+    size_t available;        /* Unused bytes at the end of buffer. */
+    size_t bytesSinceReseed;
+    uint32_t forkGeneration; /* Value of stunRandomForkGeneration when seeded. */
+    uint8_t isSeeded;
+} StunRandomState_t;
+
+static __thread StunRandomState_t stunRandomState;
+
+#if defined( STUN_RANDOM_HAS_FORK )
+    /* Incremented in the child after every fork, so that threads reseed
+     * instead of repeating the output of the parent. */
+    static uint32_t stunRandomForkGeneration = 0;
+    static pthread_once_t stunRandomForkHandlerOnce = PTHREAD_ONCE_INIT;
+#endif
+
+/*-----------------------------------------------------------*/
+
+static int GetEntropy( uint8_t * pBuffer,
+                       size_t length );
+
+static void QuarterRound( ChaCha20Vector_t * pA,
+                          ChaCha20Vector_t * pB,
+                          ChaCha20Vector_t * pC,
+                          ChaCha20Vector_t * pD );
+
+static void ChaCha20Blocks( const uint32_t * pKey,
+                            uint64_t counter,
+                            uint8_t * pOutput );
+
+static void Refill( StunRandomState_t * pState );
+
+static StunResult_t Reseed( StunRandomState_t * pState );
+
+#if defined( STUN_RANDOM_HAS_FORK )
+    static void OnFork( void );
+    static void RegisterForkHandler( void );
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Returns 0 if pBuffer was filled. */
+static int GetEntropy( uint8_t * pBuffer,
+                       size_t length )
+{
+    int status = 0;
+
+    #if defined( STUN_RANDOM_GET_ENTROPY )
+        status = STUN_RANDOM_GET_ENTROPY( pBuffer, length );
+    #elif defined( __linux__ )
+        ssize_t readLength;
+        size_t offset = 0;
+
+        while( ( status == 0 ) && ( offset < length ) )
+        {
+            readLength = getrandom( ( void * ) &( pBuffer[ offset ] ), length - offset, 0 );
+
+            if( readLength > 0 )
+            {
+                offset += ( size_t ) readLength;
+            }
+            else if( ( readLength < 0 ) && ( errno != EINTR ) )
+            {
+                status = -1;
+            }
+        }
+    #else
+        FILE * pFile = fopen( "/dev/urandom", "rb" );
+
+        if( ( pFile == NULL ) ||
+            ( fread( ( void * ) pBuffer, 1, length, pFile ) != length ) )
+        {
+            status = -1;
+        }
+
+        if( pFile != NULL )
+        {
+            ( void ) fclose( pFile );
+        }
+    #endif /* if defined( STUN_RANDOM_GET_ENTROPY ) */
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Quarter round of the CHACHA20_LANES blocks. */
+static void QuarterRound( ChaCha20Vector_t * pA,
+                          ChaCha20Vector_t * pB,
+                          ChaCha20Vector_t * pC,
+                          ChaCha20Vector_t * pD )
+{
+    *pA += *pB;
+    *pD ^= *pA;
+    *pD = ROTATE_LEFT( *pD, 16 );
+    *pC += *pD;
+    *pB ^= *pC;
+    *pB = ROTATE_LEFT( *pB, 12 );
+    *pA += *pB;
+    *pD ^= *pA;
+    *pD = ROTATE_LEFT( *pD, 8 );
+    *pC += *pD;
+    *pB ^= *pC;
+    *pB = ROTATE_LEFT( *pB, 7 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Generates CHACHA20_LANES blocks, from block counter on, into pOutput. */
+static void ChaCha20Blocks( const uint32_t * pKey,
+                            uint64_t counter,
+                            uint8_t * pOutput )
+{
+    ChaCha20Vector_t input[ CHACHA20_STATE_WORDS ], x[ CHACHA20_STATE_WORDS ];
+    uint32_t word;
+    int i, lane;
+
+    /* "expand 32-byte k", the key, a 64-bit block counter and a zero nonce. */
+    for( lane = 0; lane < CHACHA20_LANES; lane++ )
+    {
+        input[ 0 ][ lane ] = 0x61707865U;
+        input[ 1 ][ lane ] = 0x3320646EU;
+        input[ 2 ][ lane ] = 0x79622D32U;
+        input[ 3 ][ lane ] = 0x6B206574U;
+
+        for( i = 0; i < CHACHA20_KEY_WORDS; i++ )
+        {
+            input[ 4 + i ][ lane ] = pKey[ i ];
+        }
+
+        input[ 12 ][ lane ] = ( uint32_t ) ( counter + ( uint64_t ) lane );
+        input[ 13 ][ lane ] = ( uint32_t ) ( ( counter + ( uint64_t ) lane ) >> 32 );
+        input[ 14 ][ lane ] = 0;
+        input[ 15 ][ lane ] = 0;
+    }
+
+    memcpy( ( void * ) &( x[ 0 ] ), ( const void * ) &( input[ 0 ] ), sizeof( x ) );
+
+    for( i = 0; i < 10; i++ )
+    {
+        /* Column round. */
+        QuarterRound( &( x[ 0 ] ), &( x[ 4 ] ), &( x[ 8 ] ), &( x[ 12 ] ) );
+        QuarterRound( &( x[ 1 ] ), &( x[ 5 ] ), &( x[ 9 ] ), &( x[ 13 ] ) );
+        QuarterRound( &( x[ 2 ] ), &( x[ 6 ] ), &( x[ 10 ] ), &( x[ 14 ] ) );
+        QuarterRound( &( x[ 3 ] ), &( x[ 7 ] ), &( x[ 11 ] ), &( x[ 15 ] ) );
+
+        /* Diagonal round. */
+        QuarterRound( &( x[ 0 ] ), &( x[ 5 ] ), &( x[ 10 ] ), &( x[ 15 ] ) );
+        QuarterRound( &( x[ 1 ] ), &( x[ 6 ] ), &( x[ 11 ] ), &( x[ 12 ] ) );
+        QuarterRound( &( x[ 2 ] ), &( x[ 7 ] ), &( x[ 8 ] ), &( x[ 13 ] ) );
+        QuarterRound( &( x[ 3 ] ), &( x[ 4 ] ), &( x[ 9 ] ), &( x[ 14 ] ) );
+    }
+
+    for( i = 0; i < CHACHA20_STATE_WORDS; i++ )
+    {
+        x[ i ] += input[ i ];
+    }
+
+    /* The output words are little endian. */
+    for( lane = 0; lane < CHACHA20_LANES; lane++ )
+    {
+        for( i = 0; i < CHACHA20_STATE_WORDS; i++ )
+        {
+            word = x[ i ][ lane ];
+            #if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ )
+                word = __builtin_bswap32( word );
+            #endif
+            memcpy( ( void * ) pOutput, ( const void * ) &( word ), sizeof( word ) );
+            pOutput += sizeof( uint32_t );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void Refill( StunRandomState_t * pState )
+{
+    ChaCha20Blocks( &( pState->key[ 0 ] ), pState->counter, &( pState->buffer[ 0 ] ) );
+    pState->counter += CHACHA20_LANES;
+
+    /* Replace the key right away, so that the output handed out cannot be
+     * generated again from the state. */
+    memcpy( ( void * ) &( pState->key[ 0 ] ), ( const void * ) &( pState->buffer[ 0 ] ), STUN_RANDOM_KEY_LENGTH );
+    memset( ( void * ) &( pState->buffer[ 0 ] ), 0, STUN_RANDOM_KEY_LENGTH );
+    pState->available = STUN_RANDOM_BUFFER_LENGTH - STUN_RANDOM_KEY_LENGTH;
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t Reseed( StunRandomState_t * pState )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint32_t entropy[ CHACHA20_KEY_WORDS ];
+    int i;
+
+    #if defined( STUN_RANDOM_HAS_FORK )
+        ( void ) pthread_once( &( stunRandomForkHandlerOnce ), RegisterForkHandler );
+    #endif
+
+    if( GetEntropy( ( uint8_t * ) &( entropy[ 0 ] ), sizeof( entropy ) ) != 0 )
+    {
+        result = STUN_RESULT_ENTROPY_SOURCE_FAILED;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        /* Mixed into the key, so a reseed never makes the key weaker. */
+        for( i = 0; i < CHACHA20_KEY_WORDS; i++ )
+        {
+            pState->key[ i ] ^= entropy[ i ];
+        }
+
+        memset( ( void * ) &( entropy[ 0 ] ), 0, sizeof( entropy ) );
+        memset( ( void * ) &( pState->buffer[ 0 ] ), 0, sizeof( pState->buffer ) );
+        pState->counter = 0;
+        pState->available = 0;
+        pState->bytesSinceReseed = 0;
+        pState->isSeeded = 1;
+
+        #if defined( STUN_RANDOM_HAS_FORK )
+            pState->forkGeneration = __atomic_load_n( &( stunRandomForkGeneration ), __ATOMIC_RELAXED );
+        #endif
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( STUN_RANDOM_HAS_FORK )
+
+    static void OnFork( void )
+    {
+        __atomic_fetch_add( &( stunRandomForkGeneration ), 1U, __ATOMIC_RELAXED );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void RegisterForkHandler( void )
+    {
+        ( void ) pthread_atfork( NULL, NULL, OnFork );
+    }
+
+#endif /* if defined( STUN_RANDOM_HAS_FORK ) */
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunRandom_Fill( uint8_t * pBuffer,
+                              size_t length )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunRandomState_t * pState = &( stunRandomState );
+    uint8_t * pOutput;
+    size_t copyLength;
+    int isStale;
+
+    if( ( pBuffer == NULL ) &&
+        ( length > 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        isStale = ( pState->isSeeded == 0 ) ||
+                  ( pState->bytesSinceReseed >= STUN_RANDOM_RESEED_INTERVAL );
+
+        #if defined( STUN_RANDOM_HAS_FORK )
+            isStale = isStale ||
+                      ( pState->forkGeneration != __atomic_load_n( &( stunRandomForkGeneration ), __ATOMIC_RELAXED ) );
+        #endif
+
+        if( isStale != 0 )
+        {
+            result = Reseed( pState );
+        }
+    }
+
+    while( ( result == STUN_RESULT_OK ) &&
+           ( length > 0 ) )
+    {
+        if( pState->available == 0 )
+        {
+            Refill( pState );
+        }
+
+        copyLength = ( length < pState->available ) ? length : pState->available;
+        pOutput = &( pState->buffer[ STUN_RANDOM_BUFFER_LENGTH - pState->available ] );
+
+        memcpy( ( void * ) pBuffer, ( const void * ) pOutput, copyLength );
+        memset( ( void * ) pOutput, 0, copyLength );
+
+        pState->available -= copyLength;
+        pState->bytesSinceReseed += copyLength;
+        pBuffer += copyLength;
+        length -= copyLength;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_RANDOM_FILL, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunRandom_GenerateTransactionId( uint8_t * pTransactionId )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( pTransactionId == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunRandom_Fill( pTransactionId, STUN_HEADER_TRANSACTION_ID_LENGTH );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_RANDOM_GENERATE_TRANSACTION_ID, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunRandom_WriteTransactionId( StunContext_t * pCtx )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pCtx->currentIndex < STUN_HEADER_LENGTH ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunRandom_Fill( &( pCtx->pStart[ STUN_HEADER_TRANSACTION_ID_OFFSET ] ), STUN_HEADER_TRANSACTION_ID_LENGTH );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_RANDOM_WRITE_TRANSACTION_ID, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunRandom_GenerateTieBreaker( uint64_t * pTieBreaker )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( pTieBreaker == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunRandom_Fill( ( uint8_t * ) pTieBreaker, sizeof( uint64_t ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_RANDOM_GENERATE_TIE_BREAKER, result );
+}
+
+/*-----------------------------------------------------------*/
@@ -4,14 +4,36 @@
 
 /* API includes. */
 #include "stun_serializer.h"
+#include "stun_address.h"
+#include "stun_crc32.h"
+#include "stun_hmac_sha1.h"
+#include "stun_stats.h"
 
 /* Read/Write macros. */
-#define STUN_WRITE_UINT16   ( pCtx->readWriteFunctions.writeUint16Fn )
-#define STUN_WRITE_UINT32   ( pCtx->readWriteFunctions.writeUint32Fn )
-#define STUN_WRITE_UINT64   ( pCtx->readWriteFunctions.writeUint64Fn )
-#define STUN_READ_UINT16    ( pCtx->readWriteFunctions.readUint16Fn )
-#define STUN_READ_UINT32    ( pCtx->readWriteFunctions.readUint32Fn )
-#define STUN_READ_UINT64    ( pCtx->readWriteFunctions.readUint64Fn )
+#if defined( STUN_COMPILE_TIME_ENDIANNESS )
+    #define STUN_WRITE_UINT16   Stun_WriteUint16
+    #define STUN_WRITE_UINT32   Stun_WriteUint32
+    #define STUN_WRITE_UINT64   Stun_WriteUint64
+    #define STUN_READ_UINT16    Stun_ReadUint16
+    #define STUN_READ_UINT32    Stun_ReadUint32
+    #define STUN_READ_UINT64    Stun_ReadUint64
+#else
+    #define STUN_WRITE_UINT16   ( pCtx->readWriteFunctions.writeUint16Fn )
+    #define STUN_WRITE_UINT32   ( pCtx->readWriteFunctions.writeUint32Fn )
+    #define STUN_WRITE_UINT64   ( pCtx->readWriteFunctions.writeUint64Fn )
+    #define STUN_READ_UINT16    ( pCtx->readWriteFunctions.readUint16Fn )
+    #define STUN_READ_UINT32    ( pCtx->readWriteFunctions.readUint32Fn )
+    #define STUN_READ_UINT64    ( pCtx->readWriteFunctions.readUint64Fn )
+#endif
+
+/* True once a value is referenced in scatter-gather mode, after which the
+ * message is no longer contiguous in the context buffer. */
+#define STUN_HAS_REFERENCED_VALUES( pCtx ) \
+    ( ( ( pCtx )->pScatterGather != NULL ) && ( ( pCtx )->pScatterGather->referencedLength != 0U ) )
+
+/* Reserved attributes only need to be filled when the message is written. */
+#define STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) \
+    ( ( ( pCtx )->pStart != NULL ) && ( ( pCtx )->unfilledReservations != 0U ) )
 
 /*-----------------------------------------------------------*/
 
@@ -19,9 +41,6 @@
 static StunResult_t CheckAndUpdateAttributeFlag( StunContext_t * pCtx,
                                                  StunAttributeType_t attributeType );
 
-static StunResult_t XorAddress( StunContext_t * pCtx,
-                                StunAttributeAddress_t * pAddress );
-
 static StunResult_t AddAttributeTypeOnly( StunContext_t * pCtx,
                                           StunAttributeType_t attributeType );
 
@@ -38,6 +57,20 @@ static StunResult_t AddAttributeBuffer( StunContext_t * pCtx,
                                         const uint8_t * pAttributeValueBuffer,
                                         uint16_t attributeValueBufferLength );
 
+static void CloseScratchSegment( StunContext_t * pCtx,
+                                 size_t segmentEnd );
+
+static StunResult_t SignScatterGather( StunContext_t * pCtx,
+                                       const StunHmacKey_t * pHmacKey,
+                                       uint8_t * pHmac );
+
+static uint32_t Crc32ScatterGather( StunContext_t * pCtx );
+
+static StunResult_t FillReserved( StunContext_t * pCtx,
+                                  StunReservedAttribute_t * pReservedAttribute,
+                                  uint16_t valueLength,
+                                  uint8_t ** ppValue );
+
 /*-----------------------------------------------------------*/
 
 static StunResult_t CheckAndUpdateAttributeFlag( StunContext_t * pCtx,
@@ -70,6 +103,12 @@ static StunResult_t CheckAndUpdateAttributeFlag( StunContext_t * pCtx,
         {
             pCtx->attributeFlag |= STUN_FLAG_INTEGRITY_ATTRIBUTE;
         }
+
+        STUN_STATS_ADD( attributesSerialized[ STUN_ATTRIBUTE_TYPE_TO_SLOT( attributeType ) ], 1 );
+    }
+    else
+    {
+        STUN_STATS_ADD( attributeOrderViolations, 1 );
     }
 
     return result;
@@ -83,7 +122,11 @@ static StunResult_t AddAttributeBuffer( StunContext_t * pCtx,
                                         uint16_t attributeValueBufferLength )
 {
     StunResult_t result = STUN_RESULT_OK;
-    uint16_t attributeValueLengthPadded = STUN_ALIGN_SIZE_TO_WORD( attributeValueBufferLength );
+    size_t attributeValueLengthPadded = STUN_ALIGN_SIZE_TO_WORD( ( size_t ) attributeValueBufferLength );
+    StunScatterGather_t * pScatterGather;
+    size_t writtenLength = STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded );
+    size_t messageLength;
+    int isReference = 0;
 
     if( ( pCtx == NULL ) ||
         ( pAttributeValueBuffer == NULL ) ||
@@ -92,10 +135,47 @@ static StunResult_t AddAttributeBuffer( StunContext_t * pCtx,
         result = STUN_RESULT_BAD_PARAM;
     }
 
+    /* Whether the value is copied or referenced, the message must still fit
+     * its 16 bit length. */
+    if( result == STUN_RESULT_OK )
+    {
+        messageLength = pCtx->currentIndex + STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded );
+
+        if( pCtx->pScatterGather != NULL )
+        {
+            messageLength += pCtx->pScatterGather->referencedLength;
+        }
+
+        if( messageLength > ( STUN_HEADER_LENGTH + UINT16_MAX ) )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    /* The MESSAGE-INTEGRITY value is computed into a local buffer, so it is
+     * always copied. */
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pCtx->pScatterGather != NULL ) &&
+        ( attributeValueBufferLength >= STUN_SCATTER_GATHER_MIN_REFERENCE_LENGTH ) &&
+        ( attributeType != STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY ) )
+    {
+        isReference = 1;
+
+        /* Only the attribute header and the padding are written. */
+        writtenLength = STUN_ATTRIBUTE_HEADER_LENGTH + ( attributeValueLengthPadded - attributeValueBufferLength );
+
+        /* The part before the value, the value and the part at the end of the
+         * message. */
+        if( ( pCtx->pScatterGather->maxIovecs - pCtx->pScatterGather->iovecCount ) < 3U )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
     if( ( result == STUN_RESULT_OK ) &&
         ( pCtx->pStart != NULL ) )
     {
-        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded ) )
+        if( STUN_REMAINING_LENGTH( pCtx ) < writtenLength )
         {
             result = STUN_RESULT_OUT_OF_MEMORY;
         }
@@ -118,21 +198,41 @@ static StunResult_t AddAttributeBuffer( StunContext_t * pCtx,
             STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ),
                                attributeValueBufferLength );
 
-            memcpy( ( void * ) &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ),
-                    ( const void * ) pAttributeValueBuffer,
-                    attributeValueBufferLength );
-
-            /* Zero out the padded bytes. */
-            if( attributeValueLengthPadded > attributeValueBufferLength )
+            if( isReference != 0 )
             {
-                memset( ( void * ) &( pCtx->pStart[ pCtx->currentIndex +
-                                                    STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueBufferLength ) ] ),
+                pScatterGather = pCtx->pScatterGather;
+
+                CloseScratchSegment( pCtx,
+                                     pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH );
+
+                pScatterGather->pIovecs[ pScatterGather->iovecCount ].pBase = ( const void * ) pAttributeValueBuffer;
+                pScatterGather->pIovecs[ pScatterGather->iovecCount ].length = attributeValueBufferLength;
+                pScatterGather->iovecCount++;
+                pScatterGather->referencedLength += attributeValueBufferLength;
+
+                /* The padding starts the next part in the context buffer. */
+                memset( ( void * ) &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH ] ),
                         0,
                         attributeValueLengthPadded - attributeValueBufferLength );
             }
+            else
+            {
+                memcpy( ( void * ) &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ),
+                        ( const void * ) pAttributeValueBuffer,
+                        attributeValueBufferLength );
+
+                /* Zero out the padded bytes. */
+                if( attributeValueLengthPadded > attributeValueBufferLength )
+                {
+                    memset( ( void * ) &( pCtx->pStart[ pCtx->currentIndex +
+                                                        STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueBufferLength ) ] ),
+                            0,
+                            attributeValueLengthPadded - attributeValueBufferLength );
+                }
+            }
         }
 
-        pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded );
+        pCtx->currentIndex += writtenLength;
     }
 
     return result;
@@ -286,38 +386,140 @@ static StunResult_t AddAttributeUint64( StunContext_t * pCtx,
 
 /*-----------------------------------------------------------*/
 
-static StunResult_t XorAddress( StunContext_t * pCtx,
-                                StunAttributeAddress_t * pAddress )
+static void CloseScratchSegment( StunContext_t * pCtx,
+                                 size_t segmentEnd )
 {
-    StunResult_t result = STUN_RESULT_OK;
-    uint16_t msbMagic = ( STUN_HEADER_MAGIC_COOKIE >> 16 );
-    uint32_t word, xorWord, i;
-    uint8_t byte, xorByte;
+    StunScatterGather_t * pScatterGather = pCtx->pScatterGather;
 
-    if( pAddress == NULL ||
-        ( ( pAddress->family != STUN_ADDRESS_IPv4 ) &&
-          ( pAddress->family != STUN_ADDRESS_IPv6 ) ) )
+    /* Callers make sure that there is room for the part. */
+    if( segmentEnd > pScatterGather->segmentStart )
     {
-        result = STUN_RESULT_BAD_PARAM;
+        pScatterGather->pIovecs[ pScatterGather->iovecCount ].pBase = ( const void * ) &( pCtx->pStart[ pScatterGather->segmentStart ] );
+        pScatterGather->pIovecs[ pScatterGather->iovecCount ].length = segmentEnd - pScatterGather->segmentStart;
+        pScatterGather->iovecCount++;
+        pScatterGather->segmentStart = segmentEnd;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t SignScatterGather( StunContext_t * pCtx,
+                                       const StunHmacKey_t * pHmacKey,
+                                       uint8_t * pHmac )
+{
+    StunResult_t result;
+    StunHmacContext_t hmacCtx;
+    const StunScatterGather_t * pScatterGather = pCtx->pScatterGather;
+    size_t i;
+
+    /* Fix-up the packet length with message integrity and without the STUN
+     * header, as StunSerializer_GetIntegrityBuffer does. */
+    STUN_WRITE_UINT16( &( pCtx->pStart[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                       ( uint16_t ) ( pCtx->currentIndex +
+                                      pScatterGather->referencedLength -
+                                      STUN_HEADER_LENGTH +
+                                      STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_HMAC_VALUE_LENGTH ) ) );
+
+    result = StunHmac_Start( &( hmacCtx ),
+                             pHmacKey );
+
+    for( i = 0; ( result == STUN_RESULT_OK ) && ( i < pScatterGather->iovecCount ); i++ )
+    {
+        result = StunHmac_Update( &( hmacCtx ),
+                                  ( const uint8_t * ) pScatterGather->pIovecs[ i ].pBase,
+                                  pScatterGather->pIovecs[ i ].length );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunHmac_Update( &( hmacCtx ),
+                                  &( pCtx->pStart[ pScatterGather->segmentStart ] ),
+                                  pCtx->currentIndex - pScatterGather->segmentStart );
     }
 
     if( result == STUN_RESULT_OK )
     {
-        pAddress->port = msbMagic ^ pAddress->port;
+        result = StunHmac_Finish( &( hmacCtx ),
+                                  pHmac );
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t Crc32ScatterGather( StunContext_t * pCtx )
+{
+    const StunScatterGather_t * pScatterGather = pCtx->pScatterGather;
+    uint32_t crc32 = 0;
+    size_t i;
+
+    /* Fix-up the packet length with fingerprint CRC and without the STUN
+     * header, as StunSerializer_GetFingerprintBuffer does. */
+    STUN_WRITE_UINT16( &( pCtx->pStart[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                       ( uint16_t ) ( pCtx->currentIndex +
+                                      pScatterGather->referencedLength -
+                                      STUN_HEADER_LENGTH +
+                                      STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ATTRIBUTE_FINGERPRINT_LENGTH ) ) );
+
+    for( i = 0; i < pScatterGather->iovecCount; i++ )
+    {
+        crc32 = Stun_Crc32( crc32,
+                            ( const uint8_t * ) pScatterGather->pIovecs[ i ].pBase,
+                            pScatterGather->pIovecs[ i ].length );
+    }
+
+    if( pCtx->currentIndex > pScatterGather->segmentStart )
+    {
+        crc32 = Stun_Crc32( crc32,
+                            &( pCtx->pStart[ pScatterGather->segmentStart ] ),
+                            pCtx->currentIndex - pScatterGather->segmentStart );
+    }
+
+    return crc32;
+}
+
+/*-----------------------------------------------------------*/
+
+static StunResult_t FillReserved( StunContext_t * pCtx,
+                                  StunReservedAttribute_t * pReservedAttribute,
+                                  uint16_t valueLength,
+                                  uint8_t ** ppValue )
+{
+    StunResult_t result = STUN_RESULT_OK;
 
-        word = STUN_READ_UINT32( &( pAddress->address[ 0 ] ) );
-        xorWord = word ^ STUN_HEADER_MAGIC_COOKIE;
-        STUN_WRITE_UINT32( &( pAddress->address[ 0 ] ), xorWord );
+    if( ( pCtx == NULL ) ||
+        ( pReservedAttribute == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( valueLength != pReservedAttribute->valueLength )
+    {
+        result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+    }
+    else if( ( pCtx->attributeFlag & ( STUN_FLAG_INTEGRITY_ATTRIBUTE | STUN_FLAG_FINGERPRINT_ATTRIBUTE ) ) != 0 )
+    {
+        /* The value is covered by MESSAGE-INTEGRITY or FINGERPRINT. */
+        result = STUN_RESULT_INVALID_ATTRIBUTE_ORDER;
+    }
+    else if( ( pReservedAttribute->valueOffset < ( STUN_HEADER_LENGTH + STUN_ATTRIBUTE_HEADER_LENGTH ) ) ||
+             ( pReservedAttribute->valueOffset > pCtx->currentIndex ) ||
+             ( ( size_t ) valueLength > ( pCtx->currentIndex - pReservedAttribute->valueOffset ) ) )
+    {
+        /* Not reserved in this message. */
+        result = STUN_RESULT_BAD_PARAM;
+    }
 
-        if( pAddress->family == STUN_ADDRESS_IPv6 )
+    if( result == STUN_RESULT_OK )
+    {
+        if( pReservedAttribute->isFilled == 0U )
         {
-            for( i = 0; i < STUN_HEADER_TRANSACTION_ID_LENGTH; i++ )
-            {
-                byte = pAddress->address[ STUN_IPV4_ADDRESS_SIZE + i ];
-                xorByte = byte ^ pCtx->pStart[ STUN_HEADER_TRANSACTION_ID_OFFSET + i ];
-                pAddress->address[ STUN_IPV4_ADDRESS_SIZE + i ] = xorByte;
-            }
+            pReservedAttribute->isFilled = 1U;
+            pCtx->unfilledReservations--;
         }
+
+        /* NULL when only calculating the message size. */
+        *ppValue = ( pCtx->pStart != NULL ) ? &( pCtx->pStart[ pReservedAttribute->valueOffset ] ) : NULL;
     }
 
     return result;
@@ -335,19 +537,26 @@ StunResult_t StunSerializer_Init( StunContext_t * pCtx,
     if( ( pCtx == NULL ) ||
         ( pHeader == NULL ) ||
         ( ( pBuffer != NULL ) &&
-          ( bufferLength < STUN_HEADER_LENGTH ) ) )
+          ( ( bufferLength < STUN_HEADER_LENGTH ) ||
+            ( pHeader->pTransactionId == NULL ) ) ) )
     {
         result = STUN_RESULT_BAD_PARAM;
     }
 
     if( result == STUN_RESULT_OK )
     {
-        Stun_InitReadWriteFunctions( &( pCtx->readWriteFunctions ) );
+        #if !defined( STUN_COMPILE_TIME_ENDIANNESS )
+            Stun_InitReadWriteFunctions( &( pCtx->readWriteFunctions ) );
+        #endif
 
         pCtx->pStart = pBuffer;
         pCtx->totalLength = bufferLength;
         pCtx->currentIndex = 0;
         pCtx->attributeFlag = 0;
+        pCtx->pAttributeIndex = NULL;
+        pCtx->pUnknownAttributes = NULL;
+        pCtx->pScatterGather = NULL;
+        pCtx->unfilledReservations = 0;
 
         if( pCtx->pStart != NULL )
         {
@@ -365,11 +574,16 @@ StunResult_t StunSerializer_Init( StunContext_t * pCtx,
                     ( const void * ) &( pHeader->pTransactionId[ 0 ] ),
                     STUN_HEADER_TRANSACTION_ID_LENGTH );
         }
+    }
 
+    if( result == STUN_RESULT_OK )
+    {
         pCtx->currentIndex += STUN_HEADER_LENGTH;
+
+        STUN_STATS_ADD( messagesSerialized[ STUN_STATS_MESSAGE_TYPE_INDEX( pHeader->messageType ) ], 1 );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_INIT, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -421,10 +635,14 @@ StunResult_t StunSerializer_AddAttributeErrorCode( StunContext_t * pCtx,
             STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ),
                                reserved );
 
-            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
-                                                STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
-                                                STUN_ATTRIBUTE_ERROR_CODE_CLASS_OFFSET ] ),
-                               errorCode );
+            /* The error code is sent as its hundreds digit (the class) and
+             * the remainder (the number). */
+            pCtx->pStart[ pCtx->currentIndex +
+                          STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
+                          STUN_ATTRIBUTE_ERROR_CODE_CLASS_OFFSET ] = ( uint8_t ) ( errorCode / 100 );
+            pCtx->pStart[ pCtx->currentIndex +
+                          STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
+                          STUN_ATTRIBUTE_ERROR_CODE_NUMBER_OFFSET ] = ( uint8_t ) ( errorCode % 100 );
 
             memcpy( ( void * ) &( pCtx->pStart[ pCtx->currentIndex +
                                                 STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
@@ -445,7 +663,191 @@ StunResult_t StunSerializer_AddAttributeErrorCode( StunContext_t * pCtx,
         pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ERROR_CODE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_AddAttributeUnknownAttributes( StunContext_t * pCtx,
+                                                           const uint16_t * pAttributeTypes,
+                                                           uint16_t attributeTypeCount )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t attributeValueLength = ( uint16_t ) ( attributeTypeCount * sizeof( uint16_t ) );
+    uint16_t attributeValueLengthPadded = STUN_ALIGN_SIZE_TO_WORD( attributeValueLength );
+    uint16_t i;
+
+    if( ( pCtx == NULL ) ||
+        ( pAttributeTypes == NULL ) ||
+        ( attributeTypeCount == 0 ) ||
+        ( attributeTypeCount > ( UINT16_MAX / sizeof( uint16_t ) ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pCtx->pStart != NULL ) )
+    {
+        if( STUN_REMAINING_LENGTH( pCtx ) < ( size_t ) STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded ) )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = CheckAndUpdateAttributeFlag( pCtx,
+                                              STUN_ATTRIBUTE_TYPE_UNKNOWN_ATTRIBUTES );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( pCtx->pStart != NULL )
+        {
+            /* Write Attribute type, length and value. */
+            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex ] ),
+                               STUN_ATTRIBUTE_TYPE_UNKNOWN_ATTRIBUTES );
+
+            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ),
+                               attributeValueLength );
+
+            for( i = 0; i < attributeTypeCount; i++ )
+            {
+                STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
+                                                    STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
+                                                    ( i * sizeof( uint16_t ) ) ] ),
+                                   pAttributeTypes[ i ] );
+            }
+
+            /* Zero out the padded bytes. */
+            if( attributeValueLengthPadded > attributeValueLength )
+            {
+                memset( ( void * ) &( pCtx->pStart[ pCtx->currentIndex +
+                                                    STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLength ) ] ),
+                        0,
+                        attributeValueLengthPadded - attributeValueLength );
+            }
+        }
+
+        pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLengthPadded );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_UNKNOWN_ATTRIBUTES, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_InitUnknownAttributesResponse( StunContext_t * pCtx,
+                                                           uint8_t * pBuffer,
+                                                           size_t bufferLength,
+                                                           const StunHeader_t * pRequestHeader,
+                                                           const StunUnknownAttributes_t * pUnknownAttributes )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunHeader_t responseHeader;
+    static const char errorPhrase[] = "Unknown Attribute";
+
+    /* Only requests get an error response (RFC 8489, section 6.3.1). */
+    if( ( pRequestHeader == NULL ) ||
+        ( ( ( uint16_t ) pRequestHeader->messageType & STUN_MESSAGE_CLASS_MASK ) != STUN_MESSAGE_CLASS_REQUEST ) ||
+        ( pUnknownAttributes == NULL ) ||
+        ( pUnknownAttributes->count == 0 ) ||
+        ( pUnknownAttributes->count > STUN_UNKNOWN_ATTRIBUTES_MAX_COUNT ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        responseHeader.messageType = ( StunMessageType_t ) STUN_MESSAGE_TYPE_TO_ERROR_RESPONSE( pRequestHeader->messageType );
+        responseHeader.pTransactionId = pRequestHeader->pTransactionId;
+
+        result = StunSerializer_Init( pCtx,
+                                      pBuffer,
+                                      bufferLength,
+                                      &( responseHeader ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddAttributeErrorCode( pCtx,
+                                                       STUN_ERROR_CODE_UNKNOWN_ATTRIBUTE,
+                                                       ( const uint8_t * ) &( errorPhrase[ 0 ] ),
+                                                       ( uint16_t ) ( sizeof( errorPhrase ) - 1 ) );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddAttributeUnknownAttributes( pCtx,
+                                                               &( pUnknownAttributes->attributeTypes[ 0 ] ),
+                                                               pUnknownAttributes->count );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_INIT_UNKNOWN_ATTRIBUTES_RESPONSE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_InitResponseInPlace( StunContext_t * pCtx,
+                                                 uint8_t * pBuffer,
+                                                 size_t bufferLength,
+                                                 StunMessageType_t responseType )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint16_t requestType;
+
+    if( ( pCtx == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( bufferLength < STUN_HEADER_LENGTH ) ||
+        ( ( ( uint16_t ) responseType & STUN_MESSAGE_CLASS_MASK ) == STUN_MESSAGE_CLASS_REQUEST ) ||
+        ( ( ( uint16_t ) responseType & STUN_MESSAGE_CLASS_MASK ) == STUN_MESSAGE_CLASS_INDICATION ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        #if !defined( STUN_COMPILE_TIME_ENDIANNESS )
+            Stun_InitReadWriteFunctions( &( pCtx->readWriteFunctions ) );
+        #endif
+
+        requestType = STUN_READ_UINT16( &( pBuffer[ 0 ] ) );
+
+        if( STUN_READ_UINT32( &( pBuffer[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) != STUN_HEADER_MAGIC_COOKIE )
+        {
+            result = STUN_RESULT_MAGIC_COOKIE_MISMATCH;
+        }
+        else if( ( ( requestType & STUN_MESSAGE_CLASS_MASK ) != STUN_MESSAGE_CLASS_REQUEST ) ||
+                 ( ( requestType & ~STUN_MESSAGE_CLASS_MASK ) != ( ( uint16_t ) responseType & ~STUN_MESSAGE_CLASS_MASK ) ) )
+        {
+            result = STUN_RESULT_BAD_PARAM;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pCtx->pStart = pBuffer;
+        pCtx->totalLength = bufferLength;
+        pCtx->currentIndex = 0;
+        pCtx->attributeFlag = 0;
+        pCtx->pAttributeIndex = NULL;
+        pCtx->pUnknownAttributes = NULL;
+        pCtx->pScatterGather = NULL;
+        pCtx->unfilledReservations = 0;
+
+        STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex ] ),
+                           responseType );
+
+        /* Message length is updated in finalize. */
+        STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                           0 );
+
+        pCtx->currentIndex += STUN_HEADER_LENGTH;
+
+        STUN_STATS_ADD( messagesSerialized[ STUN_STATS_MESSAGE_TYPE_INDEX( responseType ) ], 1 );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_INIT_RESPONSE_IN_PLACE, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -502,23 +904,31 @@ StunResult_t StunSerializer_AddAttributeChannelNumber( StunContext_t * pCtx,
         pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLength );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANNEL_NUMBER, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeUseCandidate( StunContext_t * pCtx )
 {
-    return AddAttributeTypeOnly( pCtx,
-                                 STUN_ATTRIBUTE_TYPE_USE_CANDIDATE );
+    StunResult_t result;
+
+    result = AddAttributeTypeOnly( pCtx,
+                                   STUN_ATTRIBUTE_TYPE_USE_CANDIDATE );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_USE_CANDIDATE, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeDontFragment( StunContext_t * pCtx )
 {
-    return AddAttributeTypeOnly( pCtx,
-                                 STUN_ATTRIBUTE_TYPE_DONT_FRAGMENT );
+    StunResult_t result;
+
+    result = AddAttributeTypeOnly( pCtx,
+                                   STUN_ATTRIBUTE_TYPE_DONT_FRAGMENT );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_DONT_FRAGMENT, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -526,9 +936,13 @@ StunResult_t StunSerializer_AddAttributeDontFragment( StunContext_t * pCtx )
 StunResult_t StunSerializer_AddAttributePriority( StunContext_t * pCtx,
                                                   uint32_t priority )
 {
-    return AddAttributeUint32( pCtx,
-                               STUN_ATTRIBUTE_TYPE_PRIORITY,
-                               priority );
+    StunResult_t result;
+
+    result = AddAttributeUint32( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_PRIORITY,
+                                 priority );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_PRIORITY, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -536,9 +950,63 @@ StunResult_t StunSerializer_AddAttributePriority( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeFingerprint( StunContext_t * pCtx,
                                                      uint32_t crc32Fingerprint )
 {
-    return AddAttributeUint32( pCtx,
-                               STUN_ATTRIBUTE_TYPE_FINGERPRINT,
-                               crc32Fingerprint );
+    StunResult_t result;
+
+    result = AddAttributeUint32( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_FINGERPRINT,
+                                 crc32Fingerprint );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_FINGERPRINT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_AddFingerprint( StunContext_t * pCtx )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t * pStunMessage = NULL;
+    uint16_t stunMessageLength = 0;
+    uint32_t crc32Fingerprint = 0;
+
+    if( pCtx == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) )
+    {
+        result = STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( STUN_HAS_REFERENCED_VALUES( pCtx ) )
+        {
+            crc32Fingerprint = Crc32ScatterGather( pCtx ) ^ STUN_FINGERPRINT_XOR_VALUE;
+        }
+        else
+        {
+            result = StunSerializer_GetFingerprintBuffer( pCtx,
+                                                          &( pStunMessage ),
+                                                          &( stunMessageLength ) );
+
+            /* Nothing to compute when only calculating the message size. */
+            if( ( result == STUN_RESULT_OK ) &&
+                ( pCtx->pStart != NULL ) )
+            {
+                crc32Fingerprint = Stun_Crc32( 0,
+                                               pStunMessage,
+                                               stunMessageLength ) ^ STUN_FINGERPRINT_XOR_VALUE;
+            }
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddAttributeFingerprint( pCtx,
+                                                         crc32Fingerprint );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_FINGERPRINT, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -546,9 +1014,13 @@ StunResult_t StunSerializer_AddAttributeFingerprint( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeLifetime( StunContext_t * pCtx,
                                                   uint32_t lifetime )
 {
-    return AddAttributeUint32( pCtx,
-                               STUN_ATTRIBUTE_TYPE_LIFETIME,
-                               lifetime );
+    StunResult_t result;
+
+    result = AddAttributeUint32( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_LIFETIME,
+                                 lifetime );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_LIFETIME, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -556,9 +1028,13 @@ StunResult_t StunSerializer_AddAttributeLifetime( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeChangeRequest( StunContext_t * pCtx,
                                                        uint32_t changeFlag )
 {
-    return AddAttributeUint32( pCtx,
-                               STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST,
-                               changeFlag );
+    StunResult_t result;
+
+    result = AddAttributeUint32( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_CHANGE_REQUEST,
+                                 changeFlag );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGE_REQUEST, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -566,9 +1042,13 @@ StunResult_t StunSerializer_AddAttributeChangeRequest( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeIceControlled( StunContext_t * pCtx,
                                                        uint64_t tieBreaker )
 {
-    return AddAttributeUint64( pCtx,
-                               STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
-                               tieBreaker );
+    StunResult_t result;
+
+    result = AddAttributeUint64( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
+                                 tieBreaker );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ICE_CONTROLLED, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -576,9 +1056,13 @@ StunResult_t StunSerializer_AddAttributeIceControlled( StunContext_t * pCtx,
 StunResult_t StunSerializer_AddAttributeIceControlling( StunContext_t * pCtx,
                                                         uint64_t tieBreaker )
 {
-    return AddAttributeUint64( pCtx,
-                               STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING,
-                               tieBreaker );
+    StunResult_t result;
+
+    result = AddAttributeUint64( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING,
+                                 tieBreaker );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ICE_CONTROLLING, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -587,10 +1071,14 @@ StunResult_t StunSerializer_AddAttributeUsername( StunContext_t * pCtx,
                                                   const uint8_t * pUsername,
                                                   uint16_t usernameLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_USERNAME,
-                               pUsername,
-                               usernameLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_USERNAME,
+                                 pUsername,
+                                 usernameLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_USERNAME, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -599,10 +1087,14 @@ StunResult_t StunSerializer_AddAttributeData( StunContext_t * pCtx,
                                               const uint8_t * pData,
                                               uint16_t dataLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_DATA,
-                               pData,
-                               dataLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_DATA,
+                                 pData,
+                                 dataLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_DATA, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -611,10 +1103,14 @@ StunResult_t StunSerializer_AddAttributeRealm( StunContext_t * pCtx,
                                                const uint8_t * pRealm,
                                                uint16_t realmLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_REALM,
-                               pRealm,
-                               realmLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_REALM,
+                                 pRealm,
+                                 realmLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_REALM, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -623,10 +1119,14 @@ StunResult_t StunSerializer_AddAttributeNonce( StunContext_t * pCtx,
                                                const uint8_t * pNonce,
                                                uint16_t nonceLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_NONCE,
-                               pNonce,
-                               nonceLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_NONCE,
+                                 pNonce,
+                                 nonceLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_NONCE, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -635,10 +1135,14 @@ StunResult_t StunSerializer_AddAttributeRequestedTransport( StunContext_t * pCtx
                                                             const uint8_t * pRequestedTransport,
                                                             uint16_t requestedTransportLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_REQUESTED_TRANSPORT,
-                               pRequestedTransport,
-                               requestedTransportLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_REQUESTED_TRANSPORT,
+                                 pRequestedTransport,
+                                 requestedTransportLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_REQUESTED_TRANSPORT, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -647,21 +1151,84 @@ StunResult_t StunSerializer_AddAttributeIntegrity( StunContext_t * pCtx,
                                                    const uint8_t * pIntegrity,
                                                    uint16_t integrityLength )
 {
-    return AddAttributeBuffer( pCtx,
-                               STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY,
-                               pIntegrity,
-                               integrityLength );
+    StunResult_t result;
+
+    result = AddAttributeBuffer( pCtx,
+                                 STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY,
+                                 pIntegrity,
+                                 integrityLength );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_INTEGRITY, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_AddIntegrity( StunContext_t * pCtx,
+                                          const StunHmacKey_t * pHmacKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t * pStunMessage = NULL;
+    uint16_t stunMessageLength = 0;
+    uint8_t hmac[ STUN_HMAC_VALUE_LENGTH ];
+
+    if( ( pCtx == NULL ) ||
+        ( pHmacKey == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) )
+    {
+        result = STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( STUN_HAS_REFERENCED_VALUES( pCtx ) )
+        {
+            result = SignScatterGather( pCtx,
+                                        pHmacKey,
+                                        &( hmac[ 0 ] ) );
+        }
+        else
+        {
+            result = StunSerializer_GetIntegrityBuffer( pCtx,
+                                                        &( pStunMessage ),
+                                                        &( stunMessageLength ) );
+
+            /* Nothing to compute when only calculating the message size. */
+            if( ( result == STUN_RESULT_OK ) &&
+                ( pCtx->pStart != NULL ) )
+            {
+                result = StunHmac_Sign( pHmacKey,
+                                        pStunMessage,
+                                        stunMessageLength,
+                                        &( hmac[ 0 ] ) );
+            }
+            else
+            {
+                memset( ( void * ) &( hmac[ 0 ] ), 0, sizeof( hmac ) );
+            }
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = StunSerializer_AddAttributeIntegrity( pCtx,
+                                                       &( hmac[ 0 ] ),
+                                                       STUN_HMAC_VALUE_LENGTH );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_INTEGRITY, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeAddress( StunContext_t * pCtx,
-                                                 StunAttributeAddress_t * pAddress,
+                                                 const StunAttributeAddress_t * pAddress,
                                                  StunAttributeType_t attributeType )
 {
     StunResult_t result = STUN_RESULT_OK;
     uint16_t attributeValueLength = 0;
-    size_t addressLength;
 
     if( pAddress == NULL ||
         ( ( pAddress->family != STUN_ADDRESS_IPv4 ) &&
@@ -670,10 +1237,12 @@ StunResult_t StunSerializer_AddAttributeAddress( StunContext_t * pCtx,
         result = STUN_RESULT_BAD_PARAM;
     }
 
-    if( ( result == STUN_RESULT_OK ) &&
-        ( pCtx->pStart != NULL ) )
+    if( result == STUN_RESULT_OK )
     {
-        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLength ) )
+        attributeValueLength = STUN_ADDRESS_VALUE_LENGTH( pAddress->family );
+
+        if( ( pCtx->pStart != NULL ) &&
+            ( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLength ) ) )
         {
             result = STUN_RESULT_OUT_OF_MEMORY;
         }
@@ -681,23 +1250,10 @@ StunResult_t StunSerializer_AddAttributeAddress( StunContext_t * pCtx,
 
     if( result == STUN_RESULT_OK )
     {
-        attributeValueLength = STUN_ATTRIBUTE_ADDRESS_HEADER_LENGTH +
-                               ( ( pAddress->family == STUN_ADDRESS_IPv4 ) ? STUN_IPV4_ADDRESS_SIZE :
-                                                                             STUN_IPV6_ADDRESS_SIZE );
-
         result = CheckAndUpdateAttributeFlag( pCtx,
                                               attributeType );
     }
 
-    if( ( result == STUN_RESULT_OK ) &&
-        ( pCtx->pStart != NULL ) &&
-        ( ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS ) ||
-          ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS ) ||
-          ( attributeType == STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS ) ) )
-    {
-        XorAddress( pCtx, pAddress );
-    }
-
     if( result == STUN_RESULT_OK )
     {
         if( pCtx->pStart != NULL )
@@ -709,109 +1265,128 @@ StunResult_t StunSerializer_AddAttributeAddress( StunContext_t * pCtx,
             STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ),
                                attributeValueLength );
 
-            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
-                                                STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
-                                                STUN_ATTRIBUTE_ADDRESS_FAMILY_OFFSET ] ),
-                               pAddress->family );
-
-            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex +
-                                                STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
-                                                STUN_ATTRIBUTE_ADDRESS_PORT_OFFSET ] ),
-                               pAddress->port );
-
-            addressLength = ( pAddress->family == STUN_ADDRESS_IPv4 ) ? STUN_IPV4_ADDRESS_SIZE:
-                                                                        STUN_IPV6_ADDRESS_SIZE;
-            memcpy( ( void * ) &( pCtx->pStart[ pCtx->currentIndex +
-                                                STUN_ATTRIBUTE_HEADER_VALUE_OFFSET +
-                                                STUN_ATTRIBUTE_ADDRESS_IP_ADDRESS_OFFSET ] ),
-                    ( const void * ) &( pAddress->address[ 0 ] ),
-                    addressLength );
+            ( void ) StunAddress_Encode( pCtx->pStart,
+                                         pAddress,
+                                         STUN_ATTRIBUTE_IS_XOR_ADDRESS( attributeType ),
+                                         &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ) );
         }
 
         pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( attributeValueLength );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeMappedAddress( StunContext_t * pCtx,
-                                                       StunAttributeAddress_t * pMappedAddress )
+                                                       const StunAttributeAddress_t * pMappedAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pMappedAddress,
-                                               STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pMappedAddress,
+                                                 STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_MAPPED_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeResponseAddress( StunContext_t * pCtx,
-                                                         StunAttributeAddress_t * pResponseAddress )
+                                                         const StunAttributeAddress_t * pResponseAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pResponseAddress,
-                                               STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pResponseAddress,
+                                                 STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_RESPONSE_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeSourceAddress( StunContext_t * pCtx,
-                                                       StunAttributeAddress_t * pSourceAddress )
+                                                       const StunAttributeAddress_t * pSourceAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pSourceAddress,
-                                               STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pSourceAddress,
+                                                 STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_SOURCE_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeChangedAddress( StunContext_t * pCtx,
-                                                        StunAttributeAddress_t * pChangedAddress )
+                                                        const StunAttributeAddress_t * pChangedAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pChangedAddress,
-                                               STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pChangedAddress,
+                                                 STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGED_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeChangedReflectedFrom( StunContext_t * pCtx,
-                                                              StunAttributeAddress_t * pReflectedFromAddress )
+                                                              const StunAttributeAddress_t * pReflectedFromAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pReflectedFromAddress,
-                                               STUN_ATTRIBUTE_TYPE_REFLECTED_FROM );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pReflectedFromAddress,
+                                                 STUN_ATTRIBUTE_TYPE_REFLECTED_FROM );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_CHANGED_REFLECTED_FROM, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeXorMappedAddress( StunContext_t * pCtx,
-                                                          StunAttributeAddress_t * pMappedAddress )
+                                                          const StunAttributeAddress_t * pMappedAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pMappedAddress,
-                                               STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pMappedAddress,
+                                                 STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_MAPPED_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeXorPeerAddress( StunContext_t * pCtx,
-                                                        StunAttributeAddress_t * pPeerAddress )
+                                                        const StunAttributeAddress_t * pPeerAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pPeerAddress,
-                                               STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pPeerAddress,
+                                                 STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_PEER_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
 
 StunResult_t StunSerializer_AddAttributeXorRelayedAddress( StunContext_t * pCtx,
-                                                           StunAttributeAddress_t * pRelayedAddress )
+                                                           const StunAttributeAddress_t * pRelayedAddress )
 {
-    return StunSerializer_AddAttributeAddress( pCtx,
-                                               pRelayedAddress,
-                                               STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS );
+    StunResult_t result;
+
+    result = StunSerializer_AddAttributeAddress( pCtx,
+                                                 pRelayedAddress,
+                                                 STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS );
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_ADD_ATTRIBUTE_XOR_RELAYED_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -823,10 +1398,15 @@ StunResult_t StunSerializer_GetIntegrityBuffer( StunContext_t * pCtx,
     StunResult_t result = STUN_RESULT_OK;
 
     if( ( pCtx == NULL ) ||
-        ( pStunMessageLength == NULL ) )
+        ( pStunMessageLength == NULL ) ||
+        STUN_HAS_REFERENCED_VALUES( pCtx ) )
     {
         result = STUN_RESULT_BAD_PARAM;
     }
+    else if( STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) )
+    {
+        result = STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED;
+    }
 
     if( result == STUN_RESULT_OK )
     {
@@ -845,7 +1425,7 @@ StunResult_t StunSerializer_GetIntegrityBuffer( StunContext_t * pCtx,
         *pStunMessageLength = pCtx->currentIndex;
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_GET_INTEGRITY_BUFFER, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -857,10 +1437,15 @@ StunResult_t StunSerializer_GetFingerprintBuffer( StunContext_t * pCtx,
     StunResult_t result = STUN_RESULT_OK;
 
     if( ( pCtx == NULL ) ||
-        ( pStunMessageLength == NULL ) )
+        ( pStunMessageLength == NULL ) ||
+        STUN_HAS_REFERENCED_VALUES( pCtx ) )
     {
         result = STUN_RESULT_BAD_PARAM;
     }
+    else if( STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) )
+    {
+        result = STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED;
+    }
 
     if( result == STUN_RESULT_OK )
     {
@@ -879,7 +1464,7 @@ StunResult_t StunSerializer_GetFingerprintBuffer( StunContext_t * pCtx,
         *pStunMessageLength = pCtx->currentIndex;
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_GET_FINGERPRINT_BUFFER, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -888,26 +1473,260 @@ StunResult_t StunSerializer_Finalize( StunContext_t * pCtx,
                                       uint32_t * pStunMessageLength )
 {
     StunResult_t result = STUN_RESULT_OK;
+    size_t messageLength;
 
     if( ( pCtx == NULL ) ||
         ( pStunMessageLength == NULL ) )
     {
         result = STUN_RESULT_BAD_PARAM;
     }
+    else if( STUN_HAS_UNFILLED_RESERVATIONS( pCtx ) )
+    {
+        result = STUN_RESULT_RESERVED_ATTRIBUTE_NOT_FILLED;
+    }
 
     if( result == STUN_RESULT_OK )
     {
+        messageLength = pCtx->currentIndex;
+
+        if( pCtx->pScatterGather != NULL )
+        {
+            messageLength += pCtx->pScatterGather->referencedLength;
+            CloseScratchSegment( pCtx,
+                                 pCtx->currentIndex );
+        }
+
         if( pCtx->pStart != NULL )
         {
             /* Update the message length field in the header. */
             STUN_WRITE_UINT16( &( pCtx->pStart[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
-                               pCtx->currentIndex - STUN_HEADER_LENGTH );
+                               ( uint16_t ) ( messageLength - STUN_HEADER_LENGTH ) );
         }
 
-        *pStunMessageLength = pCtx->currentIndex;
+        *pStunMessageLength = ( uint32_t ) messageLength;
+
+        STUN_STATS_ADD( bytesSerialized, messageLength );
     }
 
-    return result;
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_FINALIZE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_UseScatterGather( StunContext_t * pCtx,
+                                              StunScatterGather_t * pScatterGather,
+                                              StunIovec_t * pIovecs,
+                                              size_t maxIovecs )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    /* The header must be in the context buffer and nothing after it yet. The
+     * end of the message always takes a part. */
+    if( ( pCtx == NULL ) ||
+        ( pCtx->pStart == NULL ) ||
+        ( pCtx->currentIndex != STUN_HEADER_LENGTH ) ||
+        ( pScatterGather == NULL ) ||
+        ( pIovecs == NULL ) ||
+        ( maxIovecs == 0U ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pScatterGather->pIovecs = pIovecs;
+        pScatterGather->maxIovecs = maxIovecs;
+        pScatterGather->iovecCount = 0;
+        pScatterGather->referencedLength = 0;
+        pScatterGather->segmentStart = 0;
+
+        pCtx->pScatterGather = pScatterGather;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_USE_SCATTER_GATHER, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_ReserveAttribute( StunContext_t * pCtx,
+                                              StunAttributeType_t attributeType,
+                                              uint16_t valueLength,
+                                              StunReservedAttribute_t * pReservedAttribute )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t valueLengthPadded = STUN_ALIGN_SIZE_TO_WORD( ( size_t ) valueLength );
+
+    /* MESSAGE-INTEGRITY and FINGERPRINT are computed over the message, so
+     * they can only be added when everything before them is known. */
+    if( ( pCtx == NULL ) ||
+        ( pReservedAttribute == NULL ) ||
+        ( valueLength == 0 ) ||
+        ( attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY ) ||
+        ( attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pCtx->pStart != NULL ) )
+    {
+        if( STUN_REMAINING_LENGTH( pCtx ) < STUN_ATTRIBUTE_TOTAL_LENGTH( valueLengthPadded ) )
+        {
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = CheckAndUpdateAttributeFlag( pCtx,
+                                              attributeType );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( pCtx->pStart != NULL )
+        {
+            /* Write Attribute type and length and zero the value and the
+             * padding. */
+            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex ] ),
+                               attributeType );
+
+            STUN_WRITE_UINT16( &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ),
+                               valueLength );
+
+            memset( ( void * ) &( pCtx->pStart[ pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ),
+                    0,
+                    valueLengthPadded );
+        }
+
+        pReservedAttribute->attributeType = attributeType;
+        pReservedAttribute->valueLength = valueLength;
+        pReservedAttribute->valueOffset = pCtx->currentIndex + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET;
+        pReservedAttribute->isFilled = 0U;
+        pCtx->unfilledReservations++;
+
+        pCtx->currentIndex += STUN_ATTRIBUTE_TOTAL_LENGTH( valueLengthPadded );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_RESERVE_ATTRIBUTE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_FillReservedAttribute( StunContext_t * pCtx,
+                                                   StunReservedAttribute_t * pReservedAttribute,
+                                                   const uint8_t * pValue,
+                                                   uint16_t valueLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t * pAttributeValue = NULL;
+
+    if( pValue == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = FillReserved( pCtx,
+                               pReservedAttribute,
+                               valueLength,
+                               &( pAttributeValue ) );
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pAttributeValue != NULL ) )
+    {
+        memcpy( ( void * ) pAttributeValue,
+                ( const void * ) pValue,
+                valueLength );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_FILL_RESERVED_ATTRIBUTE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_FillReservedUint32( StunContext_t * pCtx,
+                                                StunReservedAttribute_t * pReservedAttribute,
+                                                uint32_t value )
+{
+    StunResult_t result;
+    uint8_t * pAttributeValue = NULL;
+
+    result = FillReserved( pCtx,
+                           pReservedAttribute,
+                           ( uint16_t ) sizeof( uint32_t ),
+                           &( pAttributeValue ) );
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pAttributeValue != NULL ) )
+    {
+        STUN_WRITE_UINT32( pAttributeValue,
+                           value );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_FILL_RESERVED_UINT32, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_FillReservedUint64( StunContext_t * pCtx,
+                                                StunReservedAttribute_t * pReservedAttribute,
+                                                uint64_t value )
+{
+    StunResult_t result;
+    uint8_t * pAttributeValue = NULL;
+
+    result = FillReserved( pCtx,
+                           pReservedAttribute,
+                           ( uint16_t ) sizeof( uint64_t ),
+                           &( pAttributeValue ) );
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pAttributeValue != NULL ) )
+    {
+        STUN_WRITE_UINT64( pAttributeValue,
+                           value );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_FILL_RESERVED_UINT64, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunSerializer_FillReservedAddress( StunContext_t * pCtx,
+                                                 StunReservedAttribute_t * pReservedAttribute,
+                                                 const StunAttributeAddress_t * pAddress )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint8_t * pAttributeValue = NULL;
+
+    if( ( pAddress == NULL ) ||
+        ( ( pAddress->family != STUN_ADDRESS_IPv4 ) &&
+          ( pAddress->family != STUN_ADDRESS_IPv6 ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        result = FillReserved( pCtx,
+                               pReservedAttribute,
+                               STUN_ADDRESS_VALUE_LENGTH( pAddress->family ),
+                               &( pAttributeValue ) );
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pAttributeValue != NULL ) )
+    {
+        ( void ) StunAddress_Encode( pCtx->pStart,
+                                     pAddress,
+                                     STUN_ATTRIBUTE_IS_XOR_ADDRESS( pReservedAttribute->attributeType ),
+                                     pAttributeValue );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_SERIALIZER_FILL_RESERVED_ADDRESS, result );
 }
 
 /*-----------------------------------------------------------*/
@@ -0,0 +1,172 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_stats.h"
+
+#if defined( STUN_ENABLE_STATS ) && ( defined( __unix__ ) || defined( __APPLE__ ) )
+    #include <pthread.h>
+
+/* Releases the block of a thread when it exits. */
+    #define STUN_STATS_RELEASE_ON_EXIT
+#endif
+
+#if defined( STUN_ENABLE_STATS )
+
+/* Blocks of the threads, claimed when a thread first counts something and
+ * released when it exits. */
+static StunStatsBlock_t stunStatsBlocks[ STUN_STATS_MAX_THREADS ];
+
+/* Block shared by the threads that find no free block. */
+static StunStatsBlock_t stunStatsSharedBlock = { .isShared = 1U };
+
+__thread StunStatsBlock_t * pStunStatsThreadBlock = NULL;
+
+    #if defined( STUN_STATS_RELEASE_ON_EXIT )
+        static pthread_once_t stunStatsKeyOnce = PTHREAD_ONCE_INIT;
+        static pthread_key_t stunStatsKey;
+    #endif
+
+/*-----------------------------------------------------------*/
+
+static void AddBlock( StunStats_t * pSnapshot,
+                      const StunStatsBlock_t * pBlock );
+
+static void ReleaseBlock( void * pBlock );
+
+    #if defined( STUN_STATS_RELEASE_ON_EXIT )
+        static void CreateKey( void );
+    #endif
+
+/*-----------------------------------------------------------*/
+
+static void AddBlock( StunStats_t * pSnapshot,
+                      const StunStatsBlock_t * pBlock )
+{
+    /* StunStats_t only has uint64_t counters, so both can be walked as
+     * arrays of counters. */
+    uint64_t * pTotal = ( uint64_t * ) pSnapshot;
+    const uint64_t * pCounter = ( const uint64_t * ) &( pBlock->stats );
+    size_t i;
+
+    for( i = 0; i < ( sizeof( StunStats_t ) / sizeof( uint64_t ) ); i++ )
+    {
+        pTotal[ i ] += __atomic_load_n( &( pCounter[ i ] ), __ATOMIC_RELAXED );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ReleaseBlock( void * pBlock )
+{
+    StunStatsBlock_t * pStatsBlock = ( StunStatsBlock_t * ) pBlock;
+
+    /* Release, so that the next owner sees the counts of this thread before
+     * adding to them. */
+    if( pStatsBlock->isShared == 0U )
+    {
+        __atomic_store_n( &( pStatsBlock->isClaimed ), 0U, __ATOMIC_RELEASE );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+    #if defined( STUN_STATS_RELEASE_ON_EXIT )
+
+        static void CreateKey( void )
+        {
+            ( void ) pthread_key_create( &( stunStatsKey ), ReleaseBlock );
+        }
+
+    #endif
+
+/*-----------------------------------------------------------*/
+
+StunStatsBlock_t * StunStats_ClaimBlock( void )
+{
+    uint32_t i, expected;
+
+    pStunStatsThreadBlock = &( stunStatsSharedBlock );
+
+    /* Only done once per thread, so a scan is enough. */
+    for( i = 0; i < STUN_STATS_MAX_THREADS; i++ )
+    {
+        expected = 0U;
+
+        if( __atomic_compare_exchange_n( &( stunStatsBlocks[ i ].isClaimed ), &( expected ), 1U, 0,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) != 0 )
+        {
+            pStunStatsThreadBlock = &( stunStatsBlocks[ i ] );
+            break;
+        }
+    }
+
+    #if defined( STUN_STATS_RELEASE_ON_EXIT )
+        if( pStunStatsThreadBlock != &( stunStatsSharedBlock ) )
+        {
+            ( void ) pthread_once( &( stunStatsKeyOnce ), CreateKey );
+            ( void ) pthread_setspecific( stunStatsKey, pStunStatsThreadBlock );
+        }
+    #endif
+
+    return pStunStatsThreadBlock;
+}
+
+#endif /* if defined( STUN_ENABLE_STATS ) */
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunStats_GetSnapshot( StunStats_t * pSnapshot )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    #if defined( STUN_ENABLE_STATS )
+        uint32_t i;
+    #endif
+
+    if( pSnapshot == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pSnapshot, 0, sizeof( StunStats_t ) );
+
+        #if defined( STUN_ENABLE_STATS )
+            /* Free blocks keep the counts of the threads that released them. */
+            for( i = 0; i < STUN_STATS_MAX_THREADS; i++ )
+            {
+                AddBlock( pSnapshot, &( stunStatsBlocks[ i ] ) );
+            }
+
+            AddBlock( pSnapshot, &( stunStatsSharedBlock ) );
+        #endif
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunStats_ReleaseThread( void )
+{
+    #if defined( STUN_ENABLE_STATS )
+        if( pStunStatsThreadBlock != NULL )
+        {
+            #if defined( STUN_STATS_RELEASE_ON_EXIT )
+                if( pStunStatsThreadBlock != &( stunStatsSharedBlock ) )
+                {
+                    ( void ) pthread_setspecific( stunStatsKey, NULL );
+                }
+            #endif
+
+            ReleaseBlock( pStunStatsThreadBlock );
+            pStunStatsThreadBlock = NULL;
+        }
+    #endif
+
+    return STUN_RESULT_OK;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,387 @@
+/* Standard includes. */
+#include <string.h>
+
+/* API includes. */
+#include "stun_template.h"
+#include "stun_address.h"
+#include "stun_endianness.h"
+#include "stun_crc32.h"
+#include "stun_stats.h"
+
+/*-----------------------------------------------------------*/
+
+static const StunTemplateSlot_t * FindSlot( const StunTemplate_t * pTemplate,
+                                            StunAttributeType_t attributeType );
+
+static int IsAddressAttribute( StunAttributeType_t attributeType,
+                               int * pIsXorAddress );
+
+/*-----------------------------------------------------------*/
+
+static const StunTemplateSlot_t * FindSlot( const StunTemplate_t * pTemplate,
+                                            StunAttributeType_t attributeType )
+{
+    const StunTemplateSlot_t * pSlot = NULL;
+    uint16_t i;
+
+    for( i = 0; i < pTemplate->slotCount; i++ )
+    {
+        if( pTemplate->slots[ i ].attributeType == ( uint16_t ) attributeType )
+        {
+            pSlot = &( pTemplate->slots[ i ] );
+            break;
+        }
+    }
+
+    return pSlot;
+}
+
+/*-----------------------------------------------------------*/
+
+static int IsAddressAttribute( StunAttributeType_t attributeType,
+                               int * pIsXorAddress )
+{
+    int isAddress = 1;
+
+    *pIsXorAddress = 0;
+
+    switch( attributeType )
+    {
+        case STUN_ATTRIBUTE_TYPE_MAPPED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_RESPONSE_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_SOURCE_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_CHANGED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_REFLECTED_FROM:
+            break;
+
+        case STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_XOR_PEER_ADDRESS:
+        case STUN_ATTRIBUTE_TYPE_XOR_RELAYED_ADDRESS:
+            *pIsXorAddress = 1;
+            break;
+
+        default:
+            isAddress = 0;
+            break;
+    }
+
+    return isAddress;
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_Compile( StunTemplate_t * pTemplate,
+                                   const uint8_t * pMessage,
+                                   size_t messageLength )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    size_t offset = STUN_HEADER_LENGTH;
+    uint16_t attributeType, attributeValueLength;
+
+    if( ( pTemplate == NULL ) ||
+        ( pMessage == NULL ) ||
+        ( messageLength < STUN_HEADER_LENGTH ) ||
+        ( messageLength > UINT16_MAX ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pTemplate, 0, sizeof( StunTemplate_t ) );
+        pTemplate->pMessage = pMessage;
+        pTemplate->messageLength = ( uint16_t ) messageLength;
+
+        if( Stun_ReadUint32( &( pMessage[ STUN_HEADER_MAGIC_COOKIE_OFFSET ] ) ) != STUN_HEADER_MAGIC_COOKIE )
+        {
+            result = STUN_RESULT_MAGIC_COOKIE_MISMATCH;
+        }
+        else if( ( ( size_t ) Stun_ReadUint16( &( pMessage[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ) ) + STUN_HEADER_LENGTH ) != messageLength )
+        {
+            result = STUN_RESULT_INVALID_MESSAGE_LENGTH;
+        }
+    }
+
+    /* The same checks as StunDeserializer_GetNextAttribute, plus the lengths
+     * of MESSAGE-INTEGRITY and FINGERPRINT which StunTemplate_Finish writes
+     * without looking. */
+    while( ( result == STUN_RESULT_OK ) &&
+           ( offset < messageLength ) )
+    {
+        if( ( messageLength - offset ) < STUN_ATTRIBUTE_HEADER_LENGTH )
+        {
+            result = STUN_RESULT_INVALID_MESSAGE_LENGTH;
+        }
+        else
+        {
+            attributeType = Stun_ReadUint16( &( pMessage[ offset ] ) );
+            attributeValueLength = Stun_ReadUint16( &( pMessage[ offset + STUN_ATTRIBUTE_HEADER_LENGTH_OFFSET ] ) );
+
+            if( ( pTemplate->fingerprintOffset != 0U ) ||
+                ( ( pTemplate->integrityOffset != 0U ) &&
+                  ( attributeType != STUN_ATTRIBUTE_TYPE_FINGERPRINT ) ) )
+            {
+                result = STUN_RESULT_INVALID_ATTRIBUTE_ORDER;
+            }
+            else if( ( messageLength - offset ) < STUN_ATTRIBUTE_TOTAL_LENGTH( ( size_t ) attributeValueLength ) )
+            {
+                result = STUN_RESULT_OUT_OF_MEMORY;
+            }
+            else if( attributeType == STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY )
+            {
+                if( attributeValueLength != STUN_HMAC_VALUE_LENGTH )
+                {
+                    result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+                }
+                else
+                {
+                    pTemplate->integrityOffset = ( uint16_t ) offset;
+                }
+            }
+            else if( attributeType == STUN_ATTRIBUTE_TYPE_FINGERPRINT )
+            {
+                if( attributeValueLength != sizeof( uint32_t ) )
+                {
+                    result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+                }
+                else
+                {
+                    pTemplate->fingerprintOffset = ( uint16_t ) offset;
+                }
+            }
+            else if( pTemplate->slotCount == STUN_TEMPLATE_MAX_SLOTS )
+            {
+                result = STUN_RESULT_OUT_OF_MEMORY;
+            }
+            else
+            {
+                pTemplate->slots[ pTemplate->slotCount ].attributeType = attributeType;
+                pTemplate->slots[ pTemplate->slotCount ].valueOffset = ( uint16_t ) ( offset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET );
+                pTemplate->slots[ pTemplate->slotCount ].valueLength = attributeValueLength;
+                pTemplate->slotCount++;
+            }
+
+            offset += STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_ALIGN_SIZE_TO_WORD( ( size_t ) attributeValueLength ) );
+        }
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( offset != messageLength ) )
+    {
+        /* The padding of the last attribute is missing. */
+        result = STUN_RESULT_INVALID_MESSAGE_LENGTH;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_COMPILE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_Instantiate( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       size_t bufferLength,
+                                       const uint8_t * pTransactionId )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pTemplate == NULL ) ||
+        ( pTemplate->pMessage == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( pTransactionId == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else if( bufferLength < pTemplate->messageLength )
+    {
+        result = STUN_RESULT_OUT_OF_MEMORY;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memcpy( ( void * ) pBuffer,
+                ( const void * ) pTemplate->pMessage,
+                pTemplate->messageLength );
+
+        memcpy( ( void * ) &( pBuffer[ STUN_HEADER_TRANSACTION_ID_OFFSET ] ),
+                ( const void * ) pTransactionId,
+                STUN_HEADER_TRANSACTION_ID_LENGTH );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_INSTANTIATE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_PatchAddress( const StunTemplate_t * pTemplate,
+                                        uint8_t * pBuffer,
+                                        StunAttributeType_t attributeType,
+                                        const StunAttributeAddress_t * pAddress )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const StunTemplateSlot_t * pSlot = NULL;
+    int isXorAddress = 0;
+
+    if( ( pTemplate == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( pAddress == NULL ) ||
+        ( IsAddressAttribute( attributeType, &( isXorAddress ) ) == 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pSlot = FindSlot( pTemplate, attributeType );
+
+        if( pSlot == NULL )
+        {
+            result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( ( ( pAddress->family != STUN_ADDRESS_IPv4 ) &&
+              ( pAddress->family != STUN_ADDRESS_IPv6 ) ) ||
+            ( pSlot->valueLength != STUN_ADDRESS_VALUE_LENGTH( pAddress->family ) ) )
+        {
+            /* The family in the template decides the length of the value. */
+            result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+        }
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        ( void ) StunAddress_Encode( pBuffer,
+                                     pAddress,
+                                     ( uint8_t ) isXorAddress,
+                                     &( pBuffer[ pSlot->valueOffset ] ) );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_PATCH_ADDRESS, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_PatchUint32( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       StunAttributeType_t attributeType,
+                                       uint32_t value )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const StunTemplateSlot_t * pSlot = NULL;
+
+    if( ( pTemplate == NULL ) ||
+        ( pBuffer == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pSlot = FindSlot( pTemplate, attributeType );
+
+        if( pSlot == NULL )
+        {
+            result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+        }
+        else if( pSlot->valueLength != sizeof( uint32_t ) )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+        }
+        else
+        {
+            Stun_WriteUint32( &( pBuffer[ pSlot->valueOffset ] ), value );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_PATCH_UINT32, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_PatchUint64( const StunTemplate_t * pTemplate,
+                                       uint8_t * pBuffer,
+                                       StunAttributeType_t attributeType,
+                                       uint64_t value )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    const StunTemplateSlot_t * pSlot = NULL;
+
+    if( ( pTemplate == NULL ) ||
+        ( pBuffer == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pSlot = FindSlot( pTemplate, attributeType );
+
+        if( pSlot == NULL )
+        {
+            result = STUN_RESULT_NO_ATTRIBUTE_FOUND;
+        }
+        else if( pSlot->valueLength != sizeof( uint64_t ) )
+        {
+            result = STUN_RESULT_INVALID_ATTRIBUTE_LENGTH;
+        }
+        else
+        {
+            Stun_WriteUint64( &( pBuffer[ pSlot->valueOffset ] ), value );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_PATCH_UINT64, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTemplate_Finish( const StunTemplate_t * pTemplate,
+                                  uint8_t * pBuffer,
+                                  const StunHmacKey_t * pHmacKey )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint32_t crc32Fingerprint;
+
+    if( ( pTemplate == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( ( pTemplate->integrityOffset != 0U ) && ( pHmacKey == NULL ) ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pTemplate->integrityOffset != 0U ) )
+    {
+        /* The length in the header covers the message up to the end of
+         * MESSAGE-INTEGRITY while computing the HMAC. */
+        Stun_WriteUint16( &( pBuffer[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                          ( uint16_t ) ( pTemplate->integrityOffset +
+                                         STUN_ATTRIBUTE_TOTAL_LENGTH( STUN_HMAC_VALUE_LENGTH ) -
+                                         STUN_HEADER_LENGTH ) );
+
+        result = StunHmac_Sign( pHmacKey,
+                                pBuffer,
+                                pTemplate->integrityOffset,
+                                &( pBuffer[ pTemplate->integrityOffset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ) );
+
+        Stun_WriteUint16( &( pBuffer[ STUN_HEADER_MESSAGE_LENGTH_OFFSET ] ),
+                          ( uint16_t ) ( pTemplate->messageLength - STUN_HEADER_LENGTH ) );
+    }
+
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pTemplate->fingerprintOffset != 0U ) )
+    {
+        crc32Fingerprint = Stun_Crc32( 0,
+                                       pBuffer,
+                                       pTemplate->fingerprintOffset ) ^ STUN_FINGERPRINT_XOR_VALUE;
+
+        Stun_WriteUint32( &( pBuffer[ pTemplate->fingerprintOffset + STUN_ATTRIBUTE_HEADER_VALUE_OFFSET ] ),
+                          crc32Fingerprint );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TEMPLATE_FINISH, result );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,415 @@
+/* API includes. */
+#include "stun_timer_wheel.h"
+#include "stun_stats.h"
+
+#define STUN_TIMER_WHEEL_SLOT_MASK    ( ( uint64_t ) STUN_TIMER_WHEEL_SLOTS - 1 )
+
+/* Ticks covered by all the levels together. */
+#define STUN_TIMER_WHEEL_SPAN         ( ( uint64_t ) 1 << ( STUN_TIMER_WHEEL_SLOT_BITS * STUN_TIMER_WHEEL_LEVELS ) )
+
+#define STUN_TIMER_WHEEL_LIST_IS_EMPTY( pList )    ( ( pList )->pNext == ( pList ) )
+
+/*-----------------------------------------------------------*/
+
+static void InitList( StunTimerLink_t * pList );
+
+static void AppendToList( StunTimerLink_t * pList,
+                          StunTimerLink_t * pLink );
+
+static void UnlinkTimer( StunTimer_t * pTimer );
+
+static void MoveList( StunTimerLink_t * pFrom,
+                      StunTimerLink_t * pTo );
+
+static void LinkTimer( StunTimerWheel_t * pWheel,
+                       StunTimer_t * pTimer );
+
+static void CascadeLevels( StunTimerWheel_t * pWheel );
+
+static void ExpireTimer( StunTimerWheel_t * pWheel,
+                         StunTimer_t * pTimer );
+
+static void ExpireSlot( StunTimerWheel_t * pWheel,
+                        StunTimer_t ** ppBatch );
+
+/*-----------------------------------------------------------*/
+
+static void InitList( StunTimerLink_t * pList )
+{
+    pList->pNext = pList;
+    pList->pPrev = pList;
+}
+
+/*-----------------------------------------------------------*/
+
+static void AppendToList( StunTimerLink_t * pList,
+                          StunTimerLink_t * pLink )
+{
+    pLink->pNext = pList;
+    pLink->pPrev = pList->pPrev;
+    pList->pPrev->pNext = pLink;
+    pList->pPrev = pLink;
+}
+
+/*-----------------------------------------------------------*/
+
+static void UnlinkTimer( StunTimer_t * pTimer )
+{
+    pTimer->link.pPrev->pNext = pTimer->link.pNext;
+    pTimer->link.pNext->pPrev = pTimer->link.pPrev;
+    pTimer->link.pNext = NULL;
+    pTimer->link.pPrev = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Moves all the timers of pFrom to the empty list pTo. */
+static void MoveList( StunTimerLink_t * pFrom,
+                      StunTimerLink_t * pTo )
+{
+    if( STUN_TIMER_WHEEL_LIST_IS_EMPTY( pFrom ) )
+    {
+        InitList( pTo );
+    }
+    else
+    {
+        pTo->pNext = pFrom->pNext;
+        pTo->pPrev = pFrom->pPrev;
+        pTo->pNext->pPrev = pTo;
+        pTo->pPrev->pNext = pTo;
+        InitList( pFrom );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Puts a timer in the lowest level that reaches its expiry. A slot of level n
+ * is moved down to the lower levels when level n - 1 completes a turn and
+ * reaches it, so timers are always expired from level 0 on the right tick. */
+static void LinkTimer( StunTimerWheel_t * pWheel,
+                       StunTimer_t * pTimer )
+{
+    uint64_t slotTick = pTimer->expiry, delta = 0;
+    uint32_t level = 0, slot;
+
+    if( pTimer->expiry > pWheel->currentTick )
+    {
+        delta = pTimer->expiry - pWheel->currentTick;
+    }
+    else
+    {
+        /* Only while cascading: the timer expires in the current tick. */
+        slotTick = pWheel->currentTick;
+    }
+
+    if( delta >= STUN_TIMER_WHEEL_SPAN )
+    {
+        /* Parked in the last level until it is in reach. */
+        delta = STUN_TIMER_WHEEL_SPAN - 1;
+        slotTick = pWheel->currentTick + delta;
+    }
+
+    while( ( level < STUN_TIMER_WHEEL_LEVELS - 1 ) &&
+           ( delta >= ( ( uint64_t ) 1 << ( STUN_TIMER_WHEEL_SLOT_BITS * ( level + 1 ) ) ) ) )
+    {
+        level++;
+    }
+
+    slot = ( uint32_t ) ( ( slotTick >> ( STUN_TIMER_WHEEL_SLOT_BITS * level ) ) & STUN_TIMER_WHEEL_SLOT_MASK );
+    AppendToList( &( pWheel->slots[ level ][ slot ] ), &( pTimer->link ) );
+
+    if( level == 0 )
+    {
+        pWheel->occupiedSlots |= ( uint64_t ) 1 << slot;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Called when level 0 starts a turn at the current tick. */
+static void CascadeLevels( StunTimerWheel_t * pWheel )
+{
+    StunTimerLink_t cascading;
+    StunTimer_t * pTimer;
+    uint32_t level, slot;
+    int nextLevel = 1;
+
+    for( level = 1; ( nextLevel != 0 ) && ( level < STUN_TIMER_WHEEL_LEVELS ); level++ )
+    {
+        slot = ( uint32_t ) ( ( pWheel->currentTick >> ( STUN_TIMER_WHEEL_SLOT_BITS * level ) ) & STUN_TIMER_WHEEL_SLOT_MASK );
+
+        MoveList( &( pWheel->slots[ level ][ slot ] ), &( cascading ) );
+
+        while( !STUN_TIMER_WHEEL_LIST_IS_EMPTY( &( cascading ) ) )
+        {
+            pTimer = ( StunTimer_t * ) cascading.pNext;
+            UnlinkTimer( pTimer );
+            LinkTimer( pWheel, pTimer );
+        }
+
+        /* The next level only moves when this one completes a turn. */
+        nextLevel = ( slot == 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ExpireTimer( StunTimerWheel_t * pWheel,
+                         StunTimer_t * pTimer )
+{
+    if( pTimer->pMessage == NULL )
+    {
+        pTimer->event = STUN_TIMER_EVENT_EXPIRED;
+    }
+    else if( pTimer->transmissions < STUN_TIMER_WHEEL_RC )
+    {
+        pTimer->event = STUN_TIMER_EVENT_RETRANSMIT;
+        pTimer->transmissions++;
+
+        /* Scheduled from the tick it was due, so the application being late
+         * to advance the wheel does not shift the following ones. */
+        if( pTimer->transmissions < STUN_TIMER_WHEEL_RC )
+        {
+            pTimer->rto *= 2;
+            pTimer->expiry = pWheel->currentTick + pTimer->rto;
+        }
+        else
+        {
+            pTimer->expiry = pWheel->currentTick + ( STUN_TIMER_WHEEL_RM * pTimer->initialRto );
+        }
+
+        LinkTimer( pWheel, pTimer );
+    }
+    else
+    {
+        pTimer->event = STUN_TIMER_EVENT_TIMEOUT;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void ExpireSlot( StunTimerWheel_t * pWheel,
+                        StunTimer_t ** ppBatch )
+{
+    uint32_t slot = ( uint32_t ) ( pWheel->currentTick & STUN_TIMER_WHEEL_SLOT_MASK );
+    StunTimer_t * pTimer;
+    size_t batchCount = 0;
+
+    pWheel->occupiedSlots &= ~( ( uint64_t ) 1 << slot );
+
+    /* The timers waiting for the callback stay linked in the wheel, so that
+     * the callback can cancel them. */
+    MoveList( &( pWheel->slots[ 0 ][ slot ] ), &( pWheel->expiring ) );
+
+    while( !STUN_TIMER_WHEEL_LIST_IS_EMPTY( &( pWheel->expiring ) ) )
+    {
+        pTimer = ( StunTimer_t * ) pWheel->expiring.pNext;
+        UnlinkTimer( pTimer );
+        ExpireTimer( pWheel, pTimer );
+
+        ppBatch[ batchCount++ ] = pTimer;
+
+        /* A retransmission timer is expired again at a later tick, so the
+         * batch is also passed on at the end of every tick. */
+        if( ( batchCount == STUN_TIMER_WHEEL_BATCH_SIZE ) ||
+            ( STUN_TIMER_WHEEL_LIST_IS_EMPTY( &( pWheel->expiring ) ) ) )
+        {
+            pWheel->callback( pWheel->pCallbackContext, ppBatch, batchCount );
+            batchCount = 0;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTimerWheel_Init( StunTimerWheel_t * pWheel,
+                                  uint64_t currentTick,
+                                  StunTimerCallback_t callback,
+                                  void * pCallbackContext )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    uint32_t level, slot;
+
+    if( ( pWheel == NULL ) ||
+        ( callback == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        for( level = 0; level < STUN_TIMER_WHEEL_LEVELS; level++ )
+        {
+            for( slot = 0; slot < STUN_TIMER_WHEEL_SLOTS; slot++ )
+            {
+                InitList( &( pWheel->slots[ level ][ slot ] ) );
+            }
+        }
+
+        InitList( &( pWheel->expiring ) );
+        pWheel->occupiedSlots = 0;
+        pWheel->currentTick = currentTick;
+        pWheel->callback = callback;
+        pWheel->pCallbackContext = pCallbackContext;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TIMER_WHEEL_INIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTimerWheel_Arm( StunTimerWheel_t * pWheel,
+                                 StunTimer_t * pTimer,
+                                 uint64_t delayTicks )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pWheel == NULL ) ||
+        ( pTimer == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( pTimer->link.pNext != NULL )
+        {
+            UnlinkTimer( pTimer );
+        }
+
+        if( delayTicks == 0 )
+        {
+            delayTicks = 1;
+        }
+        else if( delayTicks > UINT64_MAX - pWheel->currentTick )
+        {
+            delayTicks = UINT64_MAX - pWheel->currentTick;
+        }
+
+        pTimer->pMessage = NULL;
+        pTimer->expiry = pWheel->currentTick + delayTicks;
+        LinkTimer( pWheel, pTimer );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TIMER_WHEEL_ARM, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTimerWheel_Cancel( StunTimerWheel_t * pWheel,
+                                    StunTimer_t * pTimer )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pWheel == NULL ) ||
+        ( pTimer == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    /* An emptied level 0 slot keeps its occupied bit until its tick, which
+     * only costs a look at an empty list. */
+    if( ( result == STUN_RESULT_OK ) &&
+        ( pTimer->link.pNext != NULL ) )
+    {
+        UnlinkTimer( pTimer );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TIMER_WHEEL_CANCEL, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTimerWheel_StartTransaction( StunTimerWheel_t * pWheel,
+                                              StunTimer_t * pTimer,
+                                              const uint8_t * pMessage,
+                                              size_t messageLength,
+                                              uint64_t rtoTicks )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pWheel == NULL ) ||
+        ( pTimer == NULL ) ||
+        ( pMessage == NULL ) ||
+        ( messageLength == 0 ) ||
+        ( rtoTicks == 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        if( pTimer->link.pNext != NULL )
+        {
+            UnlinkTimer( pTimer );
+        }
+
+        pTimer->pMessage = pMessage;
+        pTimer->messageLength = messageLength;
+        pTimer->initialRto = rtoTicks;
+        pTimer->rto = rtoTicks;
+        pTimer->transmissions = 1;
+        pTimer->expiry = pWheel->currentTick + rtoTicks;
+        LinkTimer( pWheel, pTimer );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TIMER_WHEEL_START_TRANSACTION, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTimerWheel_Advance( StunTimerWheel_t * pWheel,
+                                     uint64_t nowTicks )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTimer_t * batch[ STUN_TIMER_WHEEL_BATCH_SIZE ];
+    uint64_t tick, pendingSlots;
+    uint32_t slot;
+
+    if( pWheel == NULL )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    while( ( result == STUN_RESULT_OK ) &&
+           ( pWheel->currentTick < nowTicks ) )
+    {
+        tick = pWheel->currentTick + 1;
+        slot = ( uint32_t ) ( tick & STUN_TIMER_WHEEL_SLOT_MASK );
+
+        /* Skip to the next tick with timers or with a cascade. */
+        if( slot != 0 )
+        {
+            pendingSlots = pWheel->occupiedSlots >> slot;
+
+            if( pendingSlots == 0 )
+            {
+                tick += STUN_TIMER_WHEEL_SLOTS - slot;
+            }
+            else
+            {
+                tick += ( uint64_t ) __builtin_ctzll( pendingSlots );
+            }
+        }
+
+        if( tick > nowTicks )
+        {
+            pWheel->currentTick = nowTicks;
+        }
+        else
+        {
+            pWheel->currentTick = tick;
+
+            if( ( tick & STUN_TIMER_WHEEL_SLOT_MASK ) == 0 )
+            {
+                CascadeLevels( pWheel );
+            }
+
+            ExpireSlot( pWheel, &( batch[ 0 ] ) );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TIMER_WHEEL_ADVANCE, result );
+}
+
+/*-----------------------------------------------------------*/
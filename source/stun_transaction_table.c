@@ -0,0 +1,586 @@
+/* Standard includes. */
+#include <string.h>
+
+/* SIMD includes. */
+#if defined( __SSE2__ )
+    #include <immintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+    #include <arm_neon.h>
+#endif
+
+/* API includes. */
+#include "stun_transaction_table.h"
+#include "stun_stats.h"
+
+/* Tag values. A removed entry becomes a TOMBSTONE until no thread can still
+ * be reading it, and is then reused by inserts. Lookups do not depend on
+ * EMPTY entries to stop, the overflow count of the groups tells them when. */
+#define STUN_TRANSACTION_TAG_EMPTY        0x00
+#define STUN_TRANSACTION_TAG_BUSY         0x01 /* Being inserted or removed. */
+#define STUN_TRANSACTION_TAG_TOMBSTONE    0x02
+#define STUN_TRANSACTION_TAG_USED_BIT     0x80 /* Set with 7 bits of the hash in used entries. */
+
+#define STUN_TRANSACTION_TAG( hash )      ( ( uint8_t ) ( STUN_TRANSACTION_TAG_USED_BIT | ( ( hash ) >> 57 ) ) )
+
+#define STUN_ATOMIC_LOAD_RELAXED( pValue )            __atomic_load_n( ( pValue ), __ATOMIC_RELAXED )
+#define STUN_ATOMIC_LOAD_ACQUIRE( pValue )            __atomic_load_n( ( pValue ), __ATOMIC_ACQUIRE )
+#define STUN_ATOMIC_LOAD_SEQ_CST( pValue )            __atomic_load_n( ( pValue ), __ATOMIC_SEQ_CST )
+#define STUN_ATOMIC_STORE_RELAXED( pValue, value )    __atomic_store_n( ( pValue ), ( value ), __ATOMIC_RELAXED )
+#define STUN_ATOMIC_STORE_RELEASE( pValue, value )    __atomic_store_n( ( pValue ), ( value ), __ATOMIC_RELEASE )
+#define STUN_ATOMIC_FETCH_ADD( pValue, value )        __atomic_fetch_add( ( pValue ), ( value ), __ATOMIC_SEQ_CST )
+#define STUN_ATOMIC_FETCH_SUB( pValue, value )        __atomic_fetch_sub( ( pValue ), ( value ), __ATOMIC_SEQ_CST )
+#define STUN_ATOMIC_COMPARE_EXCHANGE( pValue, pExpected, desired ) \
+    __atomic_compare_exchange_n( ( pValue ), ( pExpected ), ( desired ), 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED )
+#define STUN_ATOMIC_FENCE_SEQ_CST()                   __atomic_thread_fence( __ATOMIC_SEQ_CST )
+
+/*-----------------------------------------------------------*/
+
+static uint64_t HashTransactionId( const uint8_t * pTransactionId );
+
+static void MatchTags( StunTransactionGroup_t * pGroup,
+                       uint8_t tag,
+                       uint32_t * pTagMask,
+                       uint32_t * pEmptyMask );
+
+static uint64_t MinActiveEpoch( const StunTransactionTable_t * pTable );
+
+static uint32_t ReclaimableMask( const StunTransactionTable_t * pTable,
+                                 StunTransactionGroup_t * pGroup,
+                                 uint32_t tombstoneMask,
+                                 uint64_t * pMinActiveEpoch );
+
+static int ClaimEntry( const StunTransactionTable_t * pTable,
+                       StunTransactionGroup_t * pGroup,
+                       uint8_t tag,
+                       const uint8_t * pTransactionId,
+                       void * pContext,
+                       uint64_t * pMinActiveEpoch );
+
+static StunTransactionEntry_t * FindEntry( StunTransactionTable_t * pTable,
+                                           const uint8_t * pTransactionId,
+                                           uint8_t ** ppTag,
+                                           uint32_t * pProbe );
+
+static void ReleaseOverflow( StunTransactionTable_t * pTable,
+                             uint64_t hash,
+                             uint32_t probeCount );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t HashTransactionId( const uint8_t * pTransactionId )
+{
+    uint64_t low, hash;
+    uint32_t high;
+
+    /* Transaction IDs are random, so mixing them once is enough. */
+    memcpy( ( void * ) &( low ), ( const void * ) pTransactionId, sizeof( low ) );
+    memcpy( ( void * ) &( high ), ( const void * ) &( pTransactionId[ sizeof( low ) ] ), sizeof( high ) );
+
+    hash = ( low ^ ( ( uint64_t ) high << 32 ) ^ high ) * 0x9E3779B97F4A7C15ULL;
+
+    return hash ^ ( hash >> 32 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sets bit i of *pTagMask when the tag of entry i is tag, and bit i of
+ * *pEmptyMask when entry i is empty. */
+static void MatchTags( StunTransactionGroup_t * pGroup,
+                       uint8_t tag,
+                       uint32_t * pTagMask,
+                       uint32_t * pEmptyMask )
+{
+    uint64_t tagWords[ STUN_TRANSACTION_TABLE_GROUP_SIZE / sizeof( uint64_t ) ];
+
+    tagWords[ 0 ] = STUN_ATOMIC_LOAD_ACQUIRE( &( pGroup->tagWords[ 0 ] ) );
+    tagWords[ 1 ] = STUN_ATOMIC_LOAD_ACQUIRE( &( pGroup->tagWords[ 1 ] ) );
+
+    #if defined( __SSE2__ )
+    {
+        __m128i tags = _mm_loadu_si128( ( const __m128i * ) &( tagWords[ 0 ] ) );
+
+        *pTagMask = ( uint32_t ) _mm_movemask_epi8( _mm_cmpeq_epi8( tags, _mm_set1_epi8( ( char ) tag ) ) );
+        *pEmptyMask = ( uint32_t ) _mm_movemask_epi8( _mm_cmpeq_epi8( tags, _mm_setzero_si128() ) );
+    }
+    #elif defined( __ARM_NEON ) && defined( __aarch64__ )
+    {
+        static const uint8_t laneBits[ 16 ] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t tags, bits, match;
+
+        tags = vld1q_u8( ( const uint8_t * ) &( tagWords[ 0 ] ) );
+        bits = vld1q_u8( &( laneBits[ 0 ] ) );
+
+        match = vandq_u8( vceqq_u8( tags, vdupq_n_u8( tag ) ), bits );
+        *pTagMask = ( uint32_t ) vaddv_u8( vget_low_u8( match ) ) |
+                    ( ( uint32_t ) vaddv_u8( vget_high_u8( match ) ) << 8 );
+
+        match = vandq_u8( vceqq_u8( tags, vdupq_n_u8( STUN_TRANSACTION_TAG_EMPTY ) ), bits );
+        *pEmptyMask = ( uint32_t ) vaddv_u8( vget_low_u8( match ) ) |
+                      ( ( uint32_t ) vaddv_u8( vget_high_u8( match ) ) << 8 );
+    }
+    #else /* Scalar fallback. */
+    {
+        const uint8_t * pTags = ( const uint8_t * ) &( tagWords[ 0 ] );
+        uint32_t i;
+
+        *pTagMask = 0;
+        *pEmptyMask = 0;
+
+        for( i = 0; i < STUN_TRANSACTION_TABLE_GROUP_SIZE; i++ )
+        {
+            *pTagMask |= ( uint32_t ) ( pTags[ i ] == tag ) << i;
+            *pEmptyMask |= ( uint32_t ) ( pTags[ i ] == STUN_TRANSACTION_TAG_EMPTY ) << i;
+        }
+    }
+    #endif /* if defined( __SSE2__ ) */
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t MinActiveEpoch( const StunTransactionTable_t * pTable )
+{
+    uint64_t minEpoch = UINT64_MAX, epoch;
+    size_t i;
+
+    for( i = 0; i < pTable->threadCount; i++ )
+    {
+        epoch = STUN_ATOMIC_LOAD_SEQ_CST( &( pTable->pThreads[ i ].epoch ) );
+
+        if( ( epoch != 0 ) && ( epoch < minEpoch ) )
+        {
+            minEpoch = epoch;
+        }
+    }
+
+    return minEpoch;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Returns the tombstones of tombstoneMask that no thread can still be
+ * reading. The minimum active epoch is only computed when a group has
+ * tombstones and then reused for the rest of the insert. */
+static uint32_t ReclaimableMask( const StunTransactionTable_t * pTable,
+                                 StunTransactionGroup_t * pGroup,
+                                 uint32_t tombstoneMask,
+                                 uint64_t * pMinActiveEpoch )
+{
+    uint8_t * pTags = ( uint8_t * ) &( pGroup->tagWords[ 0 ] );
+    uint32_t reclaimableMask = 0, i;
+
+    if( ( tombstoneMask != 0 ) && ( *pMinActiveEpoch == 0 ) )
+    {
+        *pMinActiveEpoch = MinActiveEpoch( pTable );
+    }
+
+    while( tombstoneMask != 0 )
+    {
+        i = ( uint32_t ) __builtin_ctz( tombstoneMask );
+        tombstoneMask &= tombstoneMask - 1;
+
+        /* The entry can be reused and removed again while it is read here,
+         * hence the atomic load of retireEpoch. */
+        if( ( STUN_ATOMIC_LOAD_ACQUIRE( &( pTags[ i ] ) ) == STUN_TRANSACTION_TAG_TOMBSTONE ) &&
+            ( STUN_ATOMIC_LOAD_RELAXED( &( pGroup->entries[ i ].retireEpoch ) ) < *pMinActiveEpoch ) )
+        {
+            reclaimableMask |= 1U << i;
+        }
+    }
+
+    return reclaimableMask;
+}
+
+/*-----------------------------------------------------------*/
+
+static int ClaimEntry( const StunTransactionTable_t * pTable,
+                       StunTransactionGroup_t * pGroup,
+                       uint8_t tag,
+                       const uint8_t * pTransactionId,
+                       void * pContext,
+                       uint64_t * pMinActiveEpoch )
+{
+    uint8_t * pTags = ( uint8_t * ) &( pGroup->tagWords[ 0 ] );
+    StunTransactionEntry_t * pEntry;
+    uint32_t tombstoneMask, emptyMask, candidateMask, i;
+    uint8_t expected;
+    int claimed = 0;
+
+    do
+    {
+        MatchTags( pGroup, STUN_TRANSACTION_TAG_TOMBSTONE, &( tombstoneMask ), &( emptyMask ) );
+        candidateMask = emptyMask | ReclaimableMask( pTable, pGroup, tombstoneMask, pMinActiveEpoch );
+
+        if( candidateMask != 0 )
+        {
+            i = ( uint32_t ) __builtin_ctz( candidateMask );
+            pEntry = &( pGroup->entries[ i ] );
+            expected = ( ( emptyMask & ( 1U << i ) ) != 0 ) ? STUN_TRANSACTION_TAG_EMPTY : STUN_TRANSACTION_TAG_TOMBSTONE;
+
+            if( STUN_ATOMIC_COMPARE_EXCHANGE( &( pTags[ i ] ), &( expected ), STUN_TRANSACTION_TAG_BUSY ) != 0 )
+            {
+                /* The tombstone may have been reused and removed again since
+                 * it was checked, in a later epoch. */
+                if( ( expected == STUN_TRANSACTION_TAG_TOMBSTONE ) &&
+                    ( STUN_ATOMIC_LOAD_RELAXED( &( pEntry->retireEpoch ) ) >= *pMinActiveEpoch ) )
+                {
+                    STUN_ATOMIC_STORE_RELEASE( &( pTags[ i ] ), STUN_TRANSACTION_TAG_TOMBSTONE );
+                }
+                else
+                {
+                    memcpy( ( void * ) &( pEntry->transactionId[ 0 ] ), ( const void * ) pTransactionId, STUN_HEADER_TRANSACTION_ID_LENGTH );
+                    pEntry->pContext = pContext;
+
+                    STUN_ATOMIC_STORE_RELEASE( &( pTags[ i ] ), tag );
+                    claimed = 1;
+                }
+            }
+        }
+    } while( ( claimed == 0 ) && ( candidateMask != 0 ) );
+
+    return claimed;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Finds the used entry of a transaction ID. When ppTag is not NULL, the entry
+ * is also marked busy so that only one caller removes it, and its tag and the
+ * probe it was found at are returned. The calling thread must have entered
+ * the table. */
+static StunTransactionEntry_t * FindEntry( StunTransactionTable_t * pTable,
+                                           const uint8_t * pTransactionId,
+                                           uint8_t ** ppTag,
+                                           uint32_t * pProbe )
+{
+    StunTransactionGroup_t * pGroup;
+    StunTransactionEntry_t * pFound = NULL, * pEntry;
+    uint8_t * pTags;
+    uint64_t hash;
+    uint32_t tagMask, emptyMask, i, probe;
+    uint8_t tag, expected;
+    int hasOverflow = 1;
+
+    hash = HashTransactionId( pTransactionId );
+    tag = STUN_TRANSACTION_TAG( hash );
+
+    for( probe = 0; ( pFound == NULL ) && ( hasOverflow != 0 ) && ( probe < STUN_TRANSACTION_TABLE_PROBE_LENGTH ); probe++ )
+    {
+        pGroup = &( pTable->pGroups[ ( hash + probe ) & pTable->groupMask ] );
+        pTags = ( uint8_t * ) &( pGroup->tagWords[ 0 ] );
+
+        MatchTags( pGroup, tag, &( tagMask ), &( emptyMask ) );
+
+        while( ( pFound == NULL ) && ( tagMask != 0 ) )
+        {
+            i = ( uint32_t ) __builtin_ctz( tagMask );
+            tagMask &= tagMask - 1;
+            pEntry = &( pGroup->entries[ i ] );
+
+            /* The entry cannot be reused while this thread is in the table, so
+             * its key stays valid as long as its tag is still set. */
+            if( ( STUN_ATOMIC_LOAD_ACQUIRE( &( pTags[ i ] ) ) == tag ) &&
+                ( memcmp( ( const void * ) &( pEntry->transactionId[ 0 ] ),
+                          ( const void * ) pTransactionId,
+                          STUN_HEADER_TRANSACTION_ID_LENGTH ) == 0 ) )
+            {
+                expected = tag;
+
+                if( ppTag == NULL )
+                {
+                    pFound = pEntry;
+                }
+                else if( STUN_ATOMIC_COMPARE_EXCHANGE( &( pTags[ i ] ), &( expected ), STUN_TRANSACTION_TAG_BUSY ) != 0 )
+                {
+                    pFound = pEntry;
+                    *ppTag = &( pTags[ i ] );
+                    *pProbe = probe;
+                }
+                else
+                {
+                    /* Removed by another thread. */
+                }
+            }
+        }
+
+        /* No transaction that hashes to this group or an earlier one of the
+         * sequence went past it. */
+        hasOverflow = ( STUN_ATOMIC_LOAD_ACQUIRE( &( pGroup->overflowCount ) ) != 0U );
+    }
+
+    return pFound;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Undoes the overflow counts of a transaction stored at probe probeCount of
+ * its sequence. */
+static void ReleaseOverflow( StunTransactionTable_t * pTable,
+                             uint64_t hash,
+                             uint32_t probeCount )
+{
+    uint32_t probe;
+
+    for( probe = 0; probe < probeCount; probe++ )
+    {
+        ( void ) STUN_ATOMIC_FETCH_SUB( &( pTable->pGroups[ ( hash + probe ) & pTable->groupMask ].overflowCount ), 1U );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Init( StunTransactionTable_t * pTable,
+                                        StunTransactionGroup_t * pGroups,
+                                        size_t groupCount,
+                                        StunTransactionThread_t * pThreads,
+                                        size_t threadCount )
+{
+    StunResult_t result = STUN_RESULT_OK;
+
+    if( ( pTable == NULL ) ||
+        ( pGroups == NULL ) ||
+        ( groupCount == 0 ) ||
+        ( ( groupCount & ( groupCount - 1 ) ) != 0 ) ||
+        ( pThreads == NULL ) ||
+        ( threadCount == 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        memset( ( void * ) pGroups, 0, groupCount * sizeof( StunTransactionGroup_t ) );
+        memset( ( void * ) pThreads, 0, threadCount * sizeof( StunTransactionThread_t ) );
+
+        pTable->pGroups = pGroups;
+        pTable->groupMask = groupCount - 1;
+        pTable->pThreads = pThreads;
+        pTable->threadCount = threadCount;
+
+        /* Epoch 0 marks a thread that is not in the table. */
+        pTable->epoch = 1;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_INIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Enter( StunTransactionTable_t * pTable,
+                                         size_t threadIndex )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTransactionThread_t * pThread;
+
+    if( ( pTable == NULL ) ||
+        ( threadIndex >= pTable->threadCount ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pThread = &( pTable->pThreads[ threadIndex ] );
+
+        if( pThread->nesting == 0 )
+        {
+            STUN_ATOMIC_STORE_RELAXED( &( pThread->epoch ), STUN_ATOMIC_LOAD_SEQ_CST( &( pTable->epoch ) ) );
+
+            /* The epoch must be visible to inserts before any tag is read. */
+            STUN_ATOMIC_FENCE_SEQ_CST();
+        }
+
+        pThread->nesting++;
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_ENTER, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Exit( StunTransactionTable_t * pTable,
+                                        size_t threadIndex )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTransactionThread_t * pThread;
+
+    if( ( pTable == NULL ) ||
+        ( threadIndex >= pTable->threadCount ) ||
+        ( pTable->pThreads[ threadIndex ].nesting == 0 ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pThread = &( pTable->pThreads[ threadIndex ] );
+        pThread->nesting--;
+
+        if( pThread->nesting == 0 )
+        {
+            STUN_ATOMIC_STORE_RELEASE( &( pThread->epoch ), 0 );
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_EXIT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Insert( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void * pContext )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTransactionGroup_t * pGroup;
+    uint64_t hash, minActiveEpoch = 0;
+    uint32_t probe;
+    int inserted = 0;
+
+    if( ( pTable == NULL ) ||
+        ( threadIndex >= pTable->threadCount ) ||
+        ( pTransactionId == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+
+    /* Only tags and retire epochs of other entries are read here, so the
+     * thread does not need to enter the table and hold back reclamation. */
+    if( result == STUN_RESULT_OK )
+    {
+        hash = HashTransactionId( pTransactionId );
+
+        for( probe = 0; ( inserted == 0 ) && ( probe < STUN_TRANSACTION_TABLE_PROBE_LENGTH ); probe++ )
+        {
+            pGroup = &( pTable->pGroups[ ( hash + probe ) & pTable->groupMask ] );
+
+            inserted = ClaimEntry( pTable,
+                                   pGroup,
+                                   STUN_TRANSACTION_TAG( hash ),
+                                   pTransactionId,
+                                   pContext,
+                                   &( minActiveEpoch ) );
+
+            /* Counted before the entry is published in a later group, so
+             * that lookups do not stop at this one. */
+            if( inserted == 0 )
+            {
+                ( void ) STUN_ATOMIC_FETCH_ADD( &( pGroup->overflowCount ), 1U );
+            }
+        }
+
+        if( inserted == 0 )
+        {
+            ReleaseOverflow( pTable, hash, STUN_TRANSACTION_TABLE_PROBE_LENGTH );
+            result = STUN_RESULT_OUT_OF_MEMORY;
+        }
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_INSERT, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Lookup( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void ** ppContext )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTransactionEntry_t * pEntry;
+
+    if( ( pTransactionId == NULL ) ||
+        ( ppContext == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else
+    {
+        result = StunTransactionTable_Enter( pTable, threadIndex );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pEntry = FindEntry( pTable, pTransactionId, NULL, NULL );
+
+        if( pEntry != NULL )
+        {
+            *ppContext = pEntry->pContext;
+        }
+        else
+        {
+            result = STUN_RESULT_TRANSACTION_NOT_FOUND;
+        }
+
+        ( void ) StunTransactionTable_Exit( pTable, threadIndex );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_LOOKUP, result );
+}
+
+/*-----------------------------------------------------------*/
+
+StunResult_t StunTransactionTable_Remove( StunTransactionTable_t * pTable,
+                                          size_t threadIndex,
+                                          const uint8_t * pTransactionId,
+                                          void ** ppContext,
+                                          uint64_t * pRetireEpoch )
+{
+    StunResult_t result = STUN_RESULT_OK;
+    StunTransactionEntry_t * pEntry;
+    uint8_t * pTag = NULL;
+    uint64_t retireEpoch;
+    uint32_t probe = 0;
+
+    if( ( pTransactionId == NULL ) ||
+        ( ppContext == NULL ) )
+    {
+        result = STUN_RESULT_BAD_PARAM;
+    }
+    else
+    {
+        result = StunTransactionTable_Enter( pTable, threadIndex );
+    }
+
+    if( result == STUN_RESULT_OK )
+    {
+        pEntry = FindEntry( pTable, pTransactionId, &( pTag ), &( probe ) );
+
+        if( pEntry != NULL )
+        {
+            *ppContext = pEntry->pContext;
+
+            /* No other thread can find the entry now that it is busy. */
+            ReleaseOverflow( pTable, HashTransactionId( pTransactionId ), probe );
+
+            /* Threads that entered up to this epoch may still be reading the
+             * entry. */
+            retireEpoch = STUN_ATOMIC_FETCH_ADD( &( pTable->epoch ), 1 );
+            STUN_ATOMIC_STORE_RELAXED( &( pEntry->retireEpoch ), retireEpoch );
+
+            STUN_ATOMIC_STORE_RELEASE( pTag, STUN_TRANSACTION_TAG_TOMBSTONE );
+
+            if( pRetireEpoch != NULL )
+            {
+                *pRetireEpoch = retireEpoch;
+            }
+        }
+        else
+        {
+            result = STUN_RESULT_TRANSACTION_NOT_FOUND;
+        }
+
+        ( void ) StunTransactionTable_Exit( pTable, threadIndex );
+    }
+
+    return STUN_STATS_RESULT( STUN_STATS_API_TRANSACTION_TABLE_REMOVE, result );
+}
+
+/*-----------------------------------------------------------*/
+
+int StunTransactionTable_IsReclaimable( const StunTransactionTable_t * pTable,
+                                        uint64_t retireEpoch )
+{
+    return ( pTable != NULL ) && ( retireEpoch < MinActiveEpoch( pTable ) );
+}
+
+/*-----------------------------------------------------------*/
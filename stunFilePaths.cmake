@@ -5,8 +5,18 @@
 # STUN library source files.
 set( STUN_SOURCES
      "${CMAKE_CURRENT_LIST_DIR}/source/stun_deserializer.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_deserializer_batch.c"
      "${CMAKE_CURRENT_LIST_DIR}/source/stun_serializer.c"
-     "${CMAKE_CURRENT_LIST_DIR}/source/stun_endianness.c" )
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_endianness.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_crc32.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_hmac_sha1.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_credential_cache.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_framer.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_channel_data.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_demux.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_stats.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_template.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_address.c" )
 
 # STUN library Public Include directories.
 set( STUN_INCLUDE_PUBLIC_DIRS
@@ -17,4 +27,39 @@ set( STUN_INCLUDE_PUBLIC_FILES
      "source/include/stun_data_types.h"
      "source/include/stun_endianness.h"
      "source/include/stun_deserializer.h"
-     "source/include/stun_serializer.h" )
+     "source/include/stun_serializer.h"
+     "source/include/stun_crc32.h"
+     "source/include/stun_hmac_sha1.h"
+     "source/include/stun_credential_cache.h"
+     "source/include/stun_framer.h"
+     "source/include/stun_channel_data.h"
+     "source/include/stun_demux.h"
+     "source/include/stun_stats.h"
+     "source/include/stun_template.h"
+     "source/include/stun_address.h" )
+
+# Optional components, built on top of the library. Each one has its own
+# source and header lists, so that it is only built when it is needed.
+
+# Per-thread generator of transaction IDs and ICE tie-breakers. Uses POSIX
+# threads and thread local storage.
+set( STUN_RANDOM_SOURCES
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_random.c" )
+
+set( STUN_RANDOM_INCLUDE_PUBLIC_FILES
+     "source/include/stun_random.h" )
+
+# Lock-free table of outstanding client transactions. Uses the GCC and Clang
+# __atomic builtins.
+set( STUN_TRANSACTION_TABLE_SOURCES
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_transaction_table.c" )
+
+set( STUN_TRANSACTION_TABLE_INCLUDE_PUBLIC_FILES
+     "source/include/stun_transaction_table.h" )
+
+# Hierarchical timing wheel for request retransmissions.
+set( STUN_TIMER_WHEEL_SOURCES
+     "${CMAKE_CURRENT_LIST_DIR}/source/stun_timer_wheel.c" )
+
+set( STUN_TIMER_WHEEL_INCLUDE_PUBLIC_FILES
+     "source/include/stun_timer_wheel.h" )